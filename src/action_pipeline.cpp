@@ -0,0 +1,380 @@
+#include "action_pipeline.h"
+#include <algorithm>
+
+namespace {
+
+// The fields abilities and spells share.
+template <typename Action>
+void describe(const Action &action, const Monster &base, ActionDef &out) {
+  out.name = action.name;
+  out.actionType = action.actionType;
+  out.attack = !action.attackRollType.empty();
+  // A named save is rolled only when there is no attack roll; an attack's
+  // save belongs to a rider and does not halve the damage of a miss.
+  out.save = !action.savingThrowType.empty();
+  out.saveAbility = abilityScoreFromName(action.savingThrowType);
+  out.saveName = action.savingThrowType;
+  out.damages = !action.damageDice.empty();
+  out.damageKind = action.damageKind;
+  out.damage =
+      damageWithBonus(base, action.damage, action.damageModifierAbility);
+  out.damageType = action.damageType;
+  out.conditions = &action.tags.conditions;
+  out.effects = &base.effects;
+  out.rootEffects = action.rootEffects;
+}
+
+using Outcome = ActionResolver::Outcome;
+
+bool affected(Outcome outcome) {
+  return outcome != Outcome::MISS && outcome != Outcome::SAVE_SUCCESS;
+}
+
+bool triggers(TriggerCondition trigger, Outcome outcome) {
+  switch (trigger) {
+  case TriggerCondition::ALWAYS:
+    return true;
+  case TriggerCondition::ON_HIT:
+    return outcome == Outcome::HIT;
+  case TriggerCondition::ON_MISS:
+    return outcome == Outcome::MISS;
+  case TriggerCondition::ON_SAVE_SUCCESS:
+    return outcome == Outcome::SAVE_SUCCESS;
+  case TriggerCondition::ON_SAVE_FAIL:
+    return outcome == Outcome::SAVE_FAIL;
+  }
+  return false;
+}
+
+Outcome rollAttack(Combatant &actor, const Combatant &target, int bonus,
+                   ActionEvent &check) {
+  check.type = ActionEvent::ATTACK;
+  check.roll = rollDice(kD20, actor.rng);
+  check.modifier = bonus;
+  check.against = target.base->armorClass;
+  check.success = check.roll + check.modifier >= check.against;
+  return check.success ? Outcome::HIT : Outcome::MISS;
+}
+
+Outcome rollSave(Combatant &target, AbilityScore ability, int dc,
+                 ActionEvent &check) {
+  check.type = ActionEvent::SAVE;
+  check.roll = rollDice(kD20, target.rng);
+  check.modifier = calculateModifier(getAbilityScore(*target.base, ability));
+  check.against = dc;
+  check.success = check.roll + check.modifier >= check.against;
+  return check.success ? Outcome::SAVE_SUCCESS : Outcome::SAVE_FAIL;
+}
+
+// Halves `effect.amount` if it says so, then applies it to `target`.
+void applyAmount(Combatant &target, DamageType type, ActionEvent &effect) {
+  const bool healing = type == DamageType::HEALING;
+  effect.type = healing ? ActionEvent::HEALING : ActionEvent::DAMAGE;
+  if (effect.halved) {
+    effect.amount /= 2;
+  }
+  if (healing) {
+    target.currentHitPoints =
+        std::min(target.maxHitPoints, target.currentHitPoints + effect.amount);
+  } else {
+    effect.rolled = effect.amount;
+    effect.amount =
+        applyDamageDefenses(effect.amount, type, target.damageDefenses);
+    target.currentHitPoints -= effect.amount;
+  }
+}
+
+void append(std::string &text, int value) { text += std::to_string(value); }
+
+void append(std::string &text, std::string_view value) { text += value; }
+
+void append(std::string &text, const char *value) { text += value; }
+
+template <typename... Parts> std::string concat(const Parts &...parts) {
+  std::string text;
+  (append(text, parts), ...);
+  return text;
+}
+
+} // namespace
+
+bool makeActionDef(const Combatant &actor, const ActionHandle &action,
+                   ActionDef &out) {
+  const Monster &base = *actor.base;
+  out = ActionDef{};
+  out.handle = action;
+  if (const Ability *ability = resolveAbility(actor, action)) {
+    describe(*ability, base, out);
+    out.resource = ability->resource;
+    out.recharge = ability->rechargeValue;
+    out.legendaryCost = ability->legendaryCost;
+    out.attackBonus = calculateModifier(
+        getAbilityScore(base, ability->damageModifierAbility));
+    out.saveDC = ability->savingThrowDC;
+    return true;
+  }
+  if (const Spell *spell = resolveSpell(actor, action)) {
+    describe(*spell, base, out);
+    if (spell->level >= 1 && spell->level <= Resources::kSpellLevels) {
+      out.resource = spell->level - 1;
+    }
+    out.attackBonus = actor.spellAttackBonus;
+    out.saveDC = actor.spellSaveDC;
+    return true;
+  }
+  return false;
+}
+
+void ActionResolver::resolve(const ActionDef &action, Combatant &actor,
+                             const std::vector<CombatantHandle> &targets,
+                             std::vector<ActionEvent> &events) {
+  // 1. Spend the action.
+  if (action.resource >= 0) {
+    actor.resources.values[action.resource]--;
+  }
+  if (action.actionType == ActionType::ACTION) {
+    actor.hasUsedAction = true;
+  } else if (action.actionType == ActionType::BONUS_ACTION) {
+    actor.hasUsedBonusAction = true;
+  } else if (action.actionType == ActionType::LEGENDARY) {
+    actor.legendaryActions -= action.legendaryCost;
+  } else if (action.actionType == ActionType::LAIR) {
+    actor.lairActionReady = false;
+  }
+  ActionEvent used;
+  used.target = actor.handle;
+  events.push_back(used);
+
+  // 2. Attack rolls and saving throws.
+  m_pending.clear();
+  for (CombatantHandle handle : targets) {
+    Combatant *target = m_registry.resolve(m_combatants, handle);
+    if (!target) {
+      continue; // Removed while the action was being chosen
+    }
+    ActionEvent check;
+    check.target = handle;
+    Outcome outcome = Outcome::NONE;
+    if (action.attack) {
+      outcome = rollAttack(actor, *target, action.attackBonus, check);
+      events.push_back(check);
+    } else if (action.save && target->isPlayer) {
+      check.type = ActionEvent::PLAYER_SAVE;
+      check.against = action.saveDC;
+      events.push_back(check);
+      continue;
+    } else if (action.save) {
+      outcome = rollSave(*target, action.saveAbility, action.saveDC, check);
+      events.push_back(check);
+    }
+    m_pending.push_back({target, outcome});
+  }
+
+  applyEffects(action, actor, events);
+}
+
+void ActionResolver::finishPlayerSave(const ActionDef &action,
+                                      Combatant &actor, Combatant &target,
+                                      bool saved,
+                                      std::vector<ActionEvent> &events) {
+  ActionEvent check;
+  check.type = ActionEvent::SAVE;
+  check.target = target.handle;
+  check.against = action.saveDC;
+  check.success = saved;
+  events.push_back(check);
+
+  m_pending.clear();
+  m_pending.push_back(
+      {&target, saved ? Outcome::SAVE_SUCCESS : Outcome::SAVE_FAIL});
+  applyEffects(action, actor, events);
+}
+
+void ActionResolver::applyEffects(const ActionDef &action, Combatant &actor,
+                                  std::vector<ActionEvent> &events) {
+  // 3. Damage or healing: in full when affected, halved on a made save,
+  // none on a miss.
+  if (action.damages) {
+    const bool halves = action.save && !action.attack;
+    for (const Pending &pending : m_pending) {
+      if (!affected(pending.outcome) && !halves) {
+        continue;
+      }
+      ActionEvent effect;
+      effect.target = pending.target->handle;
+      effect.amount = rollDice(action.damage, actor.rng);
+      effect.halved = !affected(pending.outcome);
+      applyAmount(*pending.target, action.damageKind, effect);
+      events.push_back(effect);
+    }
+  }
+
+  // 4. Conditions.
+  if (action.conditions && !action.conditions->empty()) {
+    for (const Pending &pending : m_pending) {
+      if (!affected(pending.outcome)) {
+        continue;
+      }
+      for (size_t i = 0; i < action.conditions->size(); ++i) {
+        const ConditionTag &tag = (*action.conditions)[i];
+        m_conditions.apply(*pending.target, tag.condition, tag.turns);
+        ActionEvent applied;
+        applied.type = ActionEvent::CONDITION;
+        applied.target = pending.target->handle;
+        applied.amount = static_cast<int>(i);
+        events.push_back(applied);
+      }
+    }
+  }
+
+  // 5. Effect trees, each target's from the outcome of stage 2.
+  if (action.effects && !action.rootEffects.empty()) {
+    for (const Pending &pending : m_pending) {
+      runEffects(action, actor, *pending.target, pending.outcome, events);
+    }
+  }
+}
+
+void ActionResolver::runEffects(const ActionDef &action, Combatant &actor,
+                                Combatant &target, Outcome outcome,
+                                std::vector<ActionEvent> &events) {
+  const EffectArena &arena = *action.effects;
+  auto pushChildren = [this](EffectRange range, Outcome parent) {
+    // Reversed, so siblings run in order off the back of the stack.
+    for (uint32_t i = range.count; i-- > 0;) {
+      m_effectStack.push_back({range.first + i, parent});
+    }
+  };
+  m_effectStack.clear();
+  pushChildren(action.rootEffects, outcome);
+  while (!m_effectStack.empty()) {
+    EffectFrame frame = m_effectStack.back();
+    m_effectStack.pop_back();
+    const EffectNode &node = arena[frame.node];
+    if (!triggers(node.trigger, frame.parent)) {
+      continue;
+    }
+
+    int modifier = 0;
+    if (node.modifierAbility != AbilityScore::NONE) {
+      modifier = calculateModifier(
+          getAbilityScore(*actor.base, node.modifierAbility));
+    }
+    ActionEvent check;
+    check.target = target.handle;
+    check.effect = static_cast<int32_t>(frame.node);
+    Outcome result = frame.parent; // Children see the nearest roll
+    bool hit = true;
+    if (node.attack) {
+      result = rollAttack(actor, target, modifier, check);
+      hit = affected(result);
+      events.push_back(check);
+    } else if (node.save && target.isPlayer) {
+      // Left to the table, along with everything below it.
+      check.type = ActionEvent::PLAYER_SAVE;
+      check.against = node.savingThrowDC;
+      events.push_back(check);
+      continue;
+    } else if (node.save) {
+      result = rollSave(target, node.saveAbility, node.savingThrowDC, check);
+      hit = affected(result);
+      events.push_back(check);
+    }
+
+    if (node.damages && (hit || (node.save && !node.attack))) {
+      ActionEvent effect = check;
+      effect.amount = rollDice(node.damage, actor.rng) + modifier;
+      effect.halved = !hit;
+      applyAmount(target, node.damageKind, effect);
+      events.push_back(effect);
+    }
+    if (hit && node.condition != Condition::NONE) {
+      m_conditions.apply(target, node.condition, 1);
+      ActionEvent applied = check;
+      applied.type = ActionEvent::CONDITION;
+      events.push_back(applied);
+    }
+    pushChildren(node.children, result);
+  }
+}
+
+LogEntry formatActionEvent(const ActionDef &action, const Combatant &actor,
+                           const Combatant &target,
+                           const ActionEvent &event) {
+  const std::string &who = target.displayName;
+  const int total = event.roll + event.modifier;
+  std::string_view saveName = action.saveName;
+  std::string_view damageType = action.damageType;
+  std::string_view condition;
+  int conditionTurns = 1;
+  if (event.type == ActionEvent::CONDITION && event.effect < 0) {
+    const ConditionTag &tag = (*action.conditions)[event.amount];
+    condition = conditionName(tag.condition);
+    conditionTurns = tag.turns;
+  }
+  if (event.effect >= 0) {
+    const EffectNode &node = (*action.effects)[event.effect];
+    saveName = action.effects->text(node.savingThrowType);
+    damageType = action.effects->text(node.damageType);
+    condition = conditionName(node.condition);
+    conditionTurns = 1;
+  }
+  switch (event.type) {
+  case ActionEvent::USED:
+    return {concat(actor.displayName,
+                   action.handle.kind == ActionKind::SPELL ? " casts "
+                                                           : " uses ",
+                   action.name, "."),
+            LogEntry::INFO};
+  case ActionEvent::ATTACK:
+    return {concat(actor.displayName, "'s ", action.name,
+                   event.success ? " hits " : " misses ", who,
+                   " (Attack Roll: ", event.roll, " + ", event.modifier,
+                   " = ", total, " vs AC ", event.against, ")."),
+            LogEntry::INFO};
+  case ActionEvent::SAVE: {
+    LogEntry out{concat(who, event.success ? " succeeds" : " fails",
+                        " on a DC ", event.against, " ", saveName,
+                        " saving throw"),
+                 LogEntry::INFO};
+    if (event.roll != 0) {
+      out.message += concat(" (Roll: ", event.roll, " + ", event.modifier,
+                            " = ", total, ")");
+    }
+    out.message += ".";
+    return out;
+  }
+  case ActionEvent::PLAYER_SAVE:
+    return {concat(who, " must make a DC ", event.against, " ",
+                   saveName, " saving throw against ", action.name,
+                   "."),
+            LogEntry::INFO};
+  case ActionEvent::DAMAGE: {
+    LogEntry out{concat(who, " takes ", event.amount, " ", damageType,
+                        " damage"),
+                 LogEntry::DAMAGE};
+    if (event.halved) {
+      out.message += " (half on successful save)";
+    }
+    if (event.amount == 0 && event.rolled > 0) {
+      out.message += " (immune)";
+    } else if (event.amount < event.rolled) {
+      out.message += " (resisted)";
+    } else if (event.amount > event.rolled) {
+      out.message += " (vulnerable)";
+    }
+    out.message += ".";
+    return out;
+  }
+  case ActionEvent::HEALING:
+    return {concat(who, " heals for ", event.amount,
+                   event.halved ? " hit points (half effect)."
+                                : " hit points."),
+            LogEntry::HEALING};
+  case ActionEvent::CONDITION:
+    return {concat(who, " is now ", condition, " for ",
+                   conditionTurns, " turn(s)."),
+            LogEntry::EVENT};
+  }
+  return {};
+}
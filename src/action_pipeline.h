@@ -0,0 +1,140 @@
+#pragma once
+
+#include "combatant_registry.h"
+#include "condition_wheel.h"
+#include "dice.h"
+#include "handles.h"
+#include "monster.h"
+#include "rules.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- Combat Log ---
+struct LogEntry {
+  enum LogEntryType { DAMAGE, HEALING, EVENT, INFO };
+  std::string message;
+  LogEntryType type;
+};
+
+// --- Action Definitions ---
+// An ability or spell reduced to what resolving it needs, with the actor's
+// bonuses already applied and ability names already looked up. Abilities and
+// spells differ only in where these numbers come from. Strings and the
+// conditions point into the actor's Monster, which outlives any resolution.
+struct ActionDef {
+  ActionHandle handle;
+  std::string_view name;
+  ActionType actionType = ActionType::NONE;
+  int resource = -1; // The Resources entry it spends: a use or a slot
+  int recharge = 0;  // The spent use returns on a d6 roll of this or more
+  int legendaryCost = 0;
+
+  bool attack = false; // Rolls d20 + attackBonus against AC
+  int attackBonus = 0;
+  bool save = false; // The target rolls d20 + modifier against saveDC
+  AbilityScore saveAbility = AbilityScore::NONE;
+  std::string_view saveName; // As written, for the log
+  int saveDC = 0;
+
+  bool damages = false; // Has damage dice, even if they failed to parse
+  DamageType damageKind = DamageType::NONE; // HEALING heals instead
+  DiceExpr damage; // Including the actor's ability bonus
+  std::string_view damageType;
+
+  const std::vector<ConditionTag> *conditions = nullptr; // Parsed tags
+
+  const EffectArena *effects = nullptr; // The actor's Monster's
+  EffectRange rootEffects;
+};
+
+// Fills `out` for the ability or spell `action` names on `actor`. False if
+// the handle no longer names one.
+bool makeActionDef(const Combatant &actor, const ActionHandle &action,
+                   ActionDef &out);
+
+// What happened to whom. Events reference the ActionDef's strings.
+struct ActionEvent {
+  enum Type : uint8_t {
+    USED,        // The actor spent the action
+    ATTACK,      // roll + modifier vs AC `against`; success is a hit
+    SAVE,        // roll + modifier vs DC `against`; success is a save
+    PLAYER_SAVE, // A player must roll this save at the table
+    DAMAGE,      // `amount` taken, `rolled` before the target's defenses
+    HEALING,     // `amount` healed, halved if `halved`
+    CONDITION    // ActionDef::conditions[amount], or the effect's, applied
+  };
+
+  Type type = USED;
+  CombatantHandle target;
+  int roll = 0; // 0 for saves a player rolled at the table
+  int modifier = 0;
+  int against = 0;
+  bool success = false;
+  int amount = 0;
+  int rolled = 0;
+  bool halved = false; // By a successful save
+  int32_t effect = -1; // Effect-tree node, or -1 for the action itself
+};
+
+// --- Action Resolution ---
+// One pipeline for every ability and spell, used by the combat UI and
+// headlessly by simulations. The targets go through each stage together:
+//   1. the actor spends the action, its use or its slot, or its legendary
+//      or lair action;
+//   2. attack rolls or saving throws, one per target;
+//   3. damage or healing for the hits and failed saves, half on a save,
+//      then through the target's immunities, resistances and vulnerabilities;
+//   4. the conditions tagged in its description, on a hit or failed save;
+//   5. the action's effect tree, walked per target from the outcome of 2.
+// Each stage appends ActionEvents; turning them into log text is a separate,
+// optional step. Players' saves are not rolled: they get a PLAYER_SAVE
+// event, and finishPlayerSave() runs stages 3 and 4 once the table reports
+// the result.
+class ActionResolver {
+public:
+  enum class Outcome : uint8_t { NONE, HIT, MISS, SAVE_SUCCESS, SAVE_FAIL };
+
+  ActionResolver(std::vector<Combatant> &combatants,
+                 const CombatantRegistry &registry, ConditionWheel &conditions)
+      : m_combatants(combatants), m_registry(registry),
+        m_conditions(conditions) {}
+
+  // Targets that have left the encounter are skipped.
+  void resolve(const ActionDef &action, Combatant &actor,
+               const std::vector<CombatantHandle> &targets,
+               std::vector<ActionEvent> &events);
+
+  void finishPlayerSave(const ActionDef &action, Combatant &actor,
+                        Combatant &target, bool saved,
+                        std::vector<ActionEvent> &events);
+
+private:
+  struct Pending {
+    Combatant *target;
+    Outcome outcome; // Of stage 2
+  };
+
+  struct EffectFrame {
+    uint32_t node;
+    Outcome parent; // Of the nearest roll above this node
+  };
+
+  void applyEffects(const ActionDef &action, Combatant &actor,
+                    std::vector<ActionEvent> &events);
+  void runEffects(const ActionDef &action, Combatant &actor,
+                  Combatant &target, Outcome outcome,
+                  std::vector<ActionEvent> &events);
+
+  std::vector<Combatant> &m_combatants;
+  const CombatantRegistry &m_registry;
+  ConditionWheel &m_conditions;
+  std::vector<Pending> m_pending; // Reused between calls
+  std::vector<EffectFrame> m_effectStack;
+};
+
+// Log text for `event`, e.g. "Goblin takes 5 slashing damage.". Only
+// callers that show a log pay for the strings.
+LogEntry formatActionEvent(const ActionDef &action, const Combatant &actor,
+                           const Combatant &target, const ActionEvent &event);
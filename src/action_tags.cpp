@@ -0,0 +1,73 @@
+#include "action_tags.h"
+#include <cctype>
+
+namespace {
+
+const int kMaxTurns = 1000000;
+
+// Reads "NAME:Arguments]" after an opening '[' at `pos`. On success
+// `pos` is left after the closing ']'.
+bool readTag(std::string_view text, size_t &pos, std::string_view &name,
+             std::string_view &arguments) {
+  size_t colon = text.find(':', pos);
+  size_t close = text.find(']', pos);
+  if (colon == std::string_view::npos || close == std::string_view::npos ||
+      colon > close) {
+    return false;
+  }
+  name = text.substr(pos, colon - pos);
+  arguments = text.substr(colon + 1, close - colon - 1);
+  pos = close + 1;
+  return true;
+}
+
+// "Name" or "Name:turns".
+bool parseCondition(std::string_view arguments, ConditionTag &tag) {
+  size_t colon = arguments.find(':');
+  tag.condition = conditionFromName(arguments.substr(0, colon));
+  if (tag.condition == Condition::NONE) {
+    return false;
+  }
+  tag.turns = 1;
+  if (colon == std::string_view::npos) {
+    return true;
+  }
+  std::string_view turns = arguments.substr(colon + 1);
+  if (turns.empty()) {
+    return false;
+  }
+  int value = 0;
+  for (char c : turns) {
+    if (!std::isdigit(static_cast<unsigned char>(c))) {
+      return false;
+    }
+    value = value * 10 + (c - '0');
+    if (value > kMaxTurns) {
+      return false;
+    }
+  }
+  tag.turns = value;
+  return true;
+}
+
+} // namespace
+
+ActionTags parseActionTags(std::string_view description) {
+  ActionTags tags;
+  size_t pos = 0;
+  while ((pos = description.find('[', pos)) != std::string_view::npos) {
+    size_t start = ++pos;
+    std::string_view name, arguments;
+    if (!readTag(description, pos, name, arguments)) {
+      pos = start;
+      continue;
+    }
+    ConditionTag condition;
+    if (name == "APPLY_CONDITION" && parseCondition(arguments, condition)) {
+      tags.conditions.push_back(condition);
+    } else {
+      pos = start; // Not a tag; a real one may start inside it
+    }
+  }
+  return tags;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "conditions.h"
+#include <string_view>
+#include <vector>
+
+// --- Action Tags ---
+// Markup embedded in ability and spell descriptions, read into typed records
+// once when the action is loaded so that resolution never scans the text.
+// Unknown and malformed tags, and conditions the rules do not have, are left
+// alone as ordinary text.
+
+// "[APPLY_CONDITION:Poisoned]" or "[APPLY_CONDITION:Poisoned:3]".
+struct ConditionTag {
+  Condition condition = Condition::NONE;
+  int turns = 1;
+};
+
+struct ActionTags {
+  std::vector<ConditionTag> conditions; // In the order they appear
+
+  bool empty() const { return conditions.empty(); }
+};
+
+ActionTags parseActionTags(std::string_view description);
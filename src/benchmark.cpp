@@ -0,0 +1,2552 @@
+#include "action_pipeline.h"
+#include "benchmark.h"
+#include "bestiary_snapshot.h"
+#include "combatant_registry.h"
+#include "condition_wheel.h"
+#include "dice.h"
+#include "dice_batch.h"
+#include "dice_distribution.h"
+#include "encounter_journal.h"
+#include "encounter_odds.h"
+#include "initiative_order.h"
+#include "monster_cache.h"
+#include "monster_db.h"
+#include "monster_filter.h"
+#include "monster_search.h"
+#include "rng.h"
+#include "rules.h"
+#include "turn_scheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <regex>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// Full-catalog load time: one bulk scan per table versus hydrating every
+// monster through getMonsterByName.
+int benchmarkCatalog() {
+  SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+  const int runs = 5;
+
+  size_t monsterCount = 0;
+  auto start = Clock::now();
+  for (int run = 0; run < runs; ++run) {
+    MonsterCatalog catalog = loadMonsterCatalog(db);
+    monsterCount = catalog.monsters.size();
+  }
+  double bulkMs = elapsedMs(start) / runs;
+
+  StatementCache statements(db);
+  std::vector<std::string> names = getMonsterNames(db);
+  start = Clock::now();
+  for (int run = 0; run < runs; ++run) {
+    for (const auto &name : names) {
+      Monster monster = getMonsterByName(statements, name);
+    }
+  }
+  double perNameMs = elapsedMs(start) / runs;
+
+  std::cout << "Monsters:             " << monsterCount << "\n"
+            << "Bulk catalog load:    " << bulkMs << " ms\n"
+            << "Per-name hydration:   " << perNameMs << " ms\n"
+            << "Speedup:              " << perNameMs / bulkMs << "x\n"
+            << "Per-name statements:  " << statements.stats().prepares
+            << " prepared, " << statements.stats().executions
+            << " executed" << std::endl;
+  return 0;
+}
+
+std::vector<Effect> venomTree();
+
+// Whether a monster from the snapshot carries the same derived data as the
+// one the catalog loaded: compiled dice, tags, defenses, resources and the
+// flattened effect trees.
+bool sameCompiledMonster(const Monster &a, const Monster &b) {
+  auto sameTags = [](const ActionTags &x, const ActionTags &y) {
+    return std::equal(x.conditions.begin(), x.conditions.end(),
+                      y.conditions.begin(), y.conditions.end(),
+                      [](const ConditionTag &p, const ConditionTag &q) {
+                        return p.condition == q.condition &&
+                               p.turns == q.turns;
+                      });
+  };
+  auto sameRange = [](EffectRange x, EffectRange y) {
+    return x.first == y.first && x.count == y.count;
+  };
+  if (a.name != b.name || a.damageDefenses != b.damageDefenses ||
+      a.maxResources.values != b.maxResources.values ||
+      a.legendaryActions != b.legendaryActions ||
+      a.lairActions != b.lairActions ||
+      a.abilities.size() != b.abilities.size() ||
+      a.spells.size() != b.spells.size() ||
+      a.effects.size() != b.effects.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.abilities.size(); ++i) {
+    const Ability &x = a.abilities[i];
+    const Ability &y = b.abilities[i];
+    if (x.description != y.description || !(x.damage == y.damage) ||
+        x.damageKind != y.damageKind || x.resource != y.resource ||
+        x.legendaryCost != y.legendaryCost ||
+        x.rechargeValue != y.rechargeValue || !sameTags(x.tags, y.tags) ||
+        !sameRange(x.rootEffects, y.rootEffects)) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < a.spells.size(); ++i) {
+    const Spell &x = a.spells[i];
+    const Spell &y = b.spells[i];
+    if (x.description != y.description || !(x.damage == y.damage) ||
+        x.damageKind != y.damageKind || !sameTags(x.tags, y.tags) ||
+        !sameRange(x.rootEffects, y.rootEffects)) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < a.effects.size(); ++i) {
+    const EffectNode &x = a.effects[i];
+    const EffectNode &y = b.effects[i];
+    if (x.trigger != y.trigger || x.condition != y.condition ||
+        x.damageKind != y.damageKind || !(x.damage == y.damage) ||
+        !sameRange(x.children, y.children) ||
+        a.effects.text(x.description) != b.effects.text(y.description)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Startup cost of the two bestiary sources: checksumming the database and
+// mapping the binary snapshot versus a full SQLite catalog load. Then the
+// cost of materializing every monster from the snapshot, which must give
+// what the catalog loaded.
+int benchmarkSnapshot() {
+  const std::string path = std::string(kSnapshotPath) + ".bench";
+  uint64_t checksum = checksumFile(kDatabasePath);
+  MonsterCatalog loaded;
+  {
+    SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+    loaded = loadMonsterCatalog(db);
+    // The bestiary has no effect trees, so the first monster is given a
+    // venomous bite to carry one through the snapshot.
+    Monster &biter =
+        loaded.monsters.at(loaded.idsByName.at(loaded.names.front()));
+    Ability bite;
+    bite.name = "Venomous Bite";
+    bite.attackRollType = "melee";
+    bite.damageDice = "1d8";
+    bite.damage = compileDice(bite.damageDice);
+    bite.rootEffects = biter.effects.append(venomTree());
+    biter.abilities.push_back(bite);
+    if (!compileBestiarySnapshot(loaded, checksum, path)) {
+      return 1;
+    }
+  }
+
+  const int runs = 20;
+  size_t bytes = 0;
+  auto start = Clock::now();
+  for (int run = 0; run < runs; ++run) {
+    auto snapshot = BestiarySnapshot::open(path, checksumFile(kDatabasePath));
+    for (uint32_t i = 0; snapshot && i < snapshot->size(); ++i) {
+      bytes += snapshot->name(i).size();
+    }
+  }
+  double snapshotMs = elapsedMs(start) / runs;
+
+  start = Clock::now();
+  for (int run = 0; run < runs; ++run) {
+    SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+    MonsterCatalog catalog = loadMonsterCatalog(db);
+    bytes += catalog.names.size();
+  }
+  double catalogMs = elapsedMs(start) / runs;
+
+  auto snapshot = BestiarySnapshot::open(path, checksum);
+  if (!snapshot) {
+    return 1;
+  }
+  bool same = true;
+  start = Clock::now();
+  for (uint32_t i = 0; i < snapshot->size(); ++i) {
+    Monster monster = snapshot->materialize(i);
+    const Monster *expected = loaded.findByName(monster.name);
+    same = same && expected && sameCompiledMonster(monster, *expected);
+  }
+  double materializeUs = elapsedMs(start) * 1000.0 / snapshot->size();
+  snapshot.reset();
+
+  // A copy whose first effect node lists itself as its child must not open.
+  bool rejectsCycle = false;
+  {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>());
+    SnapshotHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.effects.count > 0) {
+      EffectNode node;
+      char *first = bytes.data() + header.effects.offset;
+      std::memcpy(&node, first, sizeof(node));
+      node.children = {0, 1};
+      std::memcpy(first, &node, sizeof(node));
+      const std::string cyclic = path + ".cyclic";
+      std::ofstream(cyclic, std::ios::binary)
+          .write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+      rejectsCycle = !BestiarySnapshot::open(cyclic, checksum);
+      std::remove(cyclic.c_str());
+    }
+  }
+  std::remove(path.c_str());
+
+  std::cout << "Checksum + map snapshot: " << snapshotMs << " ms\n"
+            << "SQLite catalog load:     " << catalogMs << " ms\n"
+            << "Speedup:                 " << catalogMs / snapshotMs << "x"
+            << (bytes ? "" : " (no data)") << "\n"
+            << "Materialize one monster: " << materializeUs << " us\n"
+            << "Matches the catalog:     " << (same ? "yes" : "NO") << "\n"
+            << "Cyclic effects rejected: " << (rejectsCycle ? "yes" : "NO")
+            << std::endl;
+  return same && rejectsCycle ? 0 : 1;
+}
+
+// Heap owned by a combatant itself, not counting its shared Monster.
+size_t combatantStateBytes(const Combatant &combatant) {
+  return sizeof(Combatant) + combatant.displayName.capacity();
+}
+
+// A 200-combatant encounter drawn from a handful of monster kinds, built the
+// old way (every combatant deep-copies its Monster) and with one shared,
+// immutable Monster per kind.
+int benchmarkEncounter() {
+  SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+  MonsterCatalog catalog = loadMonsterCatalog(db);
+  const size_t combatants = 200;
+  const size_t kinds = 8;
+
+  std::vector<std::shared_ptr<const Monster>> roster;
+  for (size_t i = 0; i < kinds && i < catalog.names.size(); ++i) {
+    const std::string &name =
+        catalog.names[i * catalog.names.size() / kinds];
+    roster.push_back(
+        std::make_shared<const Monster>(*catalog.findByName(name)));
+  }
+  if (roster.empty()) {
+    return 1;
+  }
+
+  auto measure = [](const std::vector<Combatant> &encounter) {
+    size_t bytes = encounter.capacity() * sizeof(Combatant);
+    std::unordered_set<const Monster *> seen;
+    for (const auto &combatant : encounter) {
+      bytes += combatantStateBytes(combatant) - sizeof(Combatant);
+      if (seen.insert(combatant.base.get()).second) {
+        bytes += approximateMonsterBytes(*combatant.base);
+      }
+    }
+    return bytes;
+  };
+
+  auto start = Clock::now();
+  std::vector<Combatant> copied;
+  copied.reserve(combatants);
+  for (size_t i = 0; i < combatants; ++i) {
+    copied.emplace_back(
+        std::make_shared<const Monster>(*roster[i % roster.size()]));
+  }
+  double copiedMs = elapsedMs(start);
+
+  start = Clock::now();
+  std::vector<Combatant> shared;
+  shared.reserve(combatants);
+  for (size_t i = 0; i < combatants; ++i) {
+    shared.emplace_back(roster[i % roster.size()]);
+  }
+  double sharedMs = elapsedMs(start);
+
+  size_t copiedBytes = measure(copied);
+  size_t sharedBytes = measure(shared);
+  std::cout << "Combatants:              " << combatants << " of "
+            << roster.size() << " kinds\n"
+            << "Deep copy per combatant: " << copiedBytes / 1024 << " KiB, "
+            << copiedMs << " ms\n"
+            << "Shared definitions:      " << sharedBytes / 1024 << " KiB, "
+            << sharedMs << " ms\n"
+            << "Reduction:               "
+            << static_cast<double>(copiedBytes) / sharedBytes << "x"
+            << std::endl;
+  return 0;
+}
+
+// Runs every query `repeats` times against `index` and prints latency
+// percentiles over all the individual calls.
+void reportSearchLatency(const char *label, MonsterSearchIndex &index,
+                         const std::vector<const char *> &queries,
+                         int repeats) {
+  std::vector<double> samples;
+  size_t hits = 0;
+  for (int repeat = 0; repeat < repeats; ++repeat) {
+    for (const char *query : queries) {
+      auto start = Clock::now();
+      hits += index.search(query).size();
+      samples.push_back(elapsedMs(start));
+    }
+  }
+  std::sort(samples.begin(), samples.end());
+  std::cout << label << ": " << index.documentCount() << " monsters, "
+            << index.termCount() << " terms, p50 "
+            << samples[samples.size() / 2] << " ms, p99 "
+            << samples[samples.size() * 99 / 100] << " ms, max "
+            << samples.back() << " ms" << (hits ? "" : " (no hits)")
+            << std::endl;
+}
+
+// Full-text query latency on the shipped bestiary and on a synthetic 50k
+// monster catalog made of renamed copies of it.
+int benchmarkSearch() {
+  SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+  MonsterCatalog catalog = loadMonsterCatalog(db);
+  const std::vector<const char *> queries = {
+      "breath weapon", "fire immunity", "dragon",       "gob",
+      "undead",        "multiattack",   "poison resist", "fireball",
+      "charm",         "a",             "bite claw",    "legendary"};
+
+  auto start = Clock::now();
+  auto shipped = buildSearchIndex(catalog);
+  double shippedBuildMs = elapsedMs(start);
+  std::cout << "Top hits for \"breath weapon\":";
+  const auto &top = shipped->search("breath weapon");
+  for (size_t i = 0; i < top.size() && i < 5; ++i) {
+    std::cout << " " << catalog.names[top[i].doc];
+  }
+  std::cout << "\nIndex build: " << shippedBuildMs << " ms" << std::endl;
+  reportSearchLatency("Shipped", *shipped, queries, 200);
+
+  const uint32_t syntheticCount = 50000;
+  MonsterSearchIndex synthetic;
+  start = Clock::now();
+  for (uint32_t doc = 0; doc < syntheticCount; ++doc) {
+    size_t source = doc % catalog.names.size();
+    const Monster *monster = catalog.findByName(catalog.names[source]);
+    synthetic.addMonster(doc, *monster);
+    // A distinct word per copy keeps the vocabulary from being all repeats.
+    synthetic.add(doc, "variant" + std::to_string(doc / catalog.names.size()),
+                  MonsterSearchIndex::kNameWeight);
+  }
+  synthetic.finalize(syntheticCount);
+  std::cout << "Synthetic build: " << elapsedMs(start) << " ms" << std::endl;
+  reportSearchLatency("Synthetic", synthetic, queries, 10);
+  return 0;
+}
+
+// Types a query one letter at a time into the Bestiary filter over a
+// synthetic 50k name list, then checks that idle frames (same query every
+// frame) do no work and keep the result storage untouched. Exits non-zero
+// if an idle update recomputed or reallocated anything.
+int benchmarkFilter() {
+  SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+  MonsterCatalog catalog = loadMonsterCatalog(db);
+  std::vector<std::string> names;
+  const size_t syntheticCount = 50000;
+  names.reserve(syntheticCount);
+  for (size_t i = 0; i < syntheticCount; ++i) {
+    names.push_back(catalog.names[i % catalog.names.size()] + " " +
+                    std::to_string(i / catalog.names.size()));
+  }
+
+  MonsterFilter filter;
+  filter.setNames(names);
+  const std::string typed = "ancient red dragon";
+  auto start = Clock::now();
+  for (size_t length = 0; length <= typed.size(); ++length) {
+    filter.update(typed.substr(0, length).c_str());
+  }
+  double typedMs = elapsedMs(start);
+  MonsterFilterStats afterTyping = filter.stats();
+  std::cout << "Typed \"" << typed << "\": " << typedMs << " ms for "
+            << typed.size() + 1 << " keystrokes, " << afterTyping.rebuilds
+            << " full passes, " << afterTyping.narrowings << " narrowings, "
+            << filter.size() << " matches" << std::endl;
+
+  // Every keystroke as a full pass, as before incremental filtering.
+  MonsterFilter fresh;
+  start = Clock::now();
+  for (size_t length = 0; length <= typed.size(); ++length) {
+    fresh.setNames(names);
+    fresh.update(typed.substr(0, length).c_str());
+  }
+  std::cout << "Full rescans:  " << elapsedMs(start)
+            << " ms (including relowercasing)" << std::endl;
+
+  auto index = buildSearchIndex(catalog);
+  MonsterFilter ranked;
+  ranked.setNames(catalog.names);
+  ranked.setSearchIndex(index.get());
+  ranked.update("breath weapon");
+
+  const int idleFrames = 10000;
+  const uint32_t *storage = filter.results().data();
+  size_t capacity = filter.results().capacity();
+  const uint32_t *rankedStorage = ranked.results().data();
+  start = Clock::now();
+  bool recomputed = false;
+  for (int frame = 0; frame < idleFrames; ++frame) {
+    recomputed |= filter.update(typed.c_str());
+    recomputed |= ranked.update("Breath Weapon");
+  }
+  double idleMs = elapsedMs(start);
+  bool untouched = !recomputed && filter.results().data() == storage &&
+                   filter.results().capacity() == capacity &&
+                   ranked.results().data() == rankedStorage &&
+                   filter.stats().rebuilds == afterTyping.rebuilds &&
+                   filter.stats().narrowings == afterTyping.narrowings;
+  std::cout << "Idle: " << idleFrames << " frames in " << idleMs << " ms, "
+            << (untouched ? "no recomputation or reallocation"
+                          : "FAILED: idle frames did work")
+            << std::endl;
+  return untouched ? 0 : 1;
+}
+
+// The per-roll parser rollDice used before expressions were compiled at
+// load time, kept here as the baseline.
+int rollDiceWithRegex(const std::string &diceString, std::mt19937 &rng) {
+  int total = 0;
+  std::string s = diceString;
+  std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+
+  std::regex pattern(R"((\d+)d(\d+)(?:([+-])(\d+))?)");
+  std::smatch matches;
+  if (std::regex_match(s, matches, pattern)) {
+    int numDice = std::stoi(matches[1].str());
+    int dieType = std::stoi(matches[2].str());
+    for (int i = 0; i < numDice; ++i) {
+      total += (std::uniform_int_distribution<>(1, dieType))(rng);
+    }
+    if (matches[3].matched) {
+      int modifier = std::stoi(matches[4].str());
+      total += matches[3].str()[0] == '+' ? modifier : -modifier;
+    }
+  } else {
+    try {
+      total = std::stoi(diceString);
+    } catch (const std::exception &) {
+      return 0;
+    }
+  }
+  return total;
+}
+
+// Rolls per second for the "1d20" attack roll and every damage formula in
+// the shipped bestiary, parsing each roll versus rolling a compiled DiceExpr.
+int benchmarkDice() {
+  SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+  MonsterCatalog catalog = loadMonsterCatalog(db);
+  std::vector<std::string> formulas = {"1d20"};
+  for (const auto &entry : catalog.monsters) {
+    const Monster &monster = entry.second;
+    for (const auto &ability : monster.abilities) {
+      if (!ability.damageDice.empty()) {
+        formulas.push_back(ability.damageDice);
+      }
+    }
+    for (const auto &spell : monster.spells) {
+      if (!spell.damageDice.empty()) {
+        formulas.push_back(spell.damageDice);
+      }
+    }
+  }
+  std::vector<DiceExpr> compiled;
+  size_t rejected = 0;
+  for (const auto &formula : formulas) {
+    DiceExpr dice;
+    rejected += parseDice(formula, dice) ? 0 : 1;
+    compiled.push_back(dice);
+  }
+
+  std::mt19937 rng(42);
+  const int regexRounds = 20;
+  long long sum = 0;
+  auto start = Clock::now();
+  for (int round = 0; round < regexRounds; ++round) {
+    for (const auto &formula : formulas) {
+      sum += rollDiceWithRegex(formula, rng);
+    }
+  }
+  double regexMs = elapsedMs(start);
+
+  const int compiledRounds = 2000;
+  start = Clock::now();
+  for (int round = 0; round < compiledRounds; ++round) {
+    for (const auto &dice : compiled) {
+      sum += rollDice(dice, rng);
+    }
+  }
+  double compiledMs = elapsedMs(start);
+
+  double regexRate = regexRounds * formulas.size() / (regexMs / 1000.0);
+  double compiledRate =
+      compiledRounds * formulas.size() / (compiledMs / 1000.0);
+  std::cout << formulas.size() << " formulas, " << rejected << " rejected\n"
+            << "Regex per roll: " << regexRate / 1e6 << " M rolls/s\n"
+            << "Compiled:       " << compiledRate / 1e6 << " M rolls/s ("
+            << compiledRate / regexRate << "x)"
+            << (sum == 0 ? " (no rolls)" : "") << std::endl;
+
+  // The extended grammar, checked against each formula's exact mean.
+  struct Sample {
+    const char *formula;
+    double mean;
+  };
+  const Sample samples[] = {
+      {"2d20kh1", 13.825},      {"2d20kl1", 7.175}, {"4d6kh3", 12.2446},
+      {"2d6r2", 8.3333},        {"1d6!", 4.2},      {"3d6min2", 11.0},
+      {"2d6 + 1d8 + 4", 15.5}, {"4d6 + 4d6", 28.0}, {"1d20 - 1d4 - 2", 6.0}};
+  const int sampleRolls = 400000;
+  bool meansOk = true;
+  for (const auto &sample : samples) {
+    DiceExpr dice;
+    if (!parseDice(sample.formula, dice)) {
+      std::cout << sample.formula << ": FAILED to parse" << std::endl;
+      meansOk = false;
+      continue;
+    }
+    long long total = 0;
+    start = Clock::now();
+    for (int i = 0; i < sampleRolls; ++i) {
+      total += rollDice(dice, rng);
+    }
+    double ms = elapsedMs(start);
+    double mean = static_cast<double>(total) / sampleRolls;
+    bool ok = std::abs(mean - sample.mean) < 0.01 * sample.mean + 0.02;
+    meansOk = meansOk && ok;
+    std::printf("%-15s %zu term(s), mean %6.3f (exact %6.3f)%s, %.1f M "
+                "rolls/s\n",
+                sample.formula, static_cast<size_t>(dice.termCount), mean,
+                sample.mean, ok ? "" : " FAILED", sampleRolls / ms / 1000.0);
+  }
+  return meansOk ? 0 : 1;
+}
+
+// Batch rolling throughput per instruction set against one rollDice() call
+// per d20, and a check that every instruction set rolls identically,
+// including the rare rejected draws of a d65535.
+int benchmarkBatchDice() {
+  const size_t count = 1 << 22;
+  std::vector<uint16_t> rolls(count);
+  const uint64_t seed = 2024;
+
+  std::mt19937 rng(seed);
+  long long sum = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < count; ++i) {
+    sum += rollDice(kD20, rng);
+  }
+  double baselineRate = count / elapsedMs(start) / 1000.0;
+  std::printf("%-8s %7.1f M d20/s\n", "rollDice", baselineRate);
+
+  bool identical = true;
+  std::vector<uint16_t> reference(count);
+  for (uint32_t sides : {20u, 6u, 65535u}) {
+    DiceBatchRoller(seed, DiceIsa::SCALAR)
+        .roll(sides, reference.data(), count - 3);
+    for (DiceIsa isa : {DiceIsa::SSE2, DiceIsa::AVX2}) {
+      if (!diceIsaSupported(isa)) {
+        continue;
+      }
+      DiceBatchRoller(seed, isa).roll(sides, rolls.data(), count - 3);
+      identical = identical && std::equal(reference.begin(),
+                                          reference.end() - 3, rolls.begin());
+    }
+  }
+
+  for (DiceIsa isa : {DiceIsa::SCALAR, DiceIsa::SSE2, DiceIsa::AVX2}) {
+    if (!diceIsaSupported(isa)) {
+      std::printf("%-8s unsupported on this CPU\n", diceIsaName(isa));
+      continue;
+    }
+    DiceBatchRoller roller(seed, isa);
+    const int rounds = 8;
+    start = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+      roller.roll(20, rolls.data(), count);
+      sum += rolls[round];
+    }
+    double rate = rounds * count / elapsedMs(start) / 1000.0;
+    double mean = 0.0;
+    for (uint16_t roll : rolls) {
+      mean += roll;
+    }
+    mean /= count;
+    std::printf("%-8s %7.1f M d20/s (%.1fx), mean %.3f%s\n",
+                diceIsaName(isa), rate, rate / baselineRate, mean,
+                isa == bestDiceIsa() ? ", selected" : "");
+  }
+  std::cout << (identical ? "All instruction sets roll identically"
+                          : "FAILED: instruction sets disagree")
+            << (sum == 0 ? " (no rolls)" : "") << std::endl;
+  return identical ? 0 : 1;
+}
+
+// Exact distributions for every shipped damage formula and some pools big
+// enough to take the FFT path: cold and cached cost, checked against the
+// sampled mean and median of the same expression.
+int benchmarkOdds() {
+  SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+  MonsterCatalog catalog = loadMonsterCatalog(db);
+  std::vector<DiceExpr> expressions;
+  std::vector<std::string> labels;
+  auto addUnique = [&](const std::string &formula, const DiceExpr &dice) {
+    if (!dice.empty() &&
+        std::find(expressions.begin(), expressions.end(), dice) ==
+            expressions.end()) {
+      expressions.push_back(dice);
+      labels.push_back(formula);
+    }
+  };
+  for (const auto &entry : catalog.monsters) {
+    for (const auto &ability : entry.second.abilities) {
+      addUnique(ability.damageDice, ability.damage);
+    }
+    for (const auto &spell : entry.second.spells) {
+      addUnique(spell.damageDice, spell.damage);
+    }
+  }
+  size_t shipped = expressions.size();
+  for (const char *formula :
+       {"2d20kh1", "4d6kh3", "2d6r2", "1d10!", "3d6min2", "100d20",
+        "40d6 + 40d8 - 1d4", "20d12kh10"}) {
+    DiceExpr dice;
+    parseDice(formula, dice);
+    addUnique(formula, dice);
+  }
+
+  DiceDistributionCache cache;
+  auto start = Clock::now();
+  for (const auto &dice : expressions) {
+    cache.get(dice);
+  }
+  double coldUs = elapsedMs(start) * 1000.0 / expressions.size();
+  const int lookups = 100000;
+  double sink = 0.0;
+  start = Clock::now();
+  for (int i = 0; i < lookups; ++i) {
+    sink += cache.get(expressions[i % expressions.size()]).mean();
+  }
+  double warmUs = elapsedMs(start) * 1000.0 / lookups;
+  std::cout << expressions.size() << " expressions (" << shipped
+            << " shipped): " << coldUs << " us each to compute, " << warmUs
+            << " us cached" << (sink == 0.0 ? " (empty)" : "") << std::endl;
+
+  std::mt19937 rng(7);
+  bool ok = true;
+  const int samples = 100000;
+  std::vector<int> rolls(samples);
+  for (size_t e = 0; e < expressions.size(); ++e) {
+    const DiceExpr &dice = expressions[e];
+    const DiceDistribution &odds = cache.get(dice);
+    double sampledMean = 0.0;
+    for (int &roll : rolls) {
+      roll = rollDice(dice, rng);
+      sampledMean += roll;
+    }
+    sampledMean /= samples;
+    std::nth_element(rolls.begin(), rolls.begin() + samples / 2, rolls.end());
+    int sampledMedian = rolls[samples / 2];
+
+    // Both within a few standard errors of the sample.
+    double spread = odds.percentile(0.841) - odds.percentile(0.159) + 1.0;
+    bool close = std::abs(odds.mean() - sampledMean) < spread * 0.02 &&
+                 std::abs(odds.percentile(0.5) - sampledMedian) <=
+                     std::max(1.0, spread * 0.02);
+    ok = ok && close;
+    if (!close || e >= shipped) {
+      std::printf("  %-22s mean %8.3f (sampled %8.3f), median %d (sampled "
+                  "%d), P(>= mean) %.3f%s\n",
+                  labels[e].c_str(), odds.mean(), sampledMean,
+                  odds.percentile(0.5), sampledMedian,
+                  odds.chanceAtLeast(static_cast<int>(std::ceil(odds.mean()))),
+                  close ? "" : " FAILED");
+    }
+  }
+  std::cout << (ok ? "Exact odds agree with sampling"
+                   : "FAILED: exact odds disagree with sampling")
+            << std::endl;
+  return ok ? 0 : 1;
+}
+
+// Sums `chunks` independent batches of rolls, one derived stream per
+// batch, spread over `threads` workers. The result depends only on the seed,
+// never on the number of threads.
+long long simulateInChunks(const RngStream &root, const DiceExpr &dice,
+                           int chunks, int rollsPerChunk, int threads) {
+  std::vector<long long> chunkSums(chunks, 0);
+  std::atomic<int> nextChunk{0};
+  auto worker = [&] {
+    for (int chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+      RngStream rng = root.derive(chunk);
+      long long sum = 0;
+      for (int i = 0; i < rollsPerChunk; ++i) {
+        sum += rollDice(dice, rng);
+      }
+      chunkSums[chunk] = sum;
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  long long total = 0;
+  for (long long sum : chunkSums) {
+    total += sum;
+  }
+  return total;
+}
+
+// Replays, stream independence and contention-free parallel simulation
+// with RngStream.
+int benchmarkRng() {
+  const uint64_t seed = 20240601;
+  bool ok = true;
+
+  // Replay: the same seed and label give the same rolls, and seek() rewinds.
+  RngStream encounter(seed);
+  RngStream first = encounter.derive(3);
+  RngStream again = RngStream(seed).derive(3);
+  std::vector<int> rolls(1000);
+  for (int &roll : rolls) {
+    roll = rollFace(20, first);
+  }
+  bool replayed = true;
+  for (int roll : rolls) {
+    replayed = replayed && roll == rollFace(20, again);
+  }
+  again.seek(0);
+  replayed = replayed && rollFace(20, again) == rolls[0];
+  ok = ok && replayed;
+
+  // Sibling streams should look unrelated: near-zero correlation between
+  // neighbouring combatants' d20s, and even faces within each stream.
+  RngStream a = encounter.derive(0);
+  RngStream b = encounter.derive(1);
+  const int draws = 1000000;
+  double sumA = 0, sumB = 0, sumAB = 0, sumAA = 0, sumBB = 0;
+  std::vector<int> faces(21, 0);
+  for (int i = 0; i < draws; ++i) {
+    double x = rollFace(20, a);
+    double y = rollFace(20, b);
+    faces[static_cast<int>(x)]++;
+    sumA += x;
+    sumB += y;
+    sumAB += x * y;
+    sumAA += x * x;
+    sumBB += y * y;
+  }
+  double covariance = sumAB / draws - (sumA / draws) * (sumB / draws);
+  double correlation =
+      covariance / std::sqrt((sumAA / draws - std::pow(sumA / draws, 2)) *
+                             (sumBB / draws - std::pow(sumB / draws, 2)));
+  double chiSquare = 0.0;
+  for (int face = 1; face <= 20; ++face) {
+    double expected = draws / 20.0;
+    chiSquare += std::pow(faces[face] - expected, 2) / expected;
+  }
+  // 19 degrees of freedom: 43.8 is the 0.1% critical value.
+  bool independent = std::abs(correlation) < 0.005 && chiSquare < 43.8;
+  ok = ok && independent;
+  std::printf("Replay %s; sibling correlation %.5f, d20 chi-square %.1f\n",
+              replayed ? "identical" : "FAILED", correlation, chiSquare);
+
+  DiceExpr dice;
+  parseDice("2d20kh1 + 1d8 + 4", dice);
+  const int chunks = 256;
+  const int rollsPerChunk = 40000;
+  int threads = std::max(2u, std::thread::hardware_concurrency());
+  auto start = Clock::now();
+  long long serial =
+      simulateInChunks(encounter, dice, chunks, rollsPerChunk, 1);
+  double serialMs = elapsedMs(start);
+  start = Clock::now();
+  long long parallel =
+      simulateInChunks(encounter, dice, chunks, rollsPerChunk, threads);
+  double parallelMs = elapsedMs(start);
+  bool reproducible = serial == parallel;
+  ok = ok && reproducible;
+  double totalRolls = static_cast<double>(chunks) * rollsPerChunk;
+  std::printf("%.0f M rolls: 1 thread %.1f ms, %d threads %.1f ms (%.1fx), "
+              "sums %s\n",
+              totalRolls / 1e6, serialMs, threads, parallelMs,
+              serialMs / parallelMs, reproducible ? "identical" : "DIFFER");
+  return ok ? 0 : 1;
+}
+
+// Every catalog monster that has at least one ability or spell.
+std::vector<std::shared_ptr<const Monster>> loadActingRoster() {
+  SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+  MonsterCatalog catalog = loadMonsterCatalog(db);
+  std::vector<std::shared_ptr<const Monster>> roster;
+  for (const auto &entry : catalog.monsters) {
+    if (!entry.second.abilities.empty() || !entry.second.spells.empty()) {
+      roster.push_back(std::make_shared<const Monster>(entry.second));
+    }
+  }
+  return roster;
+}
+
+// Every cell `odds` holds for the encounter, so an incrementally synced
+// matrix can be checked against one built from scratch.
+bool sameOdds(const EncounterOdds &odds, const EncounterOdds &fresh,
+              const std::vector<Combatant> &encounter) {
+  for (const auto &actor : encounter) {
+    ActionHandle action{actor.handle, ActionKind::ABILITY, 0};
+    for (ActionKind kind : {ActionKind::ABILITY, ActionKind::SPELL}) {
+      action.kind = kind;
+      size_t count = kind == ActionKind::ABILITY ? actor.base->abilities.size()
+                                                 : actor.base->spells.size();
+      for (action.index = 0; action.index < static_cast<int>(count);
+           ++action.index) {
+        for (const auto &target : encounter) {
+          const ActionOdds *a = odds.find(action, target.handle);
+          const ActionOdds *b = fresh.find(action, target.handle);
+          if (!a || !b || a->kind != b->kind || a->known != b->known ||
+              a->successChance != b->successChance ||
+              a->expectedDamage != b->expectedDamage ||
+              a->dropChance != b->dropChance) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Cost of the targeting window's action-by-target odds: the first sync of a
+// 200-combatant encounter, then the incremental work for each kind of change.
+int benchmarkOddsMatrix() {
+  std::vector<std::shared_ptr<const Monster>> roster = loadActingRoster();
+  if (roster.empty()) {
+    return 1;
+  }
+
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  auto join = [&](size_t i) {
+    Combatant combatant(roster[i * 7 % roster.size()]);
+    combatant.handle = registry.acquire();
+    encounter.push_back(std::move(combatant));
+  };
+  for (size_t i = 0; i < 200; ++i) {
+    join(i);
+  }
+
+  DiceDistributionCache distributions;
+  EncounterOdds odds(distributions);
+  bool ok = true;
+  EncounterOddsStats before = odds.stats();
+  auto step = [&](const char *label, size_t expectCells,
+                  size_t expectDrops) {
+    auto start = Clock::now();
+    odds.sync(encounter);
+    double ms = elapsedMs(start);
+    const EncounterOddsStats &after = odds.stats();
+    size_t cells = after.cellsComputed - before.cellsComputed;
+    size_t drops = after.dropsRefreshed - before.dropsRefreshed;
+    bool expected = cells == expectCells && drops == expectDrops;
+    ok = ok && expected;
+    std::printf("%-22s %8.3f ms, %6zu cells, %5zu drop refreshes%s\n", label,
+                ms, cells, drops, expected ? "" : " UNEXPECTED");
+    before = after;
+  };
+
+  size_t rows = 0;
+  for (const auto &combatant : encounter) {
+    rows += combatant.base->abilities.size() + combatant.base->spells.size();
+  }
+  step("First sync", rows * encounter.size(), 0);
+  step("Idle sync", 0, 0);
+
+  encounter[17].currentHitPoints -= 5;
+  step("One hit point change", 0, rows);
+
+  encounter[42].conditions.set(Condition::POISONED, 3);
+  step("One condition change", rows, 0);
+
+  join(200);
+  const Monster &joined = *encounter.back().base;
+  size_t joinedRows = joined.abilities.size() + joined.spells.size();
+  step("One combatant joins", joinedRows * encounter.size() + rows, 0);
+  rows += joinedRows;
+
+  const Monster &leaving = *encounter[99].base;
+  rows -= leaving.abilities.size() + leaving.spells.size();
+  registry.release(encounter[99].handle);
+  encounter.erase(encounter.begin() + 99);
+  step("One combatant leaves", 0, 0);
+
+  EncounterOdds fresh(distributions);
+  fresh.sync(encounter);
+  bool same = sameOdds(odds, fresh, encounter);
+  ok = ok && same;
+  std::cout << rows << " action rows x " << encounter.size()
+            << " targets; incremental matrix "
+            << (same ? "matches" : "DIFFERS FROM") << " a full rebuild"
+            << std::endl;
+  return ok ? 0 : 1;
+}
+
+// Totals of one headless run, for comparing runs and predictions.
+struct SimulationTotals {
+  uint64_t checksum = 1469598103934665603ULL; // Of every event, in order
+  size_t resolutions = 0;
+  size_t events = 0;
+  double checks = 0, predictedChecks = 0; // Hits or failed saves
+  double damage = 0, predictedDamage = 0;
+};
+
+// Every action of every combatant in `roster`-built 200-combatant
+// encounter, each against the next four combatants, `rounds` times, through
+// the same ActionResolver the combat UI uses. Log text is built only when
+// `format` is set.
+SimulationTotals simulateActions(
+    const std::vector<std::shared_ptr<const Monster>> &roster, uint64_t seed,
+    int rounds, bool format) {
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  RngStream encounterRng(seed);
+  for (size_t i = 0; i < 200; ++i) {
+    Combatant combatant(roster[i * 7 % roster.size()]);
+    combatant.handle = registry.acquire();
+    combatant.rng = encounterRng.derive(i);
+    encounter.push_back(std::move(combatant));
+  }
+  registry.reindex(encounter);
+
+  struct Use {
+    size_t actor;
+    ActionDef action;
+    std::vector<CombatantHandle> targets;
+  };
+  std::vector<Use> uses;
+  for (size_t a = 0; a < encounter.size(); ++a) {
+    const Combatant &actor = encounter[a];
+    std::vector<CombatantHandle> targets;
+    for (size_t t = 1; t <= 4; ++t) {
+      targets.push_back(encounter[(a + t) % encounter.size()].handle);
+    }
+    for (ActionKind kind : {ActionKind::ABILITY, ActionKind::SPELL}) {
+      size_t count = kind == ActionKind::ABILITY ? actor.base->abilities.size()
+                                                 : actor.base->spells.size();
+      for (int i = 0; i < static_cast<int>(count); ++i) {
+        Use use{a, {}, targets};
+        makeActionDef(actor, {actor.handle, kind, i}, use.action);
+        uses.push_back(use);
+      }
+    }
+  }
+
+  DiceDistributionCache distributions;
+  EncounterOdds odds(distributions);
+  odds.sync(encounter);
+  ConditionWheel wheel;
+  ActionResolver resolver(encounter, registry, wheel);
+  std::vector<ActionEvent> events;
+  std::vector<LogEntry> log;
+  SimulationTotals totals;
+  for (int round = 0; round < rounds; ++round) {
+    for (auto &combatant : encounter) {
+      combatant.conditions.clear();
+    }
+    for (const Use &use : uses) {
+      for (CombatantHandle target : use.targets) {
+        const ActionOdds *cell = odds.find(use.action.handle, target);
+        if (cell && cell->known && cell->kind != ActionOdds::AUTOMATIC) {
+          totals.predictedChecks += cell->successChance;
+          totals.predictedDamage += cell->expectedDamage;
+        }
+      }
+      events.clear();
+      resolver.resolve(use.action, encounter[use.actor], use.targets, events);
+      ++totals.resolutions;
+      totals.events += events.size();
+      for (const ActionEvent &event : events) {
+        const Combatant &target = encounter[registry.indexOf(event.target)];
+        bool predicted = !target.isPlayer && (use.action.attack ||
+                                              use.action.save);
+        if (predicted &&
+            (event.type == ActionEvent::ATTACK ||
+             event.type == ActionEvent::SAVE)) {
+          totals.checks += event.type == ActionEvent::ATTACK
+                               ? event.success
+                               : !event.success;
+        }
+        if (predicted && event.type == ActionEvent::DAMAGE) {
+          totals.damage += event.amount;
+        }
+        totals.checksum =
+            (totals.checksum ^ (uint64_t(event.type) << 32 |
+                                uint32_t(event.roll * 1000 + event.amount))) *
+            1099511628211ULL;
+        if (format) {
+          log.push_back(formatActionEvent(use.action, encounter[use.actor],
+                                          target, event));
+        }
+      }
+      log.clear();
+    }
+  }
+  return totals;
+}
+
+// Headless throughput of the shared action pipeline, its determinism under a
+// seed, and its agreement with the odds the targeting window shows.
+int benchmarkActions() {
+  std::vector<std::shared_ptr<const Monster>> roster = loadActingRoster();
+  if (roster.empty()) {
+    return 1;
+  }
+  const int rounds = 50;
+  auto start = Clock::now();
+  SimulationTotals quiet = simulateActions(roster, 99, rounds, false);
+  double quietMs = elapsedMs(start);
+  start = Clock::now();
+  SimulationTotals logged = simulateActions(roster, 99, rounds, true);
+  double loggedMs = elapsedMs(start);
+  SimulationTotals other = simulateActions(roster, 100, 1, false);
+
+  bool replayed = quiet.checksum == logged.checksum;
+  bool seeded = other.checksum != quiet.checksum;
+  double checkError =
+      std::abs(quiet.checks - quiet.predictedChecks) / quiet.predictedChecks;
+  double damageError =
+      std::abs(quiet.damage - quiet.predictedDamage) / quiet.predictedDamage;
+  bool agrees = checkError < 0.01 && damageError < 0.01;
+  std::printf("%zu resolutions, %zu events\n"
+              "Events only:   %.3f us per resolution\n"
+              "With log text: %.3f us per resolution\n"
+              "Same seed %s, other seed %s\n"
+              "Hits and failed saves %.0f (predicted %.0f), damage %.0f "
+              "(predicted %.0f)%s\n",
+              quiet.resolutions, quiet.events,
+              quietMs * 1000.0 / quiet.resolutions,
+              loggedMs * 1000.0 / logged.resolutions,
+              replayed ? "replays identically" : "DIFFERS",
+              seeded ? "differs" : "REPEATS", quiet.checks,
+              quiet.predictedChecks, quiet.damage, quiet.predictedDamage,
+              agrees ? "" : " DISAGREE");
+  return replayed && seeded && agrees ? 0 : 1;
+}
+
+// A bite whose venom only matters on a hit: a Constitution save for half
+// of 2d6 poison, and on a failure the target is poisoned and must save
+// again or be paralyzed.
+std::vector<Effect> venomTree() {
+  Effect paralysis;
+  paralysis.trigger = TriggerCondition::ON_SAVE_FAIL;
+  paralysis.savingThrowType = "constitution";
+  paralysis.savingThrowDC = 11;
+  Effect paralyzed;
+  paralyzed.trigger = TriggerCondition::ON_SAVE_FAIL;
+  paralyzed.conditionToApply = "Paralyzed";
+  paralysis.childEffects.push_back(paralyzed);
+
+  Effect poisoned;
+  poisoned.trigger = TriggerCondition::ON_SAVE_FAIL;
+  poisoned.conditionToApply = "Poisoned";
+
+  Effect venom;
+  venom.trigger = TriggerCondition::ON_HIT;
+  venom.description = "The target must make a DC 13 Constitution save.";
+  venom.savingThrowType = "constitution";
+  venom.savingThrowDC = 13;
+  venom.damageDice = "2d6";
+  venom.damageType = "poison";
+  venom.childEffects = {poisoned, paralysis};
+  return {venom};
+}
+
+// Copy cost of a monster's effects flattened versus as a nested tree, and
+// the interpreter's rate and agreement with the odds of each branch.
+int benchmarkEffects() {
+  std::vector<std::shared_ptr<const Monster>> roster = loadActingRoster();
+  if (roster.size() < 2) {
+    return 1;
+  }
+
+  // Every ability of the biter carries the venom, so copies have something
+  // to carry.
+  Monster biter = *roster[0];
+  std::vector<std::vector<Effect>> nested;
+  Ability bite;
+  bite.name = "Venomous Bite";
+  bite.attackRollType = "melee";
+  bite.damageDice = "1d8";
+  bite.damage = compileDice(bite.damageDice);
+  bite.damageType = "piercing";
+  bite.damageModifierAbility = "strength";
+  biter.abilities.push_back(bite);
+  for (auto &ability : biter.abilities) {
+    nested.push_back(venomTree());
+    ability.rootEffects = biter.effects.append(nested.back());
+  }
+
+  const int copies = 20000;
+  size_t sink = 0;
+  auto start = Clock::now();
+  for (int i = 0; i < copies; ++i) {
+    EffectArena copy = biter.effects;
+    sink += copy.size();
+  }
+  double flatNs = elapsedMs(start) * 1e6 / copies;
+  start = Clock::now();
+  for (int i = 0; i < copies; ++i) {
+    std::vector<std::vector<Effect>> copy = nested;
+    sink += copy.size();
+  }
+  double nestedNs = elapsedMs(start) * 1e6 / copies;
+  std::printf("%zu effect nodes: copied in %.0f ns flattened, %.0f ns as a "
+              "nested tree%s\n",
+              biter.effects.size(), flatNs, nestedNs,
+              sink == 0 ? " (empty)" : "");
+
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  encounter.emplace_back(std::make_shared<const Monster>(biter));
+  encounter.emplace_back(roster[1]);
+  RngStream rng(5);
+  for (auto &combatant : encounter) {
+    combatant.handle = registry.acquire();
+    combatant.rng = rng.derive(combatant.handle.slot);
+  }
+  registry.reindex(encounter);
+  Combatant &attacker = encounter[0];
+  Combatant &target = encounter[1];
+  ActionDef action;
+  makeActionDef(attacker,
+                {attacker.handle, ActionKind::ABILITY,
+                 static_cast<int>(biter.abilities.size()) - 1},
+                action);
+
+  ConditionWheel wheel;
+  ActionResolver resolver(encounter, registry, wheel);
+  std::vector<ActionEvent> events;
+  std::vector<CombatantHandle> targets{target.handle};
+  const int bites = 200000;
+  int poisoned = 0, paralyzed = 0;
+  start = Clock::now();
+  for (int i = 0; i < bites; ++i) {
+    events.clear();
+    target.conditions.clear();
+    resolver.resolve(action, attacker, targets, events);
+    poisoned += target.conditions.has(Condition::POISONED);
+    paralyzed += target.conditions.has(Condition::PARALYZED);
+  }
+  double biteUs = elapsedMs(start) * 1000.0 / bites;
+
+  auto d20 = [](int faces) {
+    return std::min(20, std::max(0, faces)) / 20.0;
+  };
+  int con = calculateModifier(target.base->constitution);
+  double hit = d20(21 - (target.base->armorClass - action.attackBonus));
+  double expectPoisoned = hit * d20(13 - con - 1);
+  double expectParalyzed = expectPoisoned * d20(11 - con - 1);
+  double poisonedRate = static_cast<double>(poisoned) / bites;
+  double paralyzedRate = static_cast<double>(paralyzed) / bites;
+  bool agrees = std::abs(poisonedRate - expectPoisoned) < 0.005 &&
+                std::abs(paralyzedRate - expectParalyzed) < 0.005;
+  std::printf("%.3f us per bite through the effect tree\n"
+              "Poisoned %.4f (expected %.4f), paralyzed %.4f (expected "
+              "%.4f)%s\n",
+              biteUs, poisonedRate, expectPoisoned, paralyzedRate,
+              expectParalyzed, agrees ? "" : " DISAGREE");
+  return agrees ? 0 : 1;
+}
+
+// Tag parsing over the catalog, a table of tricky descriptions, and a
+// 10-target save spell resolved with its tags parsed at load time against
+// the per-target regex the resolver used to run.
+int benchmarkTags() {
+  std::vector<std::shared_ptr<const Monster>> roster = loadActingRoster();
+  if (roster.size() < 11) {
+    return 1;
+  }
+
+  std::vector<const std::string *> descriptions;
+  const std::string *longest = nullptr;
+  for (const auto &monster : roster) {
+    for (const auto &ability : monster->abilities) {
+      descriptions.push_back(&ability.description);
+    }
+    for (const auto &spell : monster->spells) {
+      descriptions.push_back(&spell.description);
+    }
+  }
+  size_t characters = 0, tagged = 0;
+  for (const std::string *description : descriptions) {
+    characters += description->size();
+    if (!longest || description->size() > longest->size()) {
+      longest = description;
+    }
+  }
+  const int runs = 20;
+  auto start = Clock::now();
+  for (int run = 0; run < runs; ++run) {
+    tagged = 0;
+    for (const std::string *description : descriptions) {
+      tagged += parseActionTags(*description).conditions.size();
+    }
+  }
+  double parseMs = elapsedMs(start) / runs;
+  std::printf("Parsed %zu descriptions (%zu KB) in %.3f ms, %zu condition "
+              "tags\n",
+              descriptions.size(), characters / 1024, parseMs, tagged);
+
+  struct Case {
+    const char *description;
+    std::vector<std::pair<std::string, int>> expected;
+  };
+  const Case cases[] = {
+      {"No tags here.", {}},
+      {"Bitten. [APPLY_CONDITION:Poisoned]", {{"Poisoned", 1}}},
+      {"[APPLY_CONDITION:Stunned:3] then more", {{"Stunned", 3}}},
+      {"[APPLY_CONDITION:Prone] and [APPLY_CONDITION:Grappled:2]",
+       {{"Prone", 1}, {"Grappled", 2}}},
+      {"[APPLY_CONDITION:Blinded] (see [Conditions])", {{"Blinded", 1}}},
+      {"[RECHARGE:5] [APPLY_CONDITION:Frightened:10]", {{"Frightened", 10}}},
+      {"[APPLY_CONDITION:] [APPLY_CONDITION:Deafened:x]", {}},
+      {"[[APPLY_CONDITION:Restrained]", {{"Restrained", 1}}},
+      {"[APPLY_CONDITION:Charmed", {}},
+      {"[APPLY_CONDITION:Sleepy:2] [APPLY_CONDITION:poisoned]",
+       {{"Poisoned", 1}}},
+  };
+  int wrong = 0;
+  for (const Case &c : cases) {
+    ActionTags tags = parseActionTags(c.description);
+    bool same = tags.conditions.size() == c.expected.size();
+    for (size_t i = 0; same && i < c.expected.size(); ++i) {
+      same = conditionName(tags.conditions[i].condition) ==
+                 c.expected[i].first &&
+             tags.conditions[i].turns == c.expected[i].second;
+    }
+    if (!same) {
+      std::printf("Misparsed: %s\n", c.description);
+      ++wrong;
+    }
+  }
+
+  // A Fireball whose text is the longest in the catalog, plus a tag.
+  Monster caster = *roster[0];
+  Spell fireball;
+  fireball.name = "Tagged Fireball";
+  fireball.description = *longest + " [APPLY_CONDITION:Frightened:2]";
+  fireball.level = 3;
+  fireball.actionType = ActionType::ACTION;
+  fireball.savingThrowType = "dexterity";
+  fireball.damageDice = "8d6";
+  fireball.damage = compileDice(fireball.damageDice);
+  fireball.damageType = "fire";
+  fireball.tags = parseActionTags(fireball.description);
+  caster.spells.push_back(fireball);
+
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  encounter.emplace_back(std::make_shared<const Monster>(caster));
+  for (size_t i = 1; i <= 10; ++i) {
+    encounter.emplace_back(roster[i]);
+  }
+  RngStream rng(19);
+  for (auto &combatant : encounter) {
+    combatant.handle = registry.acquire();
+    combatant.rng = rng.derive(combatant.handle.slot);
+  }
+  registry.reindex(encounter);
+  Combatant &actor = encounter[0];
+  actor.spellSaveDC = 15;
+  std::vector<CombatantHandle> targets;
+  for (size_t i = 1; i < encounter.size(); ++i) {
+    targets.push_back(encounter[i].handle);
+  }
+  ActionDef action;
+  makeActionDef(actor,
+                {actor.handle, ActionKind::SPELL,
+                 static_cast<int>(caster.spells.size()) - 1},
+                action);
+
+  ConditionWheel wheel;
+  ActionResolver resolver(encounter, registry, wheel);
+  std::vector<ActionEvent> events;
+  const int casts = 20000;
+  size_t failedSaves = 0, conditions = 0, frightened = 0;
+  start = Clock::now();
+  for (int i = 0; i < casts; ++i) {
+    events.clear();
+    for (auto &combatant : encounter) {
+      combatant.conditions.clear();
+      combatant.currentHitPoints = combatant.base->hitPoints;
+    }
+    resolver.resolve(action, actor, targets, events);
+    for (const auto &event : events) {
+      failedSaves += event.type == ActionEvent::SAVE && !event.success;
+      conditions += event.type == ActionEvent::CONDITION;
+    }
+    for (size_t t = 1; t < encounter.size(); ++t) {
+      frightened +=
+          wheel.remaining(encounter[t], Condition::FRIGHTENED) == 2;
+    }
+  }
+  double castUs = elapsedMs(start) * 1000.0 / casts;
+
+  // What every cast used to cost in tag handling alone.
+  const int regexCasts = 200;
+  size_t matches = 0;
+  start = Clock::now();
+  for (int i = 0; i < regexCasts; ++i) {
+    for (size_t t = 0; t < targets.size(); ++t) {
+      std::regex pattern(R"(\[APPLY_CONDITION:([^:]+)(?::(\d+))?\])");
+      std::smatch found;
+      matches += std::regex_search(fireball.description, found, pattern);
+    }
+  }
+  double regexUs = elapsedMs(start) * 1000.0 / regexCasts;
+
+  bool applied = conditions == failedSaves && frightened == failedSaves &&
+                 failedSaves > 0;
+  std::printf("10-target %zu-character save spell: %.2f us per cast with "
+              "tags parsed at load\n"
+              "Per-target regex tag search alone: %.2f us per cast (%.0fx)\n"
+              "%zu failed saves, %zu conditions applied%s; %d of %zu tag "
+              "cases misparsed\n",
+              fireball.description.size(), castUs, regexUs, regexUs / castUs,
+              failedSaves, conditions, applied ? "" : " MISMATCH", wrong,
+              sizeof(cases) / sizeof(cases[0]));
+  return applied && wrong == 0 && matches > 0 ? 0 : 1;
+}
+
+// Whether `names` lists `type`, compared by string as a stat block does.
+bool listsDamageType(const std::vector<std::string> &names,
+                     const std::string &type) {
+  for (const auto &name : names) {
+    if (name.size() == type.size() &&
+        std::equal(name.begin(), name.end(), type.begin(),
+                   [](char a, char b) {
+                     return std::tolower(static_cast<unsigned char>(a)) ==
+                            std::tolower(static_cast<unsigned char>(b));
+                   })) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Interned damage types and defenses: agreement with the catalog's lists,
+// per-hit cost against string lookups, and resolution against the odds for
+// plain, resistant, vulnerable and immune targets.
+int benchmarkDamageTypes() {
+  std::vector<std::shared_ptr<const Monster>> roster = loadActingRoster();
+  if (roster.size() < 2) {
+    return 1;
+  }
+
+  // In DamageType order.
+  const std::string typeNames[] = {
+      "",        "acid",     "bludgeoning", "cold",     "fire",
+      "force",   "lightning", "necrotic",   "piercing", "poison",
+      "psychic", "radiant",  "slashing",    "thunder"};
+  int mismatched = 0;
+  size_t defended = 0;
+  for (const auto &monster : roster) {
+    const DamageDefenses &defenses = monster->damageDefenses;
+    for (int t = 1; t < static_cast<int>(DamageType::HEALING); ++t) {
+      const DamageTypeMask bit = damageTypeBit(static_cast<DamageType>(t));
+      mismatched += ((defenses.immune & bit) != 0) !=
+                        listsDamageType(monster->damageImmunities,
+                                        typeNames[t]) ||
+                    ((defenses.resistant & bit) != 0) !=
+                        listsDamageType(monster->damageResistances,
+                                        typeNames[t]) ||
+                    ((defenses.vulnerable & bit) != 0) !=
+                        listsDamageType(monster->damageVulnerabilities,
+                                        typeNames[t]);
+    }
+    defended += defenses.immune || defenses.resistant || defenses.vulnerable;
+    for (const auto &spell : monster->spells) {
+      mismatched += !spell.damageType.empty() &&
+                    spell.damageKind == DamageType::NONE;
+    }
+    for (const auto &ability : monster->abilities) {
+      mismatched += !ability.damageType.empty() &&
+                    ability.damageKind == DamageType::NONE;
+    }
+  }
+
+  struct Case {
+    int amount;
+    DamageDefenses defenses;
+    int expected;
+  };
+  const DamageTypeMask fire = damageTypeBit(DamageType::FIRE);
+  const Case cases[] = {{7, {}, 7},
+                        {7, {0, fire, 0}, 3},
+                        {7, {0, 0, fire}, 14},
+                        {7, {0, fire, fire}, 6},
+                        {7, {fire, 0, fire}, 0},
+                        {-3, {0, fire, 0}, -1},
+                        {7, {damageTypeBit(DamageType::COLD), 0, 0}, 7}};
+  for (const Case &c : cases) {
+    mismatched +=
+        applyDamageDefenses(c.amount, DamageType::FIRE, c.defenses) !=
+        c.expected;
+  }
+  std::printf("%zu monsters, %zu with damage defenses; %d mismatches "
+              "against the lists and rules\n",
+              roster.size(), defended, mismatched);
+
+  // One hit per (amount, type, target), typed versus by name.
+  const size_t hits = 1 << 20;
+  std::vector<int> amounts(hits);
+  std::vector<DamageType> types(hits);
+  std::vector<const Monster *> targets(hits);
+  RngStream rng(20);
+  for (size_t i = 0; i < hits; ++i) {
+    amounts[i] = 1 + static_cast<int>(rng() % 40);
+    types[i] = static_cast<DamageType>(1 + rng() % 13);
+    targets[i] = roster[rng() % roster.size()].get();
+  }
+  long long typedTotal = 0, namedTotal = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < hits; ++i) {
+    typedTotal += applyDamageDefenses(amounts[i], types[i],
+                                      targets[i]->damageDefenses);
+  }
+  double typedNs = elapsedMs(start) * 1e6 / hits;
+  start = Clock::now();
+  for (size_t i = 0; i < hits; ++i) {
+    const Monster &target = *targets[i];
+    const std::string &name = typeNames[static_cast<int>(types[i])];
+    int amount = amounts[i];
+    if (listsDamageType(target.damageImmunities, name)) {
+      amount = 0;
+    } else {
+      if (listsDamageType(target.damageResistances, name)) {
+        amount /= 2;
+      }
+      if (listsDamageType(target.damageVulnerabilities, name)) {
+        amount *= 2;
+      }
+    }
+    namedTotal += amount;
+  }
+  double namedNs = elapsedMs(start) * 1e6 / hits;
+  std::printf("Per hit: %.2f ns with masks, %.2f ns by name (%.1fx)%s\n",
+              typedNs, namedNs, namedNs / typedNs,
+              typedTotal == namedTotal ? "" : " TOTALS DIFFER");
+
+  // An 8d6 fire save spell against four copies of one monster.
+  Monster caster = *roster[0];
+  Spell fireball;
+  fireball.name = "Fireball";
+  fireball.level = 3;
+  fireball.actionType = ActionType::ACTION;
+  fireball.savingThrowType = "dexterity";
+  fireball.damageDice = "8d6";
+  fireball.damage = compileDice(fireball.damageDice);
+  fireball.damageType = "Fire";
+  fireball.damageKind = damageTypeFromName(fireball.damageType);
+  caster.spells.push_back(fireball);
+
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  encounter.emplace_back(std::make_shared<const Monster>(caster));
+  const DamageDefenses defenses[] = {
+      {}, {0, fire, 0}, {0, 0, fire}, {fire, 0, 0}};
+  for (const DamageDefenses &d : defenses) {
+    encounter.emplace_back(roster[1]);
+    encounter.back().damageDefenses = d;
+  }
+  for (auto &combatant : encounter) {
+    combatant.handle = registry.acquire();
+    combatant.rng = rng.derive(combatant.handle.slot);
+  }
+  registry.reindex(encounter);
+  Combatant &actor = encounter[0];
+  actor.spellSaveDC = 15;
+  ActionDef action;
+  makeActionDef(actor,
+                {actor.handle, ActionKind::SPELL,
+                 static_cast<int>(caster.spells.size()) - 1},
+                action);
+  std::vector<CombatantHandle> targetHandles;
+  for (size_t i = 1; i < encounter.size(); ++i) {
+    targetHandles.push_back(encounter[i].handle);
+  }
+
+  DiceDistributionCache distributions;
+  EncounterOdds odds(distributions);
+  odds.sync(encounter);
+  ConditionWheel wheel;
+  ActionResolver resolver(encounter, registry, wheel);
+  std::vector<ActionEvent> events;
+  std::vector<long long> taken(encounter.size(), 0);
+  const int casts = 100000;
+  for (int i = 0; i < casts; ++i) {
+    events.clear();
+    resolver.resolve(action, actor, targetHandles, events);
+    for (const auto &event : events) {
+      if (event.type == ActionEvent::DAMAGE) {
+        taken[event.target.slot] += event.amount;
+      }
+    }
+  }
+  const char *const labels[] = {"plain", "resistant", "vulnerable",
+                                "immune"};
+  bool agrees = true;
+  for (size_t i = 1; i < encounter.size(); ++i) {
+    const ActionOdds *cell = odds.find(action.handle, encounter[i].handle);
+    double mean = static_cast<double>(taken[encounter[i].handle.slot]) /
+                  casts;
+    double expected = cell ? cell->expectedDamage : -1.0;
+    agrees = agrees && std::abs(mean - expected) <= 0.01 * expected + 0.01;
+    std::printf("  %-10s %6.2f damage per cast (expected %.2f)\n",
+                labels[i - 1], mean, expected);
+  }
+  std::printf("Resolution %s the odds\n", agrees ? "matches" : "DISAGREES");
+  return mismatched == 0 && agrees && typedTotal == namedTotal ? 0 : 1;
+}
+
+// A mass battle: a thousand combatants gaining conditions of mixed lengths
+// every turn, some leaving, advanced through the wheel and through the
+// per-combatant string vectors every turn used to rebuild. Both must end the
+// same conditions on the same turns.
+int benchmarkConditions() {
+  std::vector<std::shared_ptr<const Monster>> roster = loadActingRoster();
+  if (roster.empty()) {
+    return 1;
+  }
+
+  struct Grant {
+    uint32_t slot;
+    Condition condition;
+    int turns;
+  };
+  struct Turn {
+    std::vector<Grant> grants;
+    int leaving = -1; // Slot removed before the turn ends
+  };
+  const size_t count = 1000;
+  const int turns = 3000;
+  RngStream rng(21);
+  auto randomTurns = [&rng]() {
+    return rng() % 10 < 7 ? 1 + static_cast<int>(rng() % 10)
+                          : 10 + static_cast<int>(rng() % 600);
+  };
+  auto randomCondition = [&rng]() {
+    return static_cast<Condition>(1 + rng() % (kConditionCount - 1));
+  };
+  std::vector<Turn> script(turns + 1); // script[0] is the opening state
+  std::vector<uint32_t> alive(count);
+  for (uint32_t slot = 0; slot < count; ++slot) {
+    alive[slot] = slot;
+    for (int i = 0; i < 3; ++i) {
+      script[0].grants.push_back({slot, randomCondition(), randomTurns()});
+    }
+  }
+  for (int turn = 1; turn <= turns; ++turn) {
+    for (int i = 0; i < 5; ++i) {
+      uint32_t slot = alive[rng() % alive.size()];
+      script[turn].grants.push_back({slot, randomCondition(), randomTurns()});
+    }
+    if (turn % 50 == 0) {
+      size_t index = rng() % alive.size();
+      script[turn].leaving = static_cast<int>(alive[index]);
+      alive.erase(alive.begin() + index);
+    }
+  }
+
+  // (turn, slot, condition) for every condition that ran out.
+  using Expiry = std::tuple<int, uint32_t, std::string>;
+
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  std::vector<CombatantHandle> handles;
+  for (size_t i = 0; i < count; ++i) {
+    encounter.emplace_back(roster[i % roster.size()]);
+    encounter.back().handle = registry.acquire();
+    handles.push_back(encounter.back().handle);
+  }
+  registry.reindex(encounter);
+  ConditionWheel wheel;
+  std::vector<ExpiredCondition> expired;
+  std::vector<Expiry> wheelExpiries;
+  auto start = Clock::now();
+  for (int turn = 0; turn <= turns; ++turn) {
+    for (const Grant &grant : script[turn].grants) {
+      Combatant *target = registry.resolve(encounter, handles[grant.slot]);
+      wheel.apply(*target, grant.condition, grant.turns);
+    }
+    if (script[turn].leaving >= 0) {
+      CombatantHandle handle = handles[script[turn].leaving];
+      encounter.erase(encounter.begin() + registry.indexOf(handle));
+      registry.release(handle);
+      registry.reindex(encounter);
+    }
+    if (turn < turns) {
+      expired.clear();
+      wheel.advance(encounter, registry, expired);
+      for (const auto &e : expired) {
+        wheelExpiries.emplace_back(turn + 1, e.combatant.slot,
+                                   std::string(conditionName(e.condition)));
+      }
+    }
+  }
+  double wheelUs = elapsedMs(start) * 1000.0 / turns;
+
+  // As renderEncounterUI did it: every vector rebuilt on every turn. A
+  // re-applied condition keeps the longer duration, as the wheel does.
+  std::vector<std::vector<std::pair<std::string, int>>> active(count);
+  std::vector<bool> present(count, true);
+  std::vector<Expiry> vectorExpiries;
+  size_t held = 0;
+  start = Clock::now();
+  for (int turn = 0; turn <= turns; ++turn) {
+    for (const Grant &grant : script[turn].grants) {
+      std::string name(conditionName(grant.condition));
+      auto &conditions = active[grant.slot];
+      auto it = std::find_if(conditions.begin(), conditions.end(),
+                             [&](const std::pair<std::string, int> &c) {
+                               return c.first == name;
+                             });
+      if (it == conditions.end()) {
+        conditions.push_back({name, std::max(1, grant.turns)});
+      } else {
+        it->second = std::max(it->second, grant.turns);
+      }
+    }
+    if (script[turn].leaving >= 0) {
+      present[script[turn].leaving] = false;
+      active[script[turn].leaving].clear();
+    }
+    if (turn == turns) {
+      break;
+    }
+    for (uint32_t slot = 0; slot < count; ++slot) {
+      if (!present[slot]) {
+        continue;
+      }
+      std::vector<std::pair<std::string, int>> remaining;
+      for (const auto &condition : active[slot]) {
+        ++held;
+        if (condition.second > 1) {
+          remaining.push_back({condition.first, condition.second - 1});
+        } else {
+          vectorExpiries.emplace_back(turn + 1, slot, condition.first);
+        }
+      }
+      active[slot] = remaining;
+    }
+  }
+  double vectorUs = elapsedMs(start) * 1000.0 / turns;
+
+  std::sort(wheelExpiries.begin(), wheelExpiries.end());
+  std::sort(vectorExpiries.begin(), vectorExpiries.end());
+  bool same = wheelExpiries == vectorExpiries;
+  std::printf("%zu combatants, %d turns, %zu conditions ended\n"
+              "Expiry wheel:    %.2f us per turn, %.1f entries visited\n"
+              "Rebuilt vectors: %.2f us per turn, %.1f conditions visited\n"
+              "Both end the same conditions on the same turns: %s\n",
+              count, turns, wheelExpiries.size(), wheelUs,
+              static_cast<double>(wheel.visited()) / turns, vectorUs,
+              static_cast<double>(held) / turns, same ? "yes" : "NO");
+  return same ? 0 : 1;
+}
+
+// Late joiners, departures and re-rolled initiative in a 2000-creature
+// battle: the order must always match a full sort of the keys and the turn
+// must stay with the same creature. Joining is timed against appending to
+// the encounter list and sorting it, as "Begin Combat" did.
+int benchmarkInitiative() {
+  std::vector<std::shared_ptr<const Monster>> roster = loadActingRoster();
+  if (roster.empty()) {
+    return 1;
+  }
+
+  RngStream rng(22);
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  InitiativeOrder order;
+  std::vector<uint64_t> joined; // By slot, for the reference sort
+  uint64_t joins = 0;
+  auto join = [&]() {
+    Combatant combatant(roster[rng() % roster.size()]);
+    combatant.initiative = 1 + static_cast<int>(rng() % 30);
+    combatant.handle = registry.acquire();
+    encounter.push_back(std::move(combatant));
+    registry.reindex(encounter);
+    order.insert(encounter.back());
+    if (joined.size() <= encounter.back().handle.slot) {
+      joined.resize(encounter.back().handle.slot + 1);
+    }
+    joined[encounter.back().handle.slot] = joins++;
+  };
+  auto matchesFullSort = [&]() {
+    std::vector<const Combatant *> sorted;
+    for (const auto &combatant : encounter) {
+      sorted.push_back(&combatant);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [&](const Combatant *a, const Combatant *b) {
+                if (a->initiative != b->initiative) {
+                  return a->initiative > b->initiative;
+                }
+                if (a->base->dexterity != b->base->dexterity) {
+                  return a->base->dexterity > b->base->dexterity;
+                }
+                return joined[a->handle.slot] < joined[b->handle.slot];
+              });
+    if (sorted.size() != order.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < sorted.size(); ++i) {
+      if (sorted[i]->handle != order[i]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (int i = 0; i < 2000; ++i) {
+    join();
+  }
+  order.advance(1);
+  bool ordered = matchesFullSort();
+  bool kept = true;
+  int turnChanges = 0;
+  for (int step = 0; step < 20000; ++step) {
+    const CombatantHandle current = order.current();
+    const int position = order.positionOf(current);
+    CombatantHandle expected = current;
+    switch (rng() % 10) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      join();
+      break;
+    case 4:
+    case 5: {
+      // The current creature now and then, so the turn has to move on.
+      size_t index = rng() % 8 == 0 ? registry.indexOf(current)
+                                    : rng() % encounter.size();
+      CombatantHandle leaving = encounter[index].handle;
+      if (leaving == current) {
+        expected = order[(position + 1) % order.size()];
+        ++turnChanges;
+      }
+      order.remove(leaving);
+      registry.release(leaving);
+      encounter.erase(encounter.begin() + index);
+      registry.reindex(encounter);
+      break;
+    }
+    case 6:
+    case 7:
+    case 8: {
+      Combatant &rerolled = encounter[rng() % encounter.size()];
+      rerolled.initiative = 1 + static_cast<int>(rng() % 30);
+      order.update(rerolled);
+      break;
+    }
+    default:
+      expected = order[(position + 1) % order.size()];
+      order.advance(1);
+      ++turnChanges;
+      break;
+    }
+    kept = kept && order.current() == expected;
+    if (step % 1000 == 0) {
+      ordered = ordered && matchesFullSort();
+    }
+  }
+  ordered = ordered && matchesFullSort();
+
+  // Joining timed both ways, from the same starting roster.
+  const int lateJoins = 1000;
+  std::vector<Combatant> list = encounter;
+  auto start = Clock::now();
+  for (int i = 0; i < lateJoins; ++i) {
+    join();
+  }
+  double orderUs = elapsedMs(start) * 1000.0 / lateJoins;
+  CombatantRegistry listRegistry;
+  for (auto &combatant : list) {
+    combatant.handle = listRegistry.acquire();
+  }
+  start = Clock::now();
+  for (int i = 0; i < lateJoins; ++i) {
+    Combatant combatant(roster[rng() % roster.size()]);
+    combatant.initiative = 1 + static_cast<int>(rng() % 30);
+    combatant.handle = listRegistry.acquire();
+    list.push_back(std::move(combatant));
+    std::sort(list.begin(), list.end(),
+              [](const Combatant &a, const Combatant &b) {
+                return a.initiative > b.initiative;
+              });
+    listRegistry.reindex(list);
+  }
+  double sortUs = elapsedMs(start) * 1000.0 / lateJoins;
+
+  std::printf("%zu creatures after 20000 joins, departures and re-rolls; "
+              "%d turn changes\n"
+              "Order matches a full sort: %s; turn stays put: %s\n"
+              "Late join: %.2f us keeping the order, %.2f us re-sorting the "
+              "list (%.0fx)\n",
+              encounter.size(), turnChanges, ordered ? "yes" : "NO",
+              kept ? "yes" : "NO", orderUs, sortUs, sortUs / orderUs);
+  return ordered && kept ? 0 : 1;
+}
+
+// The old per-combatant resources: uses looked up by ability name, and spell
+// slots in two vectors. Kept here only to time against.
+struct NamedResources {
+  std::map<std::string, int> abilityUses;
+  std::vector<int> spellSlots;
+  std::vector<int> maxSpellSlots;
+
+  explicit NamedResources(const Monster &monster)
+      : spellSlots(monster.spellSlots), maxSpellSlots(monster.spellSlots) {
+    rest(monster);
+  }
+
+  void rest(const Monster &monster) {
+    for (const auto &ability : monster.abilities) {
+      if (ability.usesMax > 0) {
+        abilityUses[ability.name] = ability.usesMax;
+      }
+    }
+    spellSlots = maxSpellSlots;
+  }
+};
+
+// 500 combatants with limited abilities or spell slots. Every ability and
+// spell is checked for availability as the combat UI does each frame, by
+// name in a map and by index into Resources; then every limited ability and
+// levelled spell is spent once through the pipeline and everyone rests.
+int benchmarkResources() {
+  std::vector<std::shared_ptr<const Monster>> roster;
+  for (const auto &monster : loadActingRoster()) {
+    bool limited = false;
+    for (int value : monster->maxResources.values) {
+      limited = limited || value > 0;
+    }
+    if (limited) {
+      roster.push_back(monster);
+    }
+  }
+  if (roster.empty()) {
+    return 1;
+  }
+
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  std::vector<NamedResources> named;
+  for (size_t i = 0; i < 500; ++i) {
+    Combatant combatant(roster[i * 7 % roster.size()]);
+    combatant.handle = registry.acquire();
+    named.emplace_back(*combatant.base);
+    encounter.push_back(std::move(combatant));
+  }
+  registry.reindex(encounter);
+
+  const int frames = 200;
+  size_t available = 0;
+  auto start = Clock::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    for (size_t i = 0; i < encounter.size(); ++i) {
+      const Monster &base = *encounter[i].base;
+      NamedResources &resources = named[i];
+      for (const auto &ability : base.abilities) {
+        available += ability.usesMax == 0 ||
+                     resources.abilityUses[ability.name] > 0;
+      }
+      for (const auto &spell : base.spells) {
+        available += spell.level == 0 ||
+                     resources.spellSlots[spell.level - 1] > 0;
+      }
+    }
+  }
+  double namedUs = elapsedMs(start) * 1000.0 / frames;
+  size_t namedAvailable = available;
+
+  available = 0;
+  start = Clock::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    for (const auto &combatant : encounter) {
+      const Resources &resources = combatant.resources;
+      for (const auto &ability : combatant.base->abilities) {
+        available += ability.resource < 0 ||
+                     resources.values[ability.resource] > 0;
+      }
+      for (const auto &spell : combatant.base->spells) {
+        available +=
+            spell.level == 0 || resources.spellSlots(spell.level) > 0;
+      }
+    }
+  }
+  double denseUs = elapsedMs(start) * 1000.0 / frames;
+
+  // Spending through the pipeline must take exactly one from the right
+  // entry, and a rest must put back every maximum.
+  ConditionWheel wheel;
+  ActionResolver resolver(encounter, registry, wheel);
+  std::vector<ActionEvent> events;
+  ActionDef action;
+  bool spent = true;
+  int spends = 0;
+  for (auto &combatant : encounter) {
+    const Monster &base = *combatant.base;
+    for (int i = 0; i < static_cast<int>(base.abilities.size()); ++i) {
+      const int resource = base.abilities[i].resource;
+      if (resource < 0) {
+        continue;
+      }
+      makeActionDef(combatant, {combatant.handle, ActionKind::ABILITY, i},
+                    action);
+      resolver.resolve(action, combatant, {}, events);
+      spent = spent && combatant.resources.values[resource] ==
+                           base.maxResources.values[resource] - 1;
+      ++spends;
+    }
+    Resources expected = base.maxResources;
+    for (int i = 0; i < static_cast<int>(base.spells.size()); ++i) {
+      const int level = base.spells[i].level;
+      if (level == 0) {
+        continue;
+      }
+      makeActionDef(combatant, {combatant.handle, ActionKind::SPELL, i},
+                    action);
+      resolver.resolve(action, combatant, {}, events);
+      --expected.spellSlots(level);
+      ++spends;
+    }
+    for (int level = 1; level <= Resources::kSpellLevels; ++level) {
+      spent = spent && combatant.resources.spellSlots(level) ==
+                           expected.spellSlots(level);
+    }
+  }
+
+  const int rests = 1000;
+  start = Clock::now();
+  for (int rest = 0; rest < rests; ++rest) {
+    for (size_t i = 0; i < encounter.size(); ++i) {
+      named[i].rest(*encounter[i].base);
+    }
+  }
+  double namedRestUs = elapsedMs(start) * 1000.0 / rests;
+  start = Clock::now();
+  for (int rest = 0; rest < rests; ++rest) {
+    for (auto &combatant : encounter) {
+      combatant.restoreResources();
+    }
+  }
+  double denseRestUs = elapsedMs(start) * 1000.0 / rests;
+  bool restored = true;
+  for (const auto &combatant : encounter) {
+    restored = restored && combatant.resources.values ==
+                               combatant.base->maxResources.values;
+  }
+
+  const bool agree = namedAvailable == available;
+  std::printf("%zu combatants, %d spends\n"
+              "Availability per frame: %.2f us by name, %.2f us dense (%.0fx)"
+              "; agree: %s\n"
+              "Rest: %.2f us by name, %.2f us dense (%.0fx)\n"
+              "Spends hit the right entry: %s; rest restores maximums: %s\n",
+              encounter.size(), spends, namedUs, denseUs, namedUs / denseUs,
+              agree ? "yes" : "NO", namedRestUs, denseRestUs,
+              namedRestUs / denseRestUs, spent ? "yes" : "NO",
+              restored ? "yes" : "NO");
+  return agree && spent && restored ? 0 : 1;
+}
+
+// TurnScheduler's work done by looking at every combatant on every turn:
+// recharges and legendary actions for whoever's turn it is, and lair
+// actions once the turn passes below initiative 20.
+struct ScanningTurns {
+  int round = 1;
+  InitiativeOrder::Entry last{INT_MAX, INT_MAX, 0, {}};
+  bool lairDone = false;
+
+  void nextTurn(std::vector<Combatant> &encounter,
+                const InitiativeOrder &order, std::vector<TurnEvent> &fired) {
+    const InitiativeOrder::Entry now = order.entryOf(order.current());
+    if (!(last < now)) {
+      ++round;
+      lairDone = false;
+    }
+    last = now;
+    const bool lair = !lairDone && now.initiative < 20;
+    lairDone = lairDone || lair;
+    for (auto &combatant : encounter) {
+      combatant.lairActionReady = false;
+      if (lair && combatant.base->lairActions) {
+        combatant.lairActionReady = true;
+        fired.push_back({TurnEvent::LAIR, combatant.handle});
+      }
+      if (combatant.handle != now.handle) {
+        continue;
+      }
+      const auto &abilities = combatant.base->abilities;
+      for (int i = 0; i < static_cast<int>(abilities.size()); ++i) {
+        const Ability &ability = abilities[i];
+        if (ability.rechargeValue > 0 && ability.resource >= 0 &&
+            combatant.resources.values[ability.resource] == 0) {
+          TurnEvent event{TurnEvent::RECHARGE, combatant.handle, i};
+          event.roll = rollFace(6, combatant.rng);
+          event.recharged = event.roll >= ability.rechargeValue;
+          if (event.recharged) {
+            combatant.resources.values[ability.resource] = 1;
+          }
+          fired.push_back(event);
+        }
+      }
+      if (combatant.legendaryActions < combatant.base->legendaryActions) {
+        combatant.legendaryActions = combatant.base->legendaryActions;
+        fired.push_back({TurnEvent::LEGENDARY, combatant.handle});
+      }
+    }
+  }
+};
+
+// Same events, in a canonical order: within one turn, the order lair
+// actions of several creatures come up in is not specified.
+void sortTurnEvents(std::vector<TurnEvent> &events) {
+  std::sort(events.begin(), events.end(),
+            [](const TurnEvent &a, const TurnEvent &b) {
+              return std::make_tuple(a.type, a.owner.slot, a.ability) <
+                     std::make_tuple(b.type, b.owner.slot, b.ability);
+            });
+}
+
+bool sameTurnEvents(const std::vector<TurnEvent> &a,
+                    const std::vector<TurnEvent> &b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const TurnEvent &x, const TurnEvent &y) {
+                      return x.type == y.type && x.owner == y.owner &&
+                             x.ability == y.ability && x.roll == y.roll &&
+                             x.recharged == y.recharged;
+                    });
+}
+
+// A 2000-creature battle with dragons and their lairs, run for ten rounds
+// with recharge abilities and legendary actions spent as it goes, creatures
+// re-rolling initiative, leaving and joining. Every turn's events must match
+// a reference that scans the whole encounter, which is timed against the
+// scheduler.
+int benchmarkTurns() {
+  std::vector<std::shared_ptr<const Monster>> roster;
+  for (const auto &monster : loadActingRoster()) {
+    bool recharges = false;
+    for (const auto &ability : monster->abilities) {
+      recharges = recharges || ability.rechargeValue > 0;
+    }
+    if (monster->legendaryActions > 0) {
+      // The bestiary has no lair actions, so give its legendary creatures
+      // a lair in which they have one.
+      Monster lair = *monster;
+      lair.name += " (in its lair)";
+      lair.abilities.back().actionType = ActionType::LAIR;
+      assignResources(lair);
+      roster.push_back(std::make_shared<const Monster>(std::move(lair)));
+    }
+    if (recharges || monster->legendaryActions > 0) {
+      roster.push_back(monster);
+    }
+  }
+  if (roster.empty()) {
+    return 1;
+  }
+
+  RngStream rng(24);
+  RngStream streams(2024);
+  uint64_t joins = 0;
+  CombatantRegistry registry;
+  std::vector<Combatant> encounter;
+  std::vector<Combatant> scanned; // The same creatures, for the reference
+  InitiativeOrder order;
+  TurnScheduler scheduler(encounter, registry, order);
+  ScanningTurns reference;
+  auto join = [&]() {
+    Combatant combatant(roster[rng() % roster.size()]);
+    combatant.initiative = 1 + static_cast<int>(rng() % 30);
+    combatant.rng = streams.derive(joins++);
+    combatant.handle = registry.acquire();
+    encounter.push_back(combatant);
+    scanned.push_back(std::move(combatant));
+    registry.reindex(encounter);
+    order.insert(encounter.back());
+    scheduler.join(encounter.back());
+  };
+  // Any creature but the one whose turn it is.
+  auto other = [&]() {
+    size_t index = rng() % encounter.size();
+    if (encounter[index].handle == order.current()) {
+      index = (index + 1) % encounter.size();
+    }
+    return index;
+  };
+
+  for (int i = 0; i < 2000; ++i) {
+    join();
+  }
+  order.advance(1);
+  scheduler.begin();
+
+  std::vector<TurnEvent> fired;
+  std::vector<TurnEvent> expected;
+  size_t events = 0;
+  size_t recharges = 0;
+  bool same = true;
+  double schedulerMs = 0.0;
+  double scanMs = 0.0;
+  const int turns = 20000;
+  ActionDef action;
+  for (int turn = 0; turn < turns; ++turn) {
+    fired.clear();
+    expected.clear();
+    auto start = Clock::now();
+    scheduler.nextTurn(fired);
+    schedulerMs += elapsedMs(start);
+    start = Clock::now();
+    reference.nextTurn(scanned, order, expected);
+    scanMs += elapsedMs(start);
+    sortTurnEvents(fired);
+    sortTurnEvents(expected);
+    same = same && sameTurnEvents(fired, expected);
+    events += fired.size();
+    for (const auto &event : fired) {
+      recharges += event.type == TurnEvent::RECHARGE && event.recharged;
+    }
+
+    // Someone spends a recharge ability, someone a legendary action.
+    size_t index = other();
+    const auto &abilities = encounter[index].base->abilities;
+    for (int i = 0; i < static_cast<int>(abilities.size()); ++i) {
+      const int resource = abilities[i].resource;
+      if (abilities[i].rechargeValue > 0 &&
+          encounter[index].resources.values[resource] > 0) {
+        encounter[index].resources.values[resource] = 0;
+        scanned[index].resources.values[resource] = 0;
+        makeActionDef(encounter[index],
+                      {encounter[index].handle, ActionKind::ABILITY, i},
+                      action);
+        scheduler.spent(encounter[index], action);
+        break;
+      }
+    }
+    if (!scheduler.legendary().empty()) {
+      CombatantHandle spender =
+          scheduler.legendary()[rng() % scheduler.legendary().size()];
+      index = registry.indexOf(spender);
+      if (encounter[index].legendaryActions > 0) {
+        --encounter[index].legendaryActions;
+        --scanned[index].legendaryActions;
+      }
+    }
+
+    if (turn % 50 == 25) {
+      index = other();
+      const int initiative = 1 + static_cast<int>(rng() % 30);
+      encounter[index].initiative = initiative;
+      scanned[index].initiative = initiative;
+      order.update(encounter[index]);
+      scheduler.moved(encounter[index]);
+    }
+    if (turn % 100 == 50) {
+      index = other();
+      const CombatantHandle leaving = encounter[index].handle;
+      scheduler.leave(leaving);
+      order.remove(leaving);
+      registry.release(leaving);
+      encounter.erase(encounter.begin() + index);
+      scanned.erase(scanned.begin() + index);
+      registry.reindex(encounter);
+    }
+    if (turn % 100 == 75) {
+      join();
+    }
+    order.advance(1);
+  }
+
+  const TurnSchedulerStats &stats = scheduler.stats();
+  std::printf("%d turns over %d rounds, %zu events, %zu recharges\n"
+              "Queue entries popped: %.2f per turn (%zu stale)\n"
+              "Per turn: %.2f us from the queue, %.2f us scanning (%.0fx)\n"
+              "Events match the scan: %s\n",
+              turns, scheduler.round(), events, recharges,
+              static_cast<double>(stats.popped) / turns, stats.skipped,
+              schedulerMs * 1000.0 / turns, scanMs * 1000.0 / turns,
+              scanMs / schedulerMs, same ? "yes" : "NO");
+  return same && reference.round == scheduler.round() ? 0 : 1;
+}
+
+// --- Encounter journal ---
+// What the combat UI journals and checkpoints, without the UI and its log.
+// Copies keep their TurnScheduler on the encounter they were taken from, so
+// they are only ever assigned back to it.
+struct JournaledEncounter {
+  std::vector<Combatant> encounter;
+  CombatantRegistry registry;
+  InitiativeOrder order;
+  ConditionWheel wheel;
+  TurnScheduler scheduler{encounter, registry, order};
+  uint64_t joins = 0;
+};
+
+// What main.cpp's applyEncounterEvent() does for the events the benchmark
+// records, less the log text.
+void applyJournaled(JournaledEncounter &state, const EncounterJournal &journal,
+                    const RngStream &root, const EncounterEvent &event) {
+  std::vector<TurnEvent> fired;
+  auto startTurn = [&]() {
+    const int index = state.registry.indexOf(state.order.current());
+    if (index >= 0) {
+      state.encounter[index].hasUsedAction = false;
+      state.encounter[index].hasUsedBonusAction = false;
+    }
+  };
+  Combatant *combatant =
+      state.registry.resolve(state.encounter, event.combatant);
+  switch (event.type) {
+  case EncounterEvent::ADD_MONSTER: {
+    Combatant added(journal.monster(event.monster));
+    added.handle = state.registry.acquire();
+    added.rng = root.derive(state.joins++);
+    state.encounter.push_back(std::move(added));
+    state.registry.reindex(state.encounter);
+    state.order.insert(state.encounter.back());
+    state.scheduler.join(state.encounter.back());
+    break;
+  }
+  case EncounterEvent::REMOVE:
+    if (combatant) {
+      const int index = state.registry.indexOf(event.combatant);
+      const bool hadTurn = event.combatant == state.order.current();
+      state.scheduler.leave(event.combatant);
+      state.order.remove(event.combatant);
+      state.registry.release(event.combatant);
+      state.encounter.erase(state.encounter.begin() + index);
+      state.registry.reindex(state.encounter);
+      if (hadTurn) {
+        state.scheduler.nextTurn(fired);
+        startTurn();
+      }
+    }
+    break;
+  case EncounterEvent::ADJUST_HIT_POINTS:
+    if (combatant) {
+      combatant->currentHitPoints += event.value;
+    }
+    break;
+  case EncounterEvent::SET_INITIATIVE:
+    if (combatant) {
+      combatant->initiative = event.value;
+      state.order.update(*combatant);
+      state.scheduler.moved(*combatant);
+    }
+    break;
+  case EncounterEvent::SET_RESOURCE:
+    if (combatant) {
+      combatant->resources.values[event.index] = event.value;
+    }
+    break;
+  case EncounterEvent::BEGIN_COMBAT:
+    for (auto &each : state.encounter) {
+      each.initiative =
+          rollFace(20, each.rng) + calculateModifier(each.base->dexterity);
+    }
+    state.order.updateAll(state.encounter);
+    state.order.setCurrent(CombatantHandle{});
+    state.order.advance(1);
+    state.scheduler.begin();
+    state.scheduler.nextTurn(fired);
+    startTurn();
+    break;
+  case EncounterEvent::NEXT_TURN:
+    if (state.order.current()) {
+      std::vector<ExpiredCondition> expired;
+      state.wheel.advance(state.encounter, state.registry, expired);
+      state.order.advance(1);
+      state.scheduler.nextTurn(fired);
+      startTurn();
+    }
+    break;
+  case EncounterEvent::RESOLVE_ACTION: {
+    Combatant *actor =
+        state.registry.resolve(state.encounter, event.action.owner);
+    ActionDef action;
+    if (actor && makeActionDef(*actor, event.action, action)) {
+      ActionResolver resolver(state.encounter, state.registry, state.wheel);
+      std::vector<ActionEvent> events;
+      resolver.resolve(action, *actor, event.targets, events);
+      state.scheduler.spent(*actor, action);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+// Changes with anything an event can change, dice streams included.
+uint64_t fingerprint(const JournaledEncounter &state) {
+  uint64_t hash = 1469598103934665603ULL;
+  auto mix = [&hash](uint64_t value) {
+    hash = (hash ^ value) * 1099511628211ULL;
+  };
+  mix(state.order.current().slot);
+  mix(state.scheduler.round());
+  mix(state.wheel.now());
+  for (const Combatant &combatant : state.encounter) {
+    mix(combatant.handle.slot);
+    mix(combatant.handle.generation);
+    mix(combatant.currentHitPoints);
+    mix(combatant.initiative);
+    mix(combatant.conditions.mask());
+    mix(combatant.legendaryActions);
+    for (int value : combatant.resources.values) {
+      mix(value);
+    }
+    RngStream next = combatant.rng;
+    mix(next());
+  }
+  return hash;
+}
+
+bool sameEncounterEvent(const EncounterEvent &a, const EncounterEvent &b) {
+  return a.type == b.type && a.combatant == b.combatant &&
+         a.value == b.value && a.index == b.index && a.monster == b.monster &&
+         a.name == b.name && a.action.owner == b.action.owner &&
+         a.action.kind == b.action.kind && a.action.index == b.action.index &&
+         a.targets == b.targets;
+}
+
+// A 20000-event session of a 40-creature battle: creatures joining and
+// leaving, damage, initiative changes, resources set by hand, actions and
+// turns. Every event must decode to what was recorded, and going to any
+// point through the checkpoints must give the state the session had there,
+// which is timed against replaying from the start.
+int benchmarkJournal() {
+  std::vector<std::shared_ptr<const Monster>> roster = loadActingRoster();
+  if (roster.empty()) {
+    return 1;
+  }
+
+  RngStream rng(25);
+  const RngStream root(2025);
+  EncounterJournal journal;
+  Checkpoints<JournaledEncounter> checkpoints;
+  JournaledEncounter live;
+  std::vector<EncounterEvent> recorded;
+  std::vector<uint64_t> fingerprints{fingerprint(live)};
+  checkpoints.take(live);
+  auto record = [&](const EncounterEvent &event) {
+    journal.append(event);
+    recorded.push_back(event);
+    applyJournaled(live, journal, root, event);
+    fingerprints.push_back(fingerprint(live));
+    if (checkpoints.due(journal.cursor())) {
+      checkpoints.take(live);
+    }
+  };
+  auto anyone = [&]() {
+    return live.encounter[rng() % live.encounter.size()].handle;
+  };
+  auto addMonster = [&]() {
+    EncounterEvent event(EncounterEvent::ADD_MONSTER);
+    event.monster = journal.internMonster(roster[rng() % roster.size()]);
+    record(event);
+  };
+
+  for (int i = 0; i < 40; ++i) {
+    addMonster();
+  }
+  record(EncounterEvent(EncounterEvent::BEGIN_COMBAT));
+  const size_t events = 20000;
+  while (journal.size() < events) {
+    const uint64_t roll = rng() % 100;
+    if (roll < 3 && live.encounter.size() < 60) {
+      addMonster();
+    } else if (roll < 6 && live.encounter.size() > 20) {
+      record(EncounterEvent(EncounterEvent::REMOVE, anyone()));
+    } else if (roll < 25) {
+      record(EncounterEvent(EncounterEvent::ADJUST_HIT_POINTS, anyone(),
+                            static_cast<int>(rng() % 21) - 10));
+    } else if (roll < 30) {
+      record(EncounterEvent(EncounterEvent::SET_INITIATIVE, anyone(),
+                            1 + static_cast<int>(rng() % 25)));
+    } else if (roll < 35) {
+      EncounterEvent event(EncounterEvent::SET_RESOURCE, anyone(),
+                           static_cast<int>(rng() % 4));
+      event.index = static_cast<int>(rng() % Resources::kCapacity);
+      record(event);
+    } else if (roll < 65) {
+      const Combatant &actor =
+          live.encounter[live.registry.indexOf(live.order.current())];
+      const bool spell = !actor.base->spells.empty() && rng() % 2;
+      const size_t count = spell ? actor.base->spells.size()
+                                 : actor.base->abilities.size();
+      if (count == 0) {
+        continue;
+      }
+      EncounterEvent event(EncounterEvent::RESOLVE_ACTION);
+      event.action = {actor.handle,
+                      spell ? ActionKind::SPELL : ActionKind::ABILITY,
+                      static_cast<int>(rng() % count)};
+      for (uint64_t t = 1 + rng() % 3; t > 0; --t) {
+        event.targets.push_back(anyone());
+      }
+      record(event);
+    } else {
+      record(EncounterEvent(EncounterEvent::NEXT_TURN));
+    }
+  }
+
+  EncounterEvent decoded;
+  bool roundTrips = true;
+  for (size_t i = 0; i < journal.size(); ++i) {
+    journal.read(i, decoded);
+    roundTrips = roundTrips && sameEncounterEvent(decoded, recorded[i]);
+  }
+
+  // Goes to `cursor` from the checkpoint at `from`.
+  auto seek = [&](size_t from, size_t cursor) {
+    live = checkpoints.at(from);
+    for (size_t i = from; i < cursor; ++i) {
+      journal.read(i, decoded);
+      applyJournaled(live, journal, root, decoded);
+    }
+  };
+  const int seeks = 2000;
+  bool seeksMatch = true;
+  auto start = Clock::now();
+  for (int i = 0; i < seeks; ++i) {
+    const size_t cursor = rng() % (events + 1);
+    seek(checkpoints.before(cursor), cursor);
+    seeksMatch = seeksMatch && fingerprint(live) == fingerprints[cursor];
+  }
+  const double checkpointMs = elapsedMs(start);
+  const int replays = 20;
+  start = Clock::now();
+  for (int i = 0; i < replays; ++i) {
+    const size_t cursor = rng() % (events + 1);
+    seek(0, cursor);
+    seeksMatch = seeksMatch && fingerprint(live) == fingerprints[cursor];
+  }
+  const double replayMs = elapsedMs(start);
+
+  std::printf("%zu events in %zu bytes (%.2f per event), %zu checkpoints\n"
+              "Decoded events match: %s\n"
+              "Per seek: %.1f us from a checkpoint, %.1f us replaying from "
+              "the start (%.0fx)\n"
+              "States match the session: %s\n",
+              journal.size(), journal.bytes(),
+              static_cast<double>(journal.bytes()) / journal.size(),
+              events / Checkpoints<JournaledEncounter>::kInterval + 1,
+              roundTrips ? "yes" : "NO", checkpointMs * 1000.0 / seeks,
+              replayMs * 1000.0 / replays,
+              (replayMs / replays) / (checkpointMs / seeks),
+              seeksMatch ? "yes" : "NO");
+  return roundTrips && seeksMatch ? 0 : 1;
+}
+
+struct Benchmark {
+  const char *name;
+  const char *description;
+  int (*run)();
+};
+
+const Benchmark kBenchmarks[] = {
+    {"catalog", "Bulk catalog load vs per-name hydration", benchmarkCatalog},
+    {"snapshot", "Mapped snapshot vs SQLite catalog startup",
+     benchmarkSnapshot},
+    {"encounter", "Memory of 200 combatants, copied vs shared monsters",
+     benchmarkEncounter},
+    {"search", "Full-text query latency, shipped and synthetic 50k",
+     benchmarkSearch},
+    {"filter", "Incremental Bestiary filtering and idle-frame check",
+     benchmarkFilter},
+    {"dice", "Dice rolls per second and extended grammar means",
+     benchmarkDice},
+    {"batch-dice", "Batch d20 rolls per second per instruction set",
+     benchmarkBatchDice},
+    {"odds", "Exact damage distributions, cost and agreement with sampling",
+     benchmarkOdds},
+    {"rng", "Seeded replay, stream independence and parallel simulation",
+     benchmarkRng},
+    {"odds-matrix", "Encounter hit and damage odds, full and incremental",
+     benchmarkOddsMatrix},
+    {"actions", "Headless action resolution, replay and agreement with odds",
+     benchmarkActions},
+    {"effects", "Flattened effect trees, copy cost and interpreter odds",
+     benchmarkEffects},
+    {"tags", "Description tags parsed at load, multi-target resolution",
+     benchmarkTags},
+    {"damage-types", "Typed damage and defenses, per-hit cost and odds",
+     benchmarkDamageTypes},
+    {"conditions", "Condition expiry for a mass battle, wheel vs rebuilt lists",
+     benchmarkConditions},
+    {"initiative", "Initiative order under late joins, departures and re-rolls",
+     benchmarkInitiative},
+    {"resources", "Ability uses and spell slots by index, spends and rests",
+     benchmarkResources},
+    {"turns", "Recharges, legendary and lair actions from a priority queue",
+     benchmarkTurns},
+    {"journal", "Event journal size, decoding and checkpointed seeks",
+     benchmarkJournal},
+};
+
+} // namespace
+
+int runBenchmark(const std::string &name) {
+  for (const auto &benchmark : kBenchmarks) {
+    if (name == benchmark.name) {
+      try {
+        return benchmark.run();
+      } catch (const std::exception &e) {
+        std::cerr << "Benchmark " << name << " failed: " << e.what()
+                  << std::endl;
+        return 1;
+      }
+    }
+  }
+  std::cerr << "Unknown benchmark: " << name << "\nAvailable benchmarks:\n";
+  for (const auto &benchmark : kBenchmarks) {
+    std::cerr << "  " << benchmark.name << " - " << benchmark.description
+              << "\n";
+  }
+  return 1;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+
+// --- Headless Benchmarks ---
+// Run with `initiativ --benchmark <name>` from the build directory. Results
+// are printed to stdout; the return value is used as the process exit code.
+int runBenchmark(const std::string &name);
@@ -0,0 +1,657 @@
+#include "bestiary_snapshot.h"
+#include "monster_db.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kSnapshotMagic[8] = {'I', 'N', 'I', 'T', 'B', 'E', 'S', 'T'};
+
+static_assert(std::is_trivially_copyable<SnapshotMonster>::value &&
+                  std::is_trivially_copyable<SnapshotAbility>::value &&
+                  std::is_trivially_copyable<SnapshotSpell>::value &&
+                  std::is_trivially_copyable<EffectNode>::value &&
+                  std::is_trivially_copyable<ConditionTag>::value &&
+                  std::is_trivially_copyable<SnapshotHeader>::value,
+              "Snapshot records must be plain data");
+static_assert(sizeof(SnapshotHeader) % 8 == 0,
+              "Record arrays must stay aligned after the header");
+
+// --- Checksum ---
+
+uint64_t checksumFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return 0;
+  }
+  // FNV-1a folded over 64-bit words; the trailing bytes go in one at a time.
+  uint64_t hash = 14695981039346656037ull;
+  uint64_t length = 0;
+  char buffer[64 * 1024];
+  while (file) {
+    file.read(buffer, sizeof(buffer));
+    size_t read = static_cast<size_t>(file.gcount());
+    size_t i = 0;
+    for (; i + 8 <= read; i += 8) {
+      uint64_t word;
+      std::memcpy(&word, buffer + i, sizeof(word));
+      hash ^= word;
+      hash *= 1099511628211ull;
+    }
+    for (; i < read; ++i) {
+      hash ^= static_cast<unsigned char>(buffer[i]);
+      hash *= 1099511628211ull;
+    }
+    length += read;
+  }
+  return hash ^ length;
+}
+
+// --- Compiler ---
+
+namespace {
+
+class SnapshotWriter {
+public:
+  SnapshotString intern(const std::string &text) {
+    auto it = m_internedStrings.find(text);
+    if (it != m_internedStrings.end()) {
+      return it->second;
+    }
+    SnapshotString ref{static_cast<uint32_t>(m_strings.size()),
+                       static_cast<uint32_t>(text.size())};
+    m_strings.insert(m_strings.end(), text.begin(), text.end());
+    m_internedStrings.emplace(text, ref);
+    return ref;
+  }
+
+  SnapshotString intern(std::string_view text) {
+    return intern(std::string(text));
+  }
+
+  SnapshotRange stringList(const std::vector<std::string> &list) {
+    SnapshotRange range{static_cast<uint32_t>(m_stringLists.size()),
+                        static_cast<uint32_t>(list.size())};
+    for (const auto &entry : list) {
+      m_stringLists.push_back(intern(entry));
+    }
+    return range;
+  }
+
+  SnapshotRange conditionTags(const ActionTags &tags) {
+    SnapshotRange range{static_cast<uint32_t>(m_conditionTags.size()),
+                        static_cast<uint32_t>(tags.conditions.size())};
+    m_conditionTags.insert(m_conditionTags.end(), tags.conditions.begin(),
+                           tags.conditions.end());
+    return range;
+  }
+
+  // The arena's nodes are stored as they are; their children and roots
+  // already count from the monster's first node.
+  SnapshotRange effects(const EffectArena &arena) {
+    SnapshotRange range{static_cast<uint32_t>(m_effects.size()),
+                        static_cast<uint32_t>(arena.size())};
+    m_effects.insert(m_effects.end(), arena.data(),
+                     arena.data() + arena.size());
+    return range;
+  }
+
+  void addMonster(int monsterId, const Monster &monster) {
+    SnapshotMonster record{};
+    record.monsterId = monsterId;
+    record.name = intern(monster.name);
+    record.size = intern(monster.size);
+    record.type = intern(monster.type);
+    record.alignment = intern(monster.alignment);
+    record.hitDice = intern(monster.hitDice);
+    record.challengeRating = intern(monster.challengeRating);
+    record.languages = intern(monster.languages);
+    record.armorClass = monster.armorClass;
+    record.hitPoints = monster.hitPoints;
+    record.strength = monster.strength;
+    record.dexterity = monster.dexterity;
+    record.constitution = monster.constitution;
+    record.intelligence = monster.intelligence;
+    record.wisdom = monster.wisdom;
+    record.charisma = monster.charisma;
+    record.spellSaveDC = monster.spellSaveDC;
+    record.spellAttackBonus = monster.spellAttackBonus;
+    for (size_t i = 0; i < 9 && i < monster.spellSlots.size(); ++i) {
+      record.spellSlots[i] = monster.spellSlots[i];
+    }
+    record.damageDefenses = monster.damageDefenses;
+    record.legendaryActions = monster.legendaryActions;
+    record.lairActions = monster.lairActions;
+    record.maxResources = monster.maxResources;
+    record.speeds = stringList(monster.speeds);
+    record.skills = stringList(monster.skills);
+    record.savingThrows = stringList(monster.savingThrows);
+    record.senses = stringList(monster.senses);
+    record.conditionImmunities = stringList(monster.conditionImmunities);
+    record.damageImmunities = stringList(monster.damageImmunities);
+    record.damageResistances = stringList(monster.damageResistances);
+    record.damageVulnerabilities = stringList(monster.damageVulnerabilities);
+
+    record.abilities = {static_cast<uint32_t>(m_abilities.size()),
+                        static_cast<uint32_t>(monster.abilities.size())};
+    for (const auto &ability : monster.abilities) {
+      SnapshotAbility a{};
+      a.name = intern(ability.name);
+      a.description = intern(ability.description);
+      a.type = intern(ability.type);
+      a.usageType = intern(ability.usageType);
+      a.targetType = intern(ability.targetType);
+      a.attackRollType = intern(ability.attackRollType);
+      a.savingThrowType = intern(ability.savingThrowType);
+      a.damageDice = intern(ability.damageDice);
+      a.damageType = intern(ability.damageType);
+      a.damageModifierAbility = intern(ability.damageModifierAbility);
+      a.actionType = static_cast<int32_t>(ability.actionType);
+      a.usesMax = ability.usesMax;
+      a.rechargeValue = ability.rechargeValue;
+      a.resource = ability.resource;
+      a.legendaryCost = ability.legendaryCost;
+      a.savingThrowDC = ability.savingThrowDC;
+      a.damage = ability.damage;
+      a.damageKind = static_cast<int32_t>(ability.damageKind);
+      a.conditionTags = conditionTags(ability.tags);
+      a.rootEffects = ability.rootEffects;
+      m_abilities.push_back(a);
+    }
+
+    record.spells = {static_cast<uint32_t>(m_spells.size()),
+                     static_cast<uint32_t>(monster.spells.size())};
+    for (const auto &spell : monster.spells) {
+      SnapshotSpell s{};
+      s.name = intern(spell.name);
+      s.description = intern(spell.description);
+      s.attackRollType = intern(spell.attackRollType);
+      s.savingThrowType = intern(spell.savingThrowType);
+      s.damageDice = intern(spell.damageDice);
+      s.damageType = intern(spell.damageType);
+      s.damageModifierAbility = intern(spell.damageModifierAbility);
+      s.level = spell.level;
+      s.actionType = static_cast<int32_t>(spell.actionType);
+      s.savingThrowDC = spell.savingThrowDC;
+      s.damage = spell.damage;
+      s.damageKind = static_cast<int32_t>(spell.damageKind);
+      s.conditionTags = conditionTags(spell.tags);
+      s.rootEffects = spell.rootEffects;
+      m_spells.push_back(s);
+    }
+
+    record.effects = effects(monster.effects);
+    record.effectText = intern(monster.effects.allText());
+
+    m_monsters.push_back(record);
+  }
+
+  bool write(const std::string &path, uint64_t sourceChecksum) const {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.sourceChecksum = sourceChecksum;
+
+    uint32_t offset = sizeof(SnapshotHeader);
+    auto place = [&offset](SnapshotSection &section, size_t count,
+                           size_t bytes) {
+      section.offset = offset;
+      section.count = static_cast<uint32_t>(count);
+      offset += static_cast<uint32_t>((bytes + 7) & ~size_t(7));
+    };
+    place(header.monsters, m_monsters.size(),
+          m_monsters.size() * sizeof(SnapshotMonster));
+    place(header.abilities, m_abilities.size(),
+          m_abilities.size() * sizeof(SnapshotAbility));
+    place(header.spells, m_spells.size(),
+          m_spells.size() * sizeof(SnapshotSpell));
+    place(header.effects, m_effects.size(),
+          m_effects.size() * sizeof(EffectNode));
+    place(header.conditionTags, m_conditionTags.size(),
+          m_conditionTags.size() * sizeof(ConditionTag));
+    place(header.stringLists, m_stringLists.size(),
+          m_stringLists.size() * sizeof(SnapshotString));
+    place(header.strings, m_strings.size(), m_strings.size());
+
+    std::string tempPath = path + ".tmp";
+    {
+      std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+      if (!out) {
+        return false;
+      }
+      auto emit = [&out](const void *data, size_t bytes) {
+        static const char padding[8] = {};
+        out.write(static_cast<const char *>(data), bytes);
+        out.write(padding, ((bytes + 7) & ~size_t(7)) - bytes);
+      };
+      emit(&header, sizeof(header));
+      emit(m_monsters.data(), m_monsters.size() * sizeof(SnapshotMonster));
+      emit(m_abilities.data(), m_abilities.size() * sizeof(SnapshotAbility));
+      emit(m_spells.data(), m_spells.size() * sizeof(SnapshotSpell));
+      emit(m_effects.data(), m_effects.size() * sizeof(EffectNode));
+      emit(m_conditionTags.data(),
+           m_conditionTags.size() * sizeof(ConditionTag));
+      emit(m_stringLists.data(),
+           m_stringLists.size() * sizeof(SnapshotString));
+      emit(m_strings.data(), m_strings.size());
+      if (!out) {
+        return false;
+      }
+    }
+    std::remove(path.c_str());
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+  }
+
+private:
+  std::vector<SnapshotMonster> m_monsters;
+  std::vector<SnapshotAbility> m_abilities;
+  std::vector<SnapshotSpell> m_spells;
+  std::vector<EffectNode> m_effects;
+  std::vector<ConditionTag> m_conditionTags;
+  std::vector<SnapshotString> m_stringLists;
+  std::vector<char> m_strings;
+  std::unordered_map<std::string, SnapshotString> m_internedStrings;
+};
+
+} // namespace
+
+bool compileBestiarySnapshot(const MonsterCatalog &catalog,
+                             uint64_t sourceChecksum, const std::string &path) {
+  SnapshotWriter writer;
+  // catalog.names is already in the byte order find() relies on.
+  for (const auto &name : catalog.names) {
+    auto id = catalog.idsByName.find(name);
+    if (id != catalog.idsByName.end()) {
+      writer.addMonster(id->second, *catalog.findById(id->second));
+    }
+  }
+  if (!writer.write(path, sourceChecksum)) {
+    std::cerr << "Failed to write bestiary snapshot: " << path << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// --- Reader ---
+
+std::unique_ptr<BestiarySnapshot>
+BestiarySnapshot::open(const std::string &path, uint64_t expectedChecksum) {
+  std::unique_ptr<BestiarySnapshot> snapshot(new BestiarySnapshot());
+  size_t fileSize = 0;
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+  snapshot->m_file = file;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    return nullptr;
+  }
+  fileSize = static_cast<size_t>(size.QuadPart);
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    return nullptr;
+  }
+  snapshot->m_mapping = mapping;
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    return nullptr;
+  }
+  snapshot->m_base = static_cast<const unsigned char *>(view);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    ::close(fd);
+    return nullptr;
+  }
+  fileSize = static_cast<size_t>(info.st_size);
+  void *view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // The mapping keeps the file alive
+  if (view == MAP_FAILED) {
+    return nullptr;
+  }
+  snapshot->m_base = static_cast<const unsigned char *>(view);
+#endif
+  snapshot->m_size = fileSize;
+
+  if (!snapshot->validate(fileSize, expectedChecksum)) {
+    return nullptr;
+  }
+  return snapshot;
+}
+
+BestiarySnapshot::~BestiarySnapshot() {
+#ifdef _WIN32
+  if (m_base) {
+    UnmapViewOfFile(m_base);
+  }
+  if (m_mapping) {
+    CloseHandle(m_mapping);
+  }
+  if (m_file) {
+    CloseHandle(m_file);
+  }
+#else
+  if (m_base) {
+    munmap(const_cast<unsigned char *>(m_base), m_size);
+  }
+#endif
+}
+
+namespace {
+
+// Enum fields come from the file as raw integers, so each is checked against
+// the last value the enum has before it is used as one.
+template <typename Enum> bool enumOk(int64_t raw, Enum last) {
+  return raw >= 0 && raw <= static_cast<int64_t>(last);
+}
+template <typename Enum> bool enumOk(Enum value, Enum last) {
+  return enumOk(static_cast<int64_t>(value), last);
+}
+
+// Only dice parseDice() could have produced: a zero-sided die would divide
+// by zero in rollFace().
+bool diceOk(const DiceExpr &dice) {
+  if (dice.termCount > DiceExpr::kMaxTerms) {
+    return false;
+  }
+  for (uint8_t i = 0; i < dice.termCount; ++i) {
+    const DiceTerm &term = dice.terms[i];
+    if (term.sides == 0 || (term.explode && term.sides == 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+// Bounds-checks every offset once so the accessors can trust them, and
+// checks every enum and dice expression they lead to.
+bool BestiarySnapshot::validate(size_t fileSize, uint64_t expectedChecksum) {
+  if (fileSize < sizeof(SnapshotHeader)) {
+    return false;
+  }
+  const auto *header = reinterpret_cast<const SnapshotHeader *>(m_base);
+  if (std::memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 ||
+      header->version != kSnapshotVersion ||
+      header->headerSize != sizeof(SnapshotHeader) ||
+      header->sourceChecksum != expectedChecksum) {
+    return false;
+  }
+
+  auto section = [&](const SnapshotSection &s, size_t recordSize,
+                     auto &span) -> bool {
+    if (s.offset % 4 != 0 ||
+        uint64_t(s.offset) + uint64_t(s.count) * recordSize > fileSize) {
+      return false;
+    }
+    using Record = std::remove_const_t<
+        std::remove_pointer_t<decltype(span.data)>>;
+    span.data = reinterpret_cast<const Record *>(m_base + s.offset);
+    span.count = s.count;
+    return true;
+  };
+  if (!section(header->monsters, sizeof(SnapshotMonster), m_monsters) ||
+      !section(header->abilities, sizeof(SnapshotAbility), m_abilities) ||
+      !section(header->spells, sizeof(SnapshotSpell), m_spells) ||
+      !section(header->effects, sizeof(EffectNode), m_effects) ||
+      !section(header->conditionTags, sizeof(ConditionTag),
+               m_conditionTags) ||
+      !section(header->stringLists, sizeof(SnapshotString), m_stringLists) ||
+      uint64_t(header->strings.offset) + header->strings.count > fileSize) {
+    return false;
+  }
+  m_strings = reinterpret_cast<const char *>(m_base + header->strings.offset);
+  m_stringBytes = header->strings.count;
+
+  auto stringOk = [this](SnapshotString s) {
+    return uint64_t(s.offset) + s.length <= m_stringBytes;
+  };
+  auto rangeOk = [](SnapshotRange r, uint32_t limit) {
+    return uint64_t(r.first) + r.count <= limit;
+  };
+
+  for (const auto &s : m_stringLists) {
+    if (!stringOk(s)) {
+      return false;
+    }
+  }
+  for (const ConditionTag &tag : m_conditionTags) {
+    if (!enumOk(tag.condition, Condition::UNCONSCIOUS)) {
+      return false;
+    }
+  }
+  const uint32_t tags = m_conditionTags.count;
+  for (const auto &a : m_abilities) {
+    if (!stringOk(a.name) || !stringOk(a.description) || !stringOk(a.type) ||
+        !stringOk(a.usageType) || !stringOk(a.targetType) ||
+        !stringOk(a.attackRollType) || !stringOk(a.savingThrowType) ||
+        !stringOk(a.damageDice) || !stringOk(a.damageType) ||
+        !stringOk(a.damageModifierAbility) ||
+        !rangeOk(a.conditionTags, tags) ||
+        a.resource < -1 || a.resource >= Resources::kCapacity ||
+        !enumOk(a.actionType, ActionType::LAIR) ||
+        !enumOk(a.damageKind, DamageType::HEALING) || !diceOk(a.damage)) {
+      return false;
+    }
+  }
+  for (const auto &s : m_spells) {
+    if (!stringOk(s.name) || !stringOk(s.description) ||
+        !stringOk(s.attackRollType) || !stringOk(s.savingThrowType) ||
+        !stringOk(s.damageDice) || !stringOk(s.damageType) ||
+        !stringOk(s.damageModifierAbility) ||
+        !rangeOk(s.conditionTags, tags) ||
+        !enumOk(s.actionType, ActionType::LAIR) ||
+        !enumOk(s.damageKind, DamageType::HEALING) || !diceOk(s.damage)) {
+      return false;
+    }
+  }
+  // Effect ranges count from the first node of their own monster. The
+  // writer lays children out after their parent, so a child range starting
+  // at or before its node would be a cycle, which the resolver's tree walk
+  // would never leave.
+  auto effectsOk = [&](const SnapshotMonster &m) {
+    const uint32_t nodes = m.effects.count;
+    const uint32_t text = m.effectText.length;
+    auto textOk = [text](EffectText t) {
+      return uint64_t(t.offset) + t.length <= text;
+    };
+    const SnapshotSpan<EffectNode> arena = effects(m);
+    for (uint32_t i = 0; i < arena.size(); ++i) {
+      const EffectNode &node = arena[i];
+      if (node.children.first <= i ||
+          !rangeOk({node.children.first, node.children.count}, nodes) ||
+          !enumOk(node.trigger, TriggerCondition::ON_SAVE_FAIL) ||
+          !enumOk(node.damageKind, DamageType::HEALING) ||
+          !enumOk(node.condition, Condition::UNCONSCIOUS) ||
+          !enumOk(node.saveAbility, AbilityScore::CHARISMA) ||
+          !enumOk(node.modifierAbility, AbilityScore::CHARISMA) ||
+          !diceOk(node.damage) ||
+          !textOk(node.description) || !textOk(node.attackRollType) ||
+          !textOk(node.savingThrowType) || !textOk(node.damageDice) ||
+          !textOk(node.damageType) || !textOk(node.damageModifierAbility) ||
+          !textOk(node.conditionToApply)) {
+        return false;
+      }
+    }
+    for (const auto &a : abilities(m)) {
+      if (!rangeOk({a.rootEffects.first, a.rootEffects.count}, nodes)) {
+        return false;
+      }
+    }
+    for (const auto &s : spells(m)) {
+      if (!rangeOk({s.rootEffects.first, s.rootEffects.count}, nodes)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  const uint32_t lists = m_stringLists.count;
+  for (const auto &m : m_monsters) {
+    if (!stringOk(m.name) || !stringOk(m.size) || !stringOk(m.type) ||
+        !stringOk(m.alignment) || !stringOk(m.hitDice) ||
+        !stringOk(m.challengeRating) || !stringOk(m.languages) ||
+        !rangeOk(m.speeds, lists) || !rangeOk(m.skills, lists) ||
+        !rangeOk(m.savingThrows, lists) || !rangeOk(m.senses, lists) ||
+        !rangeOk(m.conditionImmunities, lists) ||
+        !rangeOk(m.damageImmunities, lists) ||
+        !rangeOk(m.damageResistances, lists) ||
+        !rangeOk(m.damageVulnerabilities, lists) ||
+        !rangeOk(m.abilities, m_abilities.count) ||
+        !rangeOk(m.spells, m_spells.count) ||
+        !rangeOk(m.effects, m_effects.count) || !stringOk(m.effectText) ||
+        !effectsOk(m)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int BestiarySnapshot::find(std::string_view name) const {
+  const SnapshotMonster *first = m_monsters.begin();
+  const SnapshotMonster *last = m_monsters.end();
+  const SnapshotMonster *it = std::lower_bound(
+      first, last, name, [this](const SnapshotMonster &m, std::string_view n) {
+        return str(m.name) < n;
+      });
+  if (it == last || str(it->name) != name) {
+    return -1;
+  }
+  return static_cast<int>(it - first);
+}
+
+// --- Materialization ---
+
+namespace {
+
+std::vector<std::string> toStrings(const BestiarySnapshot &snapshot,
+                                   SnapshotRange range) {
+  std::vector<std::string> list;
+  list.reserve(range.count);
+  for (const auto &s : snapshot.strings(range)) {
+    list.emplace_back(snapshot.str(s));
+  }
+  return list;
+}
+
+ActionTags toTags(const BestiarySnapshot &snapshot, SnapshotRange range) {
+  const auto tags = snapshot.conditionTags(range);
+  ActionTags copied;
+  copied.conditions.assign(tags.begin(), tags.end());
+  return copied;
+}
+
+} // namespace
+
+Monster BestiarySnapshot::materialize(uint32_t index) const {
+  const SnapshotMonster &record = m_monsters[index];
+  Monster monster;
+  monster.name = std::string(str(record.name));
+  monster.size = std::string(str(record.size));
+  monster.type = std::string(str(record.type));
+  monster.alignment = std::string(str(record.alignment));
+  monster.armorClass = record.armorClass;
+  monster.hitPoints = record.hitPoints;
+  monster.hitDice = std::string(str(record.hitDice));
+  monster.strength = record.strength;
+  monster.dexterity = record.dexterity;
+  monster.constitution = record.constitution;
+  monster.intelligence = record.intelligence;
+  monster.wisdom = record.wisdom;
+  monster.charisma = record.charisma;
+  monster.challengeRating = std::string(str(record.challengeRating));
+  monster.languages = std::string(str(record.languages));
+  monster.spellSaveDC = record.spellSaveDC;
+  monster.spellAttackBonus = record.spellAttackBonus;
+  monster.spellSlots.assign(std::begin(record.spellSlots),
+                            std::end(record.spellSlots));
+
+  monster.speeds = toStrings(*this, record.speeds);
+  monster.skills = toStrings(*this, record.skills);
+  monster.savingThrows = toStrings(*this, record.savingThrows);
+  monster.senses = toStrings(*this, record.senses);
+  monster.conditionImmunities = toStrings(*this, record.conditionImmunities);
+  monster.damageImmunities = toStrings(*this, record.damageImmunities);
+  monster.damageResistances = toStrings(*this, record.damageResistances);
+  monster.damageVulnerabilities =
+      toStrings(*this, record.damageVulnerabilities);
+  monster.damageDefenses = record.damageDefenses;
+  monster.maxResources = record.maxResources;
+  monster.legendaryActions = record.legendaryActions;
+  monster.lairActions = record.lairActions != 0;
+  const SnapshotSpan<EffectNode> nodes = effects(record);
+  monster.effects.assign(nodes.begin(), nodes.size(), str(record.effectText));
+
+  monster.abilities.reserve(record.abilities.count);
+  for (const auto &a : abilities(record)) {
+    Ability ability;
+    ability.name = std::string(str(a.name));
+    ability.description = std::string(str(a.description));
+    ability.actionType = static_cast<ActionType>(a.actionType);
+    ability.type = std::string(str(a.type));
+    ability.usageType = std::string(str(a.usageType));
+    ability.usesMax = a.usesMax;
+    ability.rechargeValue = a.rechargeValue;
+    ability.resource = a.resource;
+    ability.legendaryCost = a.legendaryCost;
+    ability.targetType = std::string(str(a.targetType));
+    ability.attackRollType = std::string(str(a.attackRollType));
+    ability.savingThrowType = std::string(str(a.savingThrowType));
+    ability.savingThrowDC = a.savingThrowDC;
+    ability.damageDice = std::string(str(a.damageDice));
+    ability.damage = a.damage;
+    ability.damageType = std::string(str(a.damageType));
+    ability.damageKind = static_cast<DamageType>(a.damageKind);
+    ability.damageModifierAbility = std::string(str(a.damageModifierAbility));
+    ability.tags = toTags(*this, a.conditionTags);
+    ability.rootEffects = a.rootEffects;
+    monster.abilities.push_back(std::move(ability));
+  }
+
+  monster.spells.reserve(record.spells.count);
+  for (const auto &s : spells(record)) {
+    Spell spell;
+    spell.name = std::string(str(s.name));
+    spell.description = std::string(str(s.description));
+    spell.level = s.level;
+    spell.actionType = static_cast<ActionType>(s.actionType);
+    spell.attackRollType = std::string(str(s.attackRollType));
+    spell.savingThrowType = std::string(str(s.savingThrowType));
+    spell.savingThrowDC = s.savingThrowDC;
+    spell.damageDice = std::string(str(s.damageDice));
+    spell.damage = s.damage;
+    spell.damageType = std::string(str(s.damageType));
+    spell.damageKind = static_cast<DamageType>(s.damageKind);
+    spell.damageModifierAbility = std::string(str(s.damageModifierAbility));
+    spell.tags = toTags(*this, s.conditionTags);
+    spell.rootEffects = s.rootEffects;
+    monster.spells.push_back(std::move(spell));
+  }
+  return monster;
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "monster.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct MonsterCatalog;
+
+// Lives next to the database it was compiled from.
+constexpr const char *kSnapshotPath = "../data/initiativ.bestiary";
+
+// --- Binary Bestiary Snapshot ---
+// A flattened, read-only copy of the MonsterCatalog meant to be memory-mapped
+// and used in place. Every record is plain data; text lives in one shared,
+// de-duplicated string table and is addressed by offset. Lists (speeds,
+// abilities, condition tags...) are ranges into flat record arrays. What the
+// loader derives from the text (compiled dice, interned damage types, tags,
+// defenses, resource slots and each monster's flattened EffectNodes) is
+// stored already derived, so nothing is parsed again on the way out. The file
+// is written in native byte order and is treated as a cache: any mismatch in
+// magic, version, size or source checksum simply means "rebuild it".
+
+constexpr uint32_t kSnapshotVersion = 2;
+
+struct SnapshotString {
+  uint32_t offset;
+  uint32_t length;
+};
+
+struct SnapshotRange {
+  uint32_t first;
+  uint32_t count;
+};
+
+struct SnapshotAbility {
+  SnapshotString name;
+  SnapshotString description;
+  SnapshotString type;
+  SnapshotString usageType;
+  SnapshotString targetType;
+  SnapshotString attackRollType;
+  SnapshotString savingThrowType;
+  SnapshotString damageDice;
+  SnapshotString damageType;
+  SnapshotString damageModifierAbility;
+  int32_t actionType; // ActionType
+  int32_t usesMax;
+  int32_t rechargeValue;
+  int32_t resource;
+  int32_t legendaryCost;
+  int32_t savingThrowDC;
+  DiceExpr damage;
+  int32_t damageKind;          // DamageType
+  SnapshotRange conditionTags; // Into the condition tag array
+  EffectRange rootEffects;     // Into the monster's effect nodes
+};
+
+struct SnapshotSpell {
+  SnapshotString name;
+  SnapshotString description;
+  SnapshotString attackRollType;
+  SnapshotString savingThrowType;
+  SnapshotString damageDice;
+  SnapshotString damageType;
+  SnapshotString damageModifierAbility;
+  int32_t level;
+  int32_t actionType; // ActionType
+  int32_t savingThrowDC;
+  DiceExpr damage;
+  int32_t damageKind;          // DamageType
+  SnapshotRange conditionTags; // Into the condition tag array
+  EffectRange rootEffects;     // Into the monster's effect nodes
+};
+
+struct SnapshotMonster {
+  int32_t monsterId;
+  SnapshotString name;
+  SnapshotString size;
+  SnapshotString type;
+  SnapshotString alignment;
+  SnapshotString hitDice;
+  SnapshotString challengeRating;
+  SnapshotString languages;
+  int32_t armorClass;
+  int32_t hitPoints;
+  int32_t strength;
+  int32_t dexterity;
+  int32_t constitution;
+  int32_t intelligence;
+  int32_t wisdom;
+  int32_t charisma;
+  int32_t spellSaveDC;
+  int32_t spellAttackBonus;
+  int32_t spellSlots[9];
+  DamageDefenses damageDefenses;
+  int32_t legendaryActions;
+  int32_t lairActions;
+  Resources maxResources;
+  // Ranges into the shared string-list array
+  SnapshotRange speeds;
+  SnapshotRange skills;
+  SnapshotRange savingThrows;
+  SnapshotRange senses;
+  SnapshotRange conditionImmunities;
+  SnapshotRange damageImmunities;
+  SnapshotRange damageResistances;
+  SnapshotRange damageVulnerabilities;
+  // Ranges into the ability and spell arrays
+  SnapshotRange abilities;
+  SnapshotRange spells;
+  // The monster's EffectArena: its nodes, whose children ranges count from
+  // the first of them, and the text they refer to
+  SnapshotRange effects;
+  SnapshotString effectText;
+};
+
+struct SnapshotSection {
+  uint32_t offset; // Bytes from the start of the file
+  uint32_t count;  // Records, or bytes for the string table
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  uint64_t sourceChecksum;  // checksumFile() of the SQLite database
+  SnapshotSection monsters; // Sorted by name
+  SnapshotSection abilities;
+  SnapshotSection spells;
+  SnapshotSection effects;
+  SnapshotSection conditionTags;
+  SnapshotSection stringLists;
+  SnapshotSection strings;
+};
+
+// A read-only view over `count` records that live inside the mapping.
+template <typename T> struct SnapshotSpan {
+  const T *data = nullptr;
+  uint32_t count = 0;
+
+  const T *begin() const { return data; }
+  const T *end() const { return data + count; }
+  uint32_t size() const { return count; }
+  const T &operator[](uint32_t index) const { return data[index]; }
+};
+
+class BestiarySnapshot {
+public:
+  // Maps the snapshot at `path`. Returns nullptr when the file is missing,
+  // malformed, from another format version, or was compiled from a database
+  // whose checksum differs from `expectedChecksum`.
+  static std::unique_ptr<BestiarySnapshot> open(const std::string &path,
+                                                uint64_t expectedChecksum);
+  ~BestiarySnapshot();
+
+  BestiarySnapshot(const BestiarySnapshot &) = delete;
+  BestiarySnapshot &operator=(const BestiarySnapshot &) = delete;
+
+  uint32_t size() const { return m_monsters.count; }
+  const SnapshotMonster &monster(uint32_t index) const {
+    return m_monsters[index];
+  }
+  std::string_view name(uint32_t index) const {
+    return str(m_monsters[index].name);
+  }
+  // Binary search over the name-sorted monster array; -1 when absent.
+  int find(std::string_view name) const;
+
+  std::string_view str(SnapshotString s) const {
+    return std::string_view(m_strings + s.offset, s.length);
+  }
+  SnapshotSpan<SnapshotString> strings(SnapshotRange range) const {
+    return {m_stringLists.data + range.first, range.count};
+  }
+  SnapshotSpan<SnapshotAbility> abilities(const SnapshotMonster &m) const {
+    return {m_abilities.data + m.abilities.first, m.abilities.count};
+  }
+  SnapshotSpan<SnapshotSpell> spells(const SnapshotMonster &m) const {
+    return {m_spells.data + m.spells.first, m.spells.count};
+  }
+  SnapshotSpan<EffectNode> effects(const SnapshotMonster &m) const {
+    return {m_effects.data + m.effects.first, m.effects.count};
+  }
+  SnapshotSpan<ConditionTag> conditionTags(SnapshotRange range) const {
+    return {m_conditionTags.data + range.first, range.count};
+  }
+
+  // Builds the heap-owning Monster that combatants share. Only copies: the
+  // records already hold everything the loader derives from the text.
+  Monster materialize(uint32_t index) const;
+
+private:
+  BestiarySnapshot() = default;
+  bool validate(size_t fileSize, uint64_t expectedChecksum);
+
+  const unsigned char *m_base = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  void *m_file = nullptr;
+  void *m_mapping = nullptr;
+#endif
+
+  SnapshotSpan<SnapshotMonster> m_monsters;
+  SnapshotSpan<SnapshotAbility> m_abilities;
+  SnapshotSpan<SnapshotSpell> m_spells;
+  SnapshotSpan<EffectNode> m_effects;
+  SnapshotSpan<ConditionTag> m_conditionTags;
+  SnapshotSpan<SnapshotString> m_stringLists;
+  const char *m_strings = nullptr;
+  uint32_t m_stringBytes = 0;
+};
+
+// 64-bit FNV-1a style hash of the file contents; 0 if it cannot be read.
+uint64_t checksumFile(const std::string &path);
+
+// Flattens `catalog` into a snapshot at `path`, replacing it atomically.
+bool compileBestiarySnapshot(const MonsterCatalog &catalog,
+                             uint64_t sourceChecksum, const std::string &path);
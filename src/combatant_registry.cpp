@@ -0,0 +1,76 @@
+#include "combatant_registry.h"
+
+CombatantHandle CombatantRegistry::acquire() {
+  uint32_t slot;
+  if (!m_freeSlots.empty()) {
+    slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+  } else {
+    slot = static_cast<uint32_t>(m_slots.size());
+    m_slots.emplace_back();
+  }
+  return {slot, m_slots[slot].generation};
+}
+
+void CombatantRegistry::release(CombatantHandle handle) {
+  if (!handle || handle.slot >= m_slots.size() ||
+      m_slots[handle.slot].generation != handle.generation) {
+    return; // Stale or never issued
+  }
+  Slot &slot = m_slots[handle.slot];
+  slot.index = -1;
+  if (++slot.generation == 0) {
+    slot.generation = 1; // Skip the null generation on wrap-around
+  }
+  m_freeSlots.push_back(handle.slot);
+}
+
+void CombatantRegistry::reindex(const std::vector<Combatant> &combatants) {
+  for (auto &slot : m_slots) {
+    slot.index = -1;
+  }
+  for (int i = 0; i < static_cast<int>(combatants.size()); ++i) {
+    CombatantHandle handle = combatants[i].handle;
+    if (handle.slot < m_slots.size() &&
+        m_slots[handle.slot].generation == handle.generation) {
+      m_slots[handle.slot].index = i;
+    }
+  }
+}
+
+int CombatantRegistry::indexOf(CombatantHandle handle) const {
+  if (!handle || handle.slot >= m_slots.size()) {
+    return -1;
+  }
+  const Slot &slot = m_slots[handle.slot];
+  return slot.generation == handle.generation ? slot.index : -1;
+}
+
+Combatant *CombatantRegistry::resolve(std::vector<Combatant> &combatants,
+                                      CombatantHandle handle) const {
+  int index = indexOf(handle);
+  if (index < 0 || index >= static_cast<int>(combatants.size()) ||
+      combatants[index].handle != handle) {
+    return nullptr;
+  }
+  return &combatants[index];
+}
+
+const Ability *resolveAbility(const Combatant &owner,
+                              const ActionHandle &action) {
+  const auto &abilities = owner.base->abilities;
+  if (action.kind != ActionKind::ABILITY || owner.handle != action.owner ||
+      action.index < 0 || action.index >= static_cast<int>(abilities.size())) {
+    return nullptr;
+  }
+  return &abilities[action.index];
+}
+
+const Spell *resolveSpell(const Combatant &owner, const ActionHandle &action) {
+  const auto &spells = owner.base->spells;
+  if (action.kind != ActionKind::SPELL || owner.handle != action.owner ||
+      action.index < 0 || action.index >= static_cast<int>(spells.size())) {
+    return nullptr;
+  }
+  return &spells[action.index];
+}
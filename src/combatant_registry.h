@@ -0,0 +1,40 @@
+#pragma once
+
+#include "handles.h"
+#include "monster.h"
+#include <cstdint>
+#include <vector>
+
+// --- Combatant Registry ---
+// Issues CombatantHandles and maps them to positions in the encounter list.
+// Each handle owns a slot; removing a combatant bumps that slot's generation,
+// so any handle still held for it (a pending target, an open save prompt)
+// stops resolving instead of landing on whoever moved into its place. The
+// list itself is free to reallocate and reorder, as long as reindex() is
+// called after anything that moves combatants around.
+class CombatantRegistry {
+public:
+  CombatantHandle acquire();
+  void release(CombatantHandle handle);
+  void reindex(const std::vector<Combatant> &combatants);
+
+  // Position of the combatant in the list last passed to reindex(), or -1.
+  int indexOf(CombatantHandle handle) const;
+  Combatant *resolve(std::vector<Combatant> &combatants,
+                     CombatantHandle handle) const;
+
+private:
+  struct Slot {
+    uint32_t generation = 1;
+    int index = -1;
+  };
+
+  std::vector<Slot> m_slots;
+  std::vector<uint32_t> m_freeSlots;
+};
+
+// The ability or spell an ActionHandle names on `owner`, or nullptr when the
+// handle is of the other kind or out of range.
+const Ability *resolveAbility(const Combatant &owner,
+                              const ActionHandle &action);
+const Spell *resolveSpell(const Combatant &owner, const ActionHandle &action);
@@ -0,0 +1,66 @@
+#include "condition_wheel.h"
+#include <algorithm>
+
+void ConditionWheel::apply(Combatant &target, Condition condition,
+                           int turns) {
+  if (condition == Condition::NONE) {
+    return;
+  }
+  const uint32_t expiresAt = m_now + static_cast<uint32_t>(std::max(1, turns));
+  if (target.conditions.has(condition) &&
+      target.conditions.expiresAt(condition) >= expiresAt) {
+    return;
+  }
+  target.conditions.set(condition, expiresAt);
+  schedule({target.handle, condition, expiresAt});
+}
+
+int ConditionWheel::remaining(const Combatant &combatant,
+                              Condition condition) const {
+  if (!combatant.conditions.has(condition)) {
+    return 0;
+  }
+  return static_cast<int>(combatant.conditions.expiresAt(condition) - m_now);
+}
+
+void ConditionWheel::advance(std::vector<Combatant> &combatants,
+                             const CombatantRegistry &registry,
+                             std::vector<ExpiredCondition> &expired) {
+  ++m_now;
+  if (m_now % kSlots == 0) {
+    // A new lap: whatever now fits in the wheel moves into it.
+    size_t kept = 0;
+    for (const Entry &entry : m_overflow) {
+      ++m_visited;
+      if (entry.expiresAt - m_now < kSlots) {
+        m_buckets[entry.expiresAt % kSlots].push_back(entry);
+      } else {
+        m_overflow[kept++] = entry;
+      }
+    }
+    m_overflow.resize(kept);
+  }
+
+  // Everything in the bucket ends this turn; entries are filed less than a
+  // lap ahead.
+  std::vector<Entry> &bucket = m_buckets[m_now % kSlots];
+  for (const Entry &entry : bucket) {
+    ++m_visited;
+    Combatant *combatant = registry.resolve(combatants, entry.combatant);
+    if (!combatant || !combatant->conditions.has(entry.condition) ||
+        combatant->conditions.expiresAt(entry.condition) != m_now) {
+      continue; // Left, cleared or re-applied since
+    }
+    combatant->conditions.clear(entry.condition);
+    expired.push_back({entry.combatant, entry.condition});
+  }
+  bucket.clear();
+}
+
+void ConditionWheel::schedule(const Entry &entry) {
+  if (entry.expiresAt - m_now < kSlots) {
+    m_buckets[entry.expiresAt % kSlots].push_back(entry);
+  } else {
+    m_overflow.push_back(entry);
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "combatant_registry.h"
+#include "conditions.h"
+#include "handles.h"
+#include "monster.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ExpiredCondition {
+  CombatantHandle combatant;
+  Condition condition = Condition::NONE;
+};
+
+// --- Condition Expiry ---
+// Turns are counted from the start of the encounter, and each condition is
+// filed under the turn it ends on in a wheel of buckets, one per turn, so
+// moving to the next turn only looks at what ends on it. Expiries beyond
+// the wheel's reach wait in an overflow list that is re-filed once per lap.
+// Entries are never taken out early: one whose condition was cleared or
+// re-applied, or whose combatant has left, is skipped when its turn comes.
+class ConditionWheel {
+public:
+  uint32_t now() const { return m_now; }
+
+  // Gives `target` `condition` for `turns` turns (at least one). Already
+  // having it for longer keeps the longer duration.
+  void apply(Combatant &target, Condition condition, int turns);
+
+  // Turns left on `condition`, or 0 if `combatant` does not have it.
+  int remaining(const Combatant &combatant, Condition condition) const;
+
+  // Moves to the next turn, ends the conditions that run out on it and
+  // appends them to `expired`.
+  void advance(std::vector<Combatant> &combatants,
+               const CombatantRegistry &registry,
+               std::vector<ExpiredCondition> &expired);
+
+  // Entries looked at by advance() so far, stale ones included.
+  size_t visited() const { return m_visited; }
+
+private:
+  static constexpr uint32_t kSlots = 64;
+
+  struct Entry {
+    CombatantHandle combatant;
+    Condition condition;
+    uint32_t expiresAt;
+  };
+
+  void schedule(const Entry &entry);
+
+  uint32_t m_now = 0;
+  std::array<std::vector<Entry>, kSlots> m_buckets; // By expiresAt % kSlots
+  std::vector<Entry> m_overflow; // kSlots or more turns away when filed
+  size_t m_visited = 0;
+};
@@ -0,0 +1,35 @@
+#include "conditions.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// In Condition order.
+const std::string_view kNames[kConditionCount] = {
+    "",           "Blinded",    "Charmed",   "Deafened",
+    "Exhaustion", "Frightened", "Grappled",  "Incapacitated",
+    "Invisible",  "Paralyzed",  "Petrified", "Poisoned",
+    "Prone",      "Restrained", "Stunned",   "Unconscious"};
+
+bool sameName(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) ==
+                  std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
+} // namespace
+
+Condition conditionFromName(std::string_view name) {
+  for (size_t i = 1; i < kConditionCount; ++i) {
+    if (sameName(kNames[i], name)) {
+      return static_cast<Condition>(i);
+    }
+  }
+  return Condition::NONE;
+}
+
+std::string_view conditionName(Condition condition) {
+  return kNames[static_cast<size_t>(condition)];
+}
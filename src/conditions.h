@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// --- Conditions ---
+// The conditions of the rules, interned from their names when abilities,
+// spells and effects are loaded. Names outside the rules have no id and are
+// not applied.
+enum class Condition : uint8_t {
+  NONE,
+  BLINDED,
+  CHARMED,
+  DEAFENED,
+  EXHAUSTION,
+  FRIGHTENED,
+  GRAPPLED,
+  INCAPACITATED,
+  INVISIBLE,
+  PARALYZED,
+  PETRIFIED,
+  POISONED,
+  PRONE,
+  RESTRAINED,
+  STUNNED,
+  UNCONSCIOUS
+};
+
+constexpr size_t kConditionCount = 16; // Including NONE
+
+// Case-insensitive ("poisoned", "Poisoned"); NONE for anything else.
+Condition conditionFromName(std::string_view name);
+// "Poisoned"; empty for NONE.
+std::string_view conditionName(Condition condition);
+
+// A combatant's conditions: one bit each, and the turn each one ends on,
+// counted in turns since the encounter began (see ConditionWheel).
+class ConditionSet {
+public:
+  bool has(Condition condition) const {
+    return (m_active & bit(condition)) != 0;
+  }
+  bool empty() const { return m_active == 0; }
+  uint16_t mask() const { return m_active; }
+  uint32_t expiresAt(Condition condition) const {
+    return m_expiresAt[static_cast<size_t>(condition)];
+  }
+
+  void set(Condition condition, uint32_t expiresAt) {
+    m_active |= bit(condition);
+    m_expiresAt[static_cast<size_t>(condition)] = expiresAt;
+  }
+  void clear(Condition condition) { m_active &= ~bit(condition); }
+  void clear() { m_active = 0; }
+
+  // Calls fn(condition, expiresAt) for each one held, in Condition order.
+  template <typename Fn> void forEach(Fn fn) const {
+    for (size_t index = 1; index < kConditionCount; ++index) {
+      if (m_active & (1u << index)) {
+        fn(static_cast<Condition>(index), m_expiresAt[index]);
+      }
+    }
+  }
+
+private:
+  static uint16_t bit(Condition condition) {
+    return condition == Condition::NONE
+               ? 0
+               : static_cast<uint16_t>(1u << static_cast<unsigned>(condition));
+  }
+
+  uint16_t m_active = 0;
+  std::array<uint32_t, kConditionCount> m_expiresAt{};
+};
@@ -0,0 +1,181 @@
+#include "dice.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+// Minimal cursor over the formula; skips spaces before every token.
+struct DiceScanner {
+  std::string_view text;
+  size_t pos = 0;
+
+  void skipSpaces() {
+    while (pos < text.size() &&
+           std::isspace(static_cast<unsigned char>(text[pos]))) {
+      ++pos;
+    }
+  }
+
+  bool accept(std::string_view word) {
+    skipSpaces();
+    if (text.size() - pos < word.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < word.size(); ++i) {
+      if (std::tolower(static_cast<unsigned char>(text[pos + i])) != word[i]) {
+        return false;
+      }
+    }
+    pos += word.size();
+    return true;
+  }
+
+  bool peekDigit() {
+    skipSpaces();
+    return pos < text.size() &&
+           std::isdigit(static_cast<unsigned char>(text[pos]));
+  }
+
+  bool number(uint32_t limit, uint32_t &value) {
+    if (!peekDigit()) {
+      return false;
+    }
+    value = 0;
+    while (pos < text.size() &&
+           std::isdigit(static_cast<unsigned char>(text[pos]))) {
+      value = value * 10 + static_cast<uint32_t>(text[pos] - '0');
+      if (value > limit) {
+        return false;
+      }
+      ++pos;
+    }
+    return true;
+  }
+
+  bool atEnd() {
+    skipSpaces();
+    return pos == text.size();
+  }
+};
+
+const uint32_t kDiceLimit = std::numeric_limits<uint16_t>::max();
+const uint32_t kModifierLimit = 1000000;
+const uint32_t kFaceLimit = std::numeric_limits<uint8_t>::max();
+
+// Reads the modifiers after "NdM" into `term`.
+bool parseModifiers(DiceScanner &scan, DiceTerm &term) {
+  uint32_t value = 0;
+  while (true) {
+    if (scan.accept("kl")) {
+      if (!scan.number(kDiceLimit, value) || value == 0) {
+        return false;
+      }
+      term.keep = static_cast<uint16_t>(value);
+      term.keepLowest = true;
+    } else if (scan.accept("kh") || scan.accept("k")) {
+      if (!scan.number(kDiceLimit, value) || value == 0) {
+        return false;
+      }
+      term.keep = static_cast<uint16_t>(value);
+      term.keepLowest = false;
+    } else if (scan.accept("!")) {
+      term.explode = true;
+    } else if (scan.accept("min")) {
+      if (!scan.number(std::min<uint32_t>(term.sides, kFaceLimit), value)) {
+        return false;
+      }
+      term.minimum = static_cast<uint8_t>(value);
+    } else if (scan.accept("r")) {
+      // Rerolling every face would never settle on a result.
+      if (!scan.number(std::min<uint32_t>(term.sides - 1u, kFaceLimit),
+                       value)) {
+        return false;
+      }
+      term.rerollAtOrBelow = static_cast<uint8_t>(value);
+    } else {
+      return true;
+    }
+  }
+}
+
+// Adds `term` to `dice`, merging it into an earlier group rolled the same way.
+bool appendTerm(DiceExpr &dice, const DiceTerm &term) {
+  if (term.count == 0) {
+    return true;
+  }
+  if (term.plain()) {
+    for (uint8_t i = 0; i < dice.termCount; ++i) {
+      DiceTerm &other = dice.terms[i];
+      if (other.plain() && other.sides == term.sides &&
+          other.negative == term.negative &&
+          other.count + term.count <= kDiceLimit) {
+        other.count += term.count;
+        return true;
+      }
+    }
+  }
+  if (dice.termCount == DiceExpr::kMaxTerms) {
+    return false;
+  }
+  dice.terms[dice.termCount++] = term;
+  return true;
+}
+
+} // namespace
+
+bool parseDice(std::string_view text, DiceExpr &out) {
+  out = DiceExpr{};
+  DiceScanner scan{text};
+  DiceExpr dice;
+  int64_t constant = 0;
+
+  bool negative = scan.accept("-");
+  do {
+    uint32_t count = 1;
+    bool hasCount = scan.number(kModifierLimit, count);
+    if (!scan.accept("d")) {
+      if (!hasCount) {
+        return false;
+      }
+      constant += negative ? -int64_t(count) : int64_t(count);
+    } else {
+      DiceTerm term;
+      uint32_t sides = 0;
+      if (count > kDiceLimit || !scan.number(kDiceLimit, sides) ||
+          sides == 0) {
+        return false;
+      }
+      term.count = static_cast<uint16_t>(count);
+      term.sides = static_cast<uint16_t>(sides);
+      term.negative = negative;
+      // A d1 would explode forever; keeping needs every die on the stack.
+      if (!parseModifiers(scan, term) || (term.explode && term.sides == 1) ||
+          (term.keep > 0 && term.keep < term.count &&
+           term.count > DiceExpr::kMaxKeptPool) ||
+          !appendTerm(dice, term)) {
+        return false;
+      }
+    }
+    if (constant > kModifierLimit || constant < -int64_t(kModifierLimit)) {
+      return false;
+    }
+    negative = scan.accept("-");
+  } while (negative || scan.accept("+"));
+
+  if (!scan.atEnd()) {
+    return false;
+  }
+  dice.modifier = static_cast<int32_t>(constant);
+  out = dice;
+  return true;
+}
+
+DiceExpr compileDice(std::string_view text) {
+  DiceExpr dice;
+  if (!text.empty() && !parseDice(text, dice)) {
+    std::cerr << "Error: Invalid dice string format: " << text << std::endl;
+  }
+  return dice;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+// One "NdM" group of a dice expression together with its modifiers.
+struct DiceTerm {
+  uint16_t count = 0; // Number of dice
+  uint16_t sides = 0;
+  uint16_t keep = 0;           // Keep this many dice; 0 keeps all
+  bool keepLowest = false;     // "kl" rather than "kh"
+  bool explode = false;        // "!": a die showing its maximum rolls again
+  bool negative = false;       // Subtracted rather than added
+  uint8_t rerollAtOrBelow = 0; // "rN": reroll a die showing N or less, once
+  uint8_t minimum = 0;         // "minN": a die showing less than N counts N
+
+  bool plain() const {
+    return keep == 0 && !explode && rerollAtOrBelow == 0 && minimum == 0;
+  }
+};
+
+// --- Dice Expressions ---
+// A roll formula such as "2d6 + 1d8 + 4" or "2d20kh1", parsed once when a
+// monster is loaded into a fixed list of dice terms plus one folded
+// constant, so a roll never allocates. A bare number ("20") is a fixed value
+// with no dice; an empty expression always rolls 0.
+//
+// Grammar, case-insensitive, spaces ignored:
+//   expr  := ['-'] term (('+' | '-') term)*
+//   term  := number | [number] 'd' number mod*
+//   mod   := 'kh' number | 'kl' number | 'k' number  (keep highest/lowest)
+//          | '!'                                      (exploding dice)
+//          | 'r' number                               (reroll at or below)
+//          | 'min' number                             (minimum per die)
+// Plain groups with the same die and sign are merged, so "4d6 + 4d6" rolls
+// as 8d6.
+struct DiceExpr {
+  static constexpr size_t kMaxTerms = 6;
+  static constexpr uint16_t kMaxKeptPool = 100; // Dice in a "kh"/"kl" group
+  static constexpr int kMaxExplosions = 100;    // Extra rolls per die
+
+  std::array<DiceTerm, kMaxTerms> terms{};
+  uint8_t termCount = 0;
+  int32_t modifier = 0;
+
+  bool empty() const { return termCount == 0 && modifier == 0; }
+
+  static constexpr DiceExpr simple(uint16_t count, uint16_t sides,
+                                   int32_t modifier = 0) {
+    DiceExpr dice;
+    dice.terms[0].count = count;
+    dice.terms[0].sides = sides;
+    dice.termCount = 1;
+    dice.modifier = modifier;
+    return dice;
+  }
+};
+
+constexpr DiceExpr kD20 = DiceExpr::simple(1, 20);
+
+inline bool operator==(const DiceTerm &a, const DiceTerm &b) {
+  return a.count == b.count && a.sides == b.sides && a.keep == b.keep &&
+         a.keepLowest == b.keepLowest && a.explode == b.explode &&
+         a.negative == b.negative && a.rerollAtOrBelow == b.rerollAtOrBelow &&
+         a.minimum == b.minimum;
+}
+
+inline bool operator==(const DiceExpr &a, const DiceExpr &b) {
+  return a.termCount == b.termCount && a.modifier == b.modifier &&
+         std::equal(a.terms.begin(), a.terms.begin() + a.termCount,
+                    b.terms.begin());
+}
+
+// For keying caches on compiled expressions.
+struct DiceExprHash {
+  size_t operator()(const DiceExpr &dice) const {
+    uint64_t h = 1469598103934665603ULL ^ static_cast<uint32_t>(dice.modifier);
+    auto mix = [&](uint64_t value) { h = (h ^ value) * 1099511628211ULL; };
+    for (uint8_t i = 0; i < dice.termCount; ++i) {
+      const DiceTerm &t = dice.terms[i];
+      mix(uint64_t(t.count) | uint64_t(t.sides) << 16 | uint64_t(t.keep) << 32);
+      mix(uint64_t(t.keepLowest) | uint64_t(t.explode) << 1 |
+          uint64_t(t.negative) << 2 | uint64_t(t.rerollAtOrBelow) << 8 |
+          uint64_t(t.minimum) << 16);
+    }
+    return static_cast<size_t>(h);
+  }
+};
+
+// Parses `text` with the grammar above. Returns false and leaves `out` empty
+// for anything else.
+bool parseDice(std::string_view text, DiceExpr &out);
+
+// parseDice() for loaders: reports text that is not a dice expression on
+// stderr and returns an empty expression for it.
+DiceExpr compileDice(std::string_view text);
+
+// A face from 1 to `sides` using the low 32 bits of each draw, by Lemire's
+// multiply-and-reject method. Unlike std::uniform_int_distribution this is
+// the same on every standard library, so seeded replays match everywhere.
+template <typename Rng> int rollFace(uint32_t sides, Rng &rng) {
+  uint64_t m = static_cast<uint64_t>(static_cast<uint32_t>(rng())) * sides;
+  if (static_cast<uint32_t>(m) < sides) {
+    uint32_t threshold = (0u - sides) % sides;
+    while (static_cast<uint32_t>(m) < threshold) {
+      m = static_cast<uint64_t>(static_cast<uint32_t>(rng())) * sides;
+    }
+  }
+  return static_cast<int>(m >> 32) + 1;
+}
+
+// Rolls one die of `term`, applying rerolls, minimums and explosions.
+template <typename Rng> int rollDie(const DiceTerm &term, Rng &rng) {
+  int face = rollFace(term.sides, rng);
+  if (face <= term.rerollAtOrBelow) {
+    face = rollFace(term.sides, rng);
+  }
+  int value = std::max<int>(face, term.minimum);
+  for (int extra = 0; term.explode && face == term.sides &&
+                      extra < DiceExpr::kMaxExplosions;
+       ++extra) {
+    face = rollFace(term.sides, rng);
+    value += face;
+  }
+  return value;
+}
+
+template <typename Rng> int rollTerm(const DiceTerm &term, Rng &rng) {
+  int total = 0;
+  if (term.plain()) {
+    for (uint16_t i = 0; i < term.count; ++i) {
+      total += rollFace(term.sides, rng);
+    }
+  } else if (term.keep == 0 || term.keep >= term.count) {
+    for (uint16_t i = 0; i < term.count; ++i) {
+      total += rollDie(term, rng);
+    }
+  } else {
+    std::array<int, DiceExpr::kMaxKeptPool> pool;
+    for (uint16_t i = 0; i < term.count; ++i) {
+      pool[i] = rollDie(term, rng);
+    }
+    auto kept = pool.begin() + term.keep;
+    auto end = pool.begin() + term.count;
+    if (term.keepLowest) {
+      std::nth_element(pool.begin(), kept, end);
+    } else {
+      std::nth_element(pool.begin(), kept, end, std::greater<int>());
+    }
+    for (auto it = pool.begin(); it != kept; ++it) {
+      total += *it;
+    }
+  }
+  return term.negative ? -total : total;
+}
+
+template <typename Rng> int rollDice(const DiceExpr &dice, Rng &rng) {
+  int total = dice.modifier;
+  for (uint8_t i = 0; i < dice.termCount; ++i) {
+    total += rollTerm(dice.terms[i], rng);
+  }
+  return total;
+}
@@ -0,0 +1,266 @@
+#include "dice_batch.h"
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define INITIATIV_X86_DICE 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using LaneState = uint32_t[4][DiceBatchRoller::kLanes];
+
+uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+uint64_t splitMix64(uint64_t &state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// One xoshiro128++ step of a single lane.
+uint32_t nextLane(LaneState &s, size_t lane) {
+  uint32_t s0 = s[0][lane], s1 = s[1][lane], s2 = s[2][lane],
+           s3 = s[3][lane];
+  uint32_t result = rotl(s0 + s3, 7) + s0;
+  uint32_t t = s1 << 9;
+  s2 ^= s0;
+  s3 ^= s1;
+  s1 ^= s2;
+  s0 ^= s3;
+  s2 ^= t;
+  s3 = rotl(s3, 11);
+  s[0][lane] = s0;
+  s[1][lane] = s1;
+  s[2][lane] = s2;
+  s[3][lane] = s3;
+  return result;
+}
+
+// Lemire's bounded sampling for draw `x` of `lane`. Products whose low half
+// falls under `threshold` would over-represent some faces, so those draws
+// are replaced with further draws from the same lane.
+uint16_t boundedFromLane(LaneState &s, size_t lane, uint32_t x, uint32_t sides,
+                         uint32_t threshold) {
+  uint64_t m = static_cast<uint64_t>(x) * sides;
+  while (static_cast<uint32_t>(m) < threshold) {
+    m = static_cast<uint64_t>(nextLane(s, lane)) * sides;
+  }
+  return static_cast<uint16_t>((m >> 32) + 1);
+}
+
+// Each block writes one roll per lane, in lane order.
+void scalarBlock(LaneState &s, uint32_t sides, uint32_t threshold,
+                 uint16_t *out) {
+  for (size_t lane = 0; lane < DiceBatchRoller::kLanes; ++lane) {
+    out[lane] = boundedFromLane(s, lane, nextLane(s, lane), sides, threshold);
+  }
+}
+
+#ifdef INITIATIV_X86_DICE
+
+__attribute__((target("sse2"))) inline __m128i rotl128(__m128i x, int k) {
+  return _mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k));
+}
+
+__attribute__((target("sse2"))) void sse2Block(LaneState &s, uint32_t sides,
+                                               uint32_t threshold,
+                                               uint16_t *out) {
+  const __m128i sidesVec = _mm_set1_epi32(static_cast<int>(sides));
+  const __m128i signBit = _mm_set1_epi32(INT32_MIN);
+  const __m128i thresholdVec =
+      _mm_xor_si128(_mm_set1_epi32(static_cast<int>(threshold)), signBit);
+  const __m128i lowMask = _mm_set1_epi64x(0xffffffffLL);
+
+  for (size_t half = 0; half < DiceBatchRoller::kLanes; half += 4) {
+    __m128i s0 = _mm_load_si128(reinterpret_cast<__m128i *>(&s[0][half]));
+    __m128i s1 = _mm_load_si128(reinterpret_cast<__m128i *>(&s[1][half]));
+    __m128i s2 = _mm_load_si128(reinterpret_cast<__m128i *>(&s[2][half]));
+    __m128i s3 = _mm_load_si128(reinterpret_cast<__m128i *>(&s[3][half]));
+    __m128i x = _mm_add_epi32(rotl128(_mm_add_epi32(s0, s3), 7), s0);
+    __m128i t = _mm_slli_epi32(s1, 9);
+    s2 = _mm_xor_si128(s2, s0);
+    s3 = _mm_xor_si128(s3, s1);
+    s1 = _mm_xor_si128(s1, s2);
+    s0 = _mm_xor_si128(s0, s3);
+    s2 = _mm_xor_si128(s2, t);
+    s3 = rotl128(s3, 11);
+    _mm_store_si128(reinterpret_cast<__m128i *>(&s[0][half]), s0);
+    _mm_store_si128(reinterpret_cast<__m128i *>(&s[1][half]), s1);
+    _mm_store_si128(reinterpret_cast<__m128i *>(&s[2][half]), s2);
+    _mm_store_si128(reinterpret_cast<__m128i *>(&s[3][half]), s3);
+
+    // 32x32->64 products of the even and odd lanes, then split back into
+    // the high halves (the faces) and low halves (for rejection).
+    __m128i even = _mm_mul_epu32(x, sidesVec);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), sidesVec);
+    __m128i high = _mm_or_si128(_mm_srli_epi64(even, 32),
+                                _mm_andnot_si128(lowMask, odd));
+    __m128i low =
+        _mm_or_si128(_mm_and_si128(even, lowMask), _mm_slli_epi64(odd, 32));
+    int rejected = _mm_movemask_ps(_mm_castsi128_ps(
+        _mm_cmplt_epi32(_mm_xor_si128(low, signBit), thresholdVec)));
+
+    alignas(16) uint32_t faces[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(faces),
+                    _mm_add_epi32(high, _mm_set1_epi32(1)));
+    for (size_t i = 0; i < 4; ++i) {
+      out[half + i] = static_cast<uint16_t>(faces[i]);
+    }
+    if (rejected) {
+      alignas(16) uint32_t draws[4];
+      _mm_store_si128(reinterpret_cast<__m128i *>(draws), x);
+      for (size_t i = 0; i < 4; ++i) {
+        if (rejected & (1 << i)) {
+          out[half + i] =
+              boundedFromLane(s, half + i, draws[i], sides, threshold);
+        }
+      }
+    }
+  }
+}
+
+__attribute__((target("avx2"))) inline __m256i rotl256(__m256i x, int k) {
+  return _mm256_or_si256(_mm256_slli_epi32(x, k), _mm256_srli_epi32(x, 32 - k));
+}
+
+__attribute__((target("avx2"))) void avx2Block(LaneState &s, uint32_t sides,
+                                               uint32_t threshold,
+                                               uint16_t *out) {
+  const __m256i sidesVec = _mm256_set1_epi32(static_cast<int>(sides));
+  const __m256i signBit = _mm256_set1_epi32(INT32_MIN);
+  const __m256i thresholdVec = _mm256_xor_si256(
+      _mm256_set1_epi32(static_cast<int>(threshold)), signBit);
+  const __m256i lowMask = _mm256_set1_epi64x(0xffffffffLL);
+
+  __m256i s0 = _mm256_load_si256(reinterpret_cast<__m256i *>(s[0]));
+  __m256i s1 = _mm256_load_si256(reinterpret_cast<__m256i *>(s[1]));
+  __m256i s2 = _mm256_load_si256(reinterpret_cast<__m256i *>(s[2]));
+  __m256i s3 = _mm256_load_si256(reinterpret_cast<__m256i *>(s[3]));
+  __m256i x = _mm256_add_epi32(rotl256(_mm256_add_epi32(s0, s3), 7), s0);
+  __m256i t = _mm256_slli_epi32(s1, 9);
+  s2 = _mm256_xor_si256(s2, s0);
+  s3 = _mm256_xor_si256(s3, s1);
+  s1 = _mm256_xor_si256(s1, s2);
+  s0 = _mm256_xor_si256(s0, s3);
+  s2 = _mm256_xor_si256(s2, t);
+  s3 = rotl256(s3, 11);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(s[0]), s0);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(s[1]), s1);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(s[2]), s2);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(s[3]), s3);
+
+  __m256i even = _mm256_mul_epu32(x, sidesVec);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), sidesVec);
+  __m256i high = _mm256_or_si256(_mm256_srli_epi64(even, 32),
+                                 _mm256_andnot_si256(lowMask, odd));
+  __m256i low = _mm256_or_si256(_mm256_and_si256(even, lowMask),
+                                _mm256_slli_epi64(odd, 32));
+  int rejected = _mm256_movemask_ps(_mm256_castsi256_ps(
+      _mm256_cmpgt_epi32(thresholdVec, _mm256_xor_si256(low, signBit))));
+
+  // Narrow the eight faces to 16 bits; packus works per 128-bit half, so
+  // the halves are gathered back into order afterwards.
+  __m256i faces = _mm256_add_epi32(high, _mm256_set1_epi32(1));
+  __m256i packed = _mm256_permute4x64_epi64(
+      _mm256_packus_epi32(faces, faces), 0x08);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                   _mm256_castsi256_si128(packed));
+  if (rejected) {
+    alignas(32) uint32_t draws[DiceBatchRoller::kLanes];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(draws), x);
+    for (size_t lane = 0; lane < DiceBatchRoller::kLanes; ++lane) {
+      if (rejected & (1 << lane)) {
+        out[lane] = boundedFromLane(s, lane, draws[lane], sides, threshold);
+      }
+    }
+  }
+}
+
+#endif // INITIATIV_X86_DICE
+
+// Runs `block` over every whole group of kLanes rolls, then once more into
+// scratch for a partial tail.
+template <typename BlockFn>
+void rollBlocks(LaneState &s, uint32_t sides, uint16_t *out, size_t count,
+                BlockFn block) {
+  uint32_t threshold = (0u - sides) % sides;
+  size_t i = 0;
+  for (; i + DiceBatchRoller::kLanes <= count; i += DiceBatchRoller::kLanes) {
+    block(s, sides, threshold, out + i);
+  }
+  if (i < count) {
+    uint16_t tail[DiceBatchRoller::kLanes];
+    block(s, sides, threshold, tail);
+    std::memcpy(out + i, tail, (count - i) * sizeof(uint16_t));
+  }
+}
+
+} // namespace
+
+const char *diceIsaName(DiceIsa isa) {
+  switch (isa) {
+  case DiceIsa::SSE2:
+    return "SSE2";
+  case DiceIsa::AVX2:
+    return "AVX2";
+  default:
+    return "scalar";
+  }
+}
+
+bool diceIsaSupported(DiceIsa isa) {
+  switch (isa) {
+#ifdef INITIATIV_X86_DICE
+  case DiceIsa::SSE2:
+    return __builtin_cpu_supports("sse2");
+  case DiceIsa::AVX2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  case DiceIsa::SCALAR:
+    return true;
+  default:
+    return false;
+  }
+}
+
+DiceIsa bestDiceIsa() {
+  static const DiceIsa best = [] {
+    for (DiceIsa isa : {DiceIsa::AVX2, DiceIsa::SSE2}) {
+      if (diceIsaSupported(isa)) {
+        return isa;
+      }
+    }
+    return DiceIsa::SCALAR;
+  }();
+  return best;
+}
+
+DiceBatchRoller::DiceBatchRoller(uint64_t seed, DiceIsa isa)
+    : m_isa(diceIsaSupported(isa) ? isa : DiceIsa::SCALAR) {
+  for (size_t lane = 0; lane < kLanes; ++lane) {
+    for (size_t word = 0; word < 4; word += 2) {
+      uint64_t bits = splitMix64(seed);
+      m_state[word][lane] = static_cast<uint32_t>(bits);
+      m_state[word + 1][lane] = static_cast<uint32_t>(bits >> 32);
+    }
+  }
+}
+
+void DiceBatchRoller::roll(uint32_t sides, uint16_t *out, size_t count) {
+  switch (m_isa) {
+#ifdef INITIATIV_X86_DICE
+  case DiceIsa::AVX2:
+    rollBlocks(m_state, sides, out, count, avx2Block);
+    break;
+  case DiceIsa::SSE2:
+    rollBlocks(m_state, sides, out, count, sse2Block);
+    break;
+#endif
+  default:
+    rollBlocks(m_state, sides, out, count, scalarBlock);
+    break;
+  }
+}
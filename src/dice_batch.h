@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Instruction sets the batch roller can use, slowest first.
+enum class DiceIsa { SCALAR, SSE2, AVX2 };
+
+const char *diceIsaName(DiceIsa isa);
+// The fastest instruction set this CPU supports (and this build includes).
+DiceIsa bestDiceIsa();
+bool diceIsaSupported(DiceIsa isa);
+
+// --- Batch Dice Rolling ---
+// Fills whole arrays with rolls of one die size, for mass battles and Monte
+// Carlo runs where one rollDice() call per die would dominate. The generator
+// is eight independent xoshiro128++ lanes stepped together, eight rolls at a
+// time with AVX2 or four with SSE2, and one lane at a time in the scalar
+// fallback. Faces are mapped with Lemire's multiply-and-reject method, so
+// every face is exactly equally likely.
+//
+// Every instruction set produces the same rolls from the same seed, so
+// results do not depend on the machine a simulation runs on.
+class DiceBatchRoller {
+public:
+  static constexpr size_t kLanes = 8;
+
+  explicit DiceBatchRoller(uint64_t seed, DiceIsa isa = bestDiceIsa());
+
+  // Writes `count` rolls of a `sides`-sided die (1..sides) to `out`.
+  // `sides` must be between 1 and 65535.
+  void roll(uint32_t sides, uint16_t *out, size_t count);
+
+  DiceIsa isa() const { return m_isa; }
+
+private:
+  // Lane-major xoshiro128++ state: m_state[word][lane].
+  alignas(32) uint32_t m_state[4][kLanes];
+  DiceIsa m_isa;
+};
@@ -0,0 +1,294 @@
+#include "dice_distribution.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace {
+
+// Mass below this is treated as impossible when trimming and exploding.
+const double kNegligible = 1e-12;
+
+// Past this many multiply-adds an FFT is cheaper than the direct sum.
+const size_t kDirectConvolutionLimit = 1 << 16;
+
+// A distribution over consecutive integers starting at `offset`.
+struct Pmf {
+  int offset = 0;
+  std::vector<double> mass{1.0};
+};
+
+void fft(std::vector<std::complex<double>> &a, bool inverse) {
+  size_t n = a.size();
+  for (size_t i = 1, j = 0; i < n; ++i) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(a[i], a[j]);
+    }
+  }
+  const double pi = std::acos(-1.0);
+  for (size_t length = 2; length <= n; length <<= 1) {
+    double angle = 2 * pi / static_cast<double>(length) * (inverse ? -1 : 1);
+    std::complex<double> step(std::cos(angle), std::sin(angle));
+    for (size_t i = 0; i < n; i += length) {
+      std::complex<double> w(1.0);
+      for (size_t k = 0; k < length / 2; ++k) {
+        std::complex<double> u = a[i + k];
+        std::complex<double> v = a[i + k + length / 2] * w;
+        a[i + k] = u + v;
+        a[i + k + length / 2] = u - v;
+        w *= step;
+      }
+    }
+  }
+  if (inverse) {
+    for (auto &x : a) {
+      x /= static_cast<double>(n);
+    }
+  }
+}
+
+std::vector<double> convolve(const std::vector<double> &a,
+                             const std::vector<double> &b) {
+  std::vector<double> result(a.size() + b.size() - 1, 0.0);
+  if (a.size() * b.size() <= kDirectConvolutionLimit) {
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (a[i] == 0.0) {
+        continue;
+      }
+      for (size_t j = 0; j < b.size(); ++j) {
+        result[i + j] += a[i] * b[j];
+      }
+    }
+    return result;
+  }
+
+  size_t n = 1;
+  while (n < result.size()) {
+    n <<= 1;
+  }
+  std::vector<std::complex<double>> fa(a.begin(), a.end());
+  std::vector<std::complex<double>> fb(b.begin(), b.end());
+  fa.resize(n);
+  fb.resize(n);
+  fft(fa, false);
+  fft(fb, false);
+  for (size_t i = 0; i < n; ++i) {
+    fa[i] *= fb[i];
+  }
+  fft(fa, true);
+  for (size_t i = 0; i < result.size(); ++i) {
+    // Rounding leaves tiny negative values where the mass is really 0.
+    result[i] = std::max(0.0, fa[i].real());
+  }
+  return result;
+}
+
+Pmf convolve(const Pmf &a, const Pmf &b) {
+  return {a.offset + b.offset, convolve(a.mass, b.mass)};
+}
+
+// Drops negligible mass from both ends, which FFT rounding and exploding
+// tails otherwise leave behind.
+void trim(Pmf &pmf) {
+  size_t first = 0;
+  size_t last = pmf.mass.size();
+  while (last - first > 1 && pmf.mass[first] < kNegligible) {
+    ++first;
+  }
+  while (last - first > 1 && pmf.mass[last - 1] < kNegligible) {
+    --last;
+  }
+  pmf.offset += static_cast<int>(first);
+  pmf.mass = std::vector<double>(pmf.mass.begin() + first,
+                                 pmf.mass.begin() + last);
+}
+
+// One die of `term` after rerolls, minimums and explosions, matching
+// rollDie().
+Pmf singleDie(const DiceTerm &term) {
+  const int sides = term.sides;
+  const double face = 1.0 / sides;
+  std::vector<double> faces(sides + 1, 0.0);
+  for (int f = 1; f <= sides; ++f) {
+    faces[f] = (f > term.rerollAtOrBelow ? face : 0.0) +
+               face * term.rerollAtOrBelow * face;
+  }
+
+  Pmf die;
+  die.offset = 1;
+  die.mass.assign(sides, 0.0);
+  for (int f = 1; f <= sides; ++f) {
+    if (term.explode && f == sides) {
+      continue;
+    }
+    die.mass[std::max<int>(f, term.minimum) - 1] += faces[f];
+  }
+  if (term.explode) {
+    // After a maximum face each further roll adds 1..sides-1 and stops, or
+    // shows the maximum again and continues.
+    double chain = faces[sides];
+    for (int extra = 0; extra <= DiceExpr::kMaxExplosions; ++extra) {
+      int base = sides * (extra + 1);
+      if (extra == DiceExpr::kMaxExplosions || chain * face < kNegligible) {
+        die.mass.resize(std::max<size_t>(die.mass.size(), base), 0.0);
+        die.mass[base - 1] += chain; // Cut off here
+        break;
+      }
+      die.mass.resize(base + sides - 1, 0.0);
+      for (int g = 1; g < sides; ++g) {
+        die.mass[base + g - 1] += chain * face;
+      }
+      chain *= face;
+    }
+  }
+  return die;
+}
+
+Pmf power(Pmf base, int count) {
+  Pmf result;
+  while (count > 0) {
+    if (count & 1) {
+      result = convolve(result, base);
+      trim(result);
+    }
+    count >>= 1;
+    if (count > 0) {
+      base = convolve(base, base);
+      trim(base);
+    }
+  }
+  return result;
+}
+
+// Sum of the `keep` highest (or lowest) of `count` dice. Faces are visited
+// from the kept end; at each face, `c` of the dice still unplaced show it,
+// chosen in C(unplaced, c) ways, and as many of those as still fit are kept.
+Pmf keptDice(const Pmf &die, int count, int keep, bool lowest) {
+  std::vector<std::vector<double>> binomial(count + 1);
+  for (int n = 0; n <= count; ++n) {
+    binomial[n].assign(n + 1, 1.0);
+    for (int k = 1; k < n; ++k) {
+      binomial[n][k] = binomial[n - 1][k - 1] + binomial[n - 1][k];
+    }
+  }
+
+  const int faces = static_cast<int>(die.mass.size());
+  const int maxKept = keep * (faces - 1); // In face indices
+  // dp[placed][keptSum], keptSum counted in face indices above die.offset.
+  std::vector<std::vector<double>> dp(
+      count + 1, std::vector<double>(maxKept + 1, 0.0));
+  auto next = dp;
+  dp[0][0] = 1.0;
+  std::vector<double> powers(count + 1);
+  for (int step = 0; step < faces; ++step) {
+    int index = lowest ? step : faces - 1 - step;
+    double p = die.mass[index];
+    if (p == 0.0) {
+      continue;
+    }
+    powers[0] = 1.0;
+    for (int c = 1; c <= count; ++c) {
+      powers[c] = powers[c - 1] * p;
+    }
+    for (auto &row : next) {
+      std::fill(row.begin(), row.end(), 0.0);
+    }
+    for (int placed = 0; placed <= count; ++placed) {
+      int room = std::max(0, keep - placed);
+      for (int sum = 0; sum <= maxKept; ++sum) {
+        double weight = dp[placed][sum];
+        if (weight == 0.0) {
+          continue;
+        }
+        for (int c = 0; c <= count - placed; ++c) {
+          int kept = std::min(c, room);
+          next[placed + c][sum + kept * index] +=
+              weight * binomial[count - placed][c] * powers[c];
+        }
+      }
+    }
+    std::swap(dp, next);
+  }
+  return {keep * die.offset, dp[count]};
+}
+
+Pmf termPmf(const DiceTerm &term) {
+  Pmf die = singleDie(term);
+  Pmf total = term.keep > 0 && term.keep < term.count
+                  ? keptDice(die, term.count, term.keep, term.keepLowest)
+                  : power(die, term.count);
+  if (term.negative) {
+    std::reverse(total.mass.begin(), total.mass.end());
+    total.offset = -(total.offset + static_cast<int>(total.mass.size()) - 1);
+  }
+  return total;
+}
+
+} // namespace
+
+DiceDistribution::DiceDistribution(const DiceExpr &dice) {
+  Pmf total;
+  total.offset = dice.modifier;
+  for (uint8_t i = 0; i < dice.termCount; ++i) {
+    total = convolve(total, termPmf(dice.terms[i]));
+    trim(total);
+  }
+
+  double mass = 0.0;
+  for (double p : total.mass) {
+    mass += p;
+  }
+  m_min = total.offset;
+  m_pmf = std::move(total.mass);
+  m_cdf.resize(m_pmf.size());
+  double running = 0.0;
+  m_mean = 0.0;
+  m_halvedMean = 0.0;
+  m_quarteredMean = 0.0;
+  for (size_t i = 0; i < m_pmf.size(); ++i) {
+    m_pmf[i] /= mass; // Undo the mass trimmed from the tails
+    running += m_pmf[i];
+    m_cdf[i] = running;
+    int value = m_min + static_cast<int>(i);
+    m_mean += m_pmf[i] * value;
+    m_halvedMean += m_pmf[i] * (value / 2);
+    m_quarteredMean += m_pmf[i] * (value / 2 / 2);
+  }
+}
+
+double DiceDistribution::probability(int value) const {
+  if (value < m_min || value > maxValue()) {
+    return 0.0;
+  }
+  return m_pmf[value - m_min];
+}
+
+int DiceDistribution::percentile(double p) const {
+  auto it = std::lower_bound(m_cdf.begin(), m_cdf.end(), p - kNegligible);
+  if (it == m_cdf.end()) {
+    return maxValue();
+  }
+  return m_min + static_cast<int>(it - m_cdf.begin());
+}
+
+double DiceDistribution::chanceAtLeast(int value) const {
+  if (value <= m_min) {
+    return 1.0;
+  }
+  if (value > maxValue()) {
+    return 0.0;
+  }
+  return std::max(0.0, 1.0 - m_cdf[value - m_min - 1]);
+}
+
+const DiceDistribution &DiceDistributionCache::get(const DiceExpr &dice) {
+  auto it = m_entries.find(dice);
+  if (it == m_entries.end()) {
+    it = m_entries.emplace(dice, DiceDistribution(dice)).first;
+  }
+  return it->second;
+}
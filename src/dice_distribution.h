@@ -0,0 +1,54 @@
+#pragma once
+
+#include "dice.h"
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// --- Exact Roll Distributions ---
+// The probability of every total a DiceExpr can roll, worked out by
+// convolving the per-die distributions rather than by sampling. Dice pools
+// are built by repeated squaring, and large convolutions switch from the
+// direct sum to an FFT. Keep-highest/lowest groups use an exact
+// order-statistics recurrence. Exploding dice have no upper bound, so their
+// chains are cut off once a further explosion is less likely than 1e-12.
+class DiceDistribution {
+public:
+  DiceDistribution() = default; // Always 0
+  explicit DiceDistribution(const DiceExpr &dice);
+
+  int minValue() const { return m_min; }
+  int maxValue() const { return m_min + static_cast<int>(m_pmf.size()) - 1; }
+  double mean() const { return m_mean; }
+  // Mean of total / 2 with integer division, as rolled on a successful save.
+  double halvedMean() const { return m_halvedMean; }
+  // Mean of total / 2 / 2, a successful save against a resisted type.
+  double quarteredMean() const { return m_quarteredMean; }
+
+  double probability(int value) const;
+  // Smallest total rolled with at least probability `p`; median is 0.5.
+  int percentile(double p) const;
+  // Chance of rolling `value` or more, e.g. enough damage to drop a target
+  // with that many hit points left.
+  double chanceAtLeast(int value) const;
+
+private:
+  int m_min = 0;
+  std::vector<double> m_pmf{1.0}; // m_pmf[i] is P(total == m_min + i)
+  std::vector<double> m_cdf{1.0};
+  double m_mean = 0.0;
+  double m_halvedMean = 0.0;
+  double m_quarteredMean = 0.0;
+};
+
+// Distributions keyed on the compiled expression, so each formula is worked
+// out once. Entries are never evicted; there is one per distinct formula and
+// modifier in play. References stay valid for the cache's lifetime.
+class DiceDistributionCache {
+public:
+  const DiceDistribution &get(const DiceExpr &dice);
+  size_t size() const { return m_entries.size(); }
+
+private:
+  std::unordered_map<DiceExpr, DiceDistribution, DiceExprHash> m_entries;
+};
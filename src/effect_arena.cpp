@@ -0,0 +1,50 @@
+#include "monster.h"
+#include "rules.h"
+#include <iostream>
+
+EffectRange EffectArena::append(const std::vector<Effect> &roots) {
+  // Siblings are reserved first so each node's children stay contiguous.
+  EffectRange range{static_cast<uint32_t>(m_nodes.size()),
+                    static_cast<uint32_t>(roots.size())};
+  m_nodes.resize(m_nodes.size() + roots.size());
+  for (uint32_t i = 0; i < range.count; ++i) {
+    fill(range.first + i, roots[i]);
+  }
+  return range;
+}
+
+EffectText EffectArena::store(const std::string &text) {
+  EffectText stored{static_cast<uint32_t>(m_text.size()),
+                    static_cast<uint32_t>(text.size())};
+  m_text += text;
+  return stored;
+}
+
+void EffectArena::fill(uint32_t index, const Effect &effect) {
+  EffectNode node;
+  node.trigger = effect.trigger;
+  node.attack = !effect.attackRollType.empty();
+  node.save = !effect.savingThrowType.empty();
+  node.damages = !effect.damageDice.empty();
+  node.damageKind = damageTypeFromName(effect.damageType);
+  node.condition = conditionFromName(effect.conditionToApply);
+  if (node.condition == Condition::NONE && !effect.conditionToApply.empty()) {
+    std::cerr << "Unknown condition: " << effect.conditionToApply << std::endl;
+  }
+  node.saveAbility = abilityScoreFromName(effect.savingThrowType);
+  node.modifierAbility = abilityScoreFromName(effect.damageModifierAbility);
+  node.savingThrowDC = effect.savingThrowDC;
+  if (node.damages) {
+    node.damage = compileDice(effect.damageDice);
+  }
+  node.description = store(effect.description);
+  node.attackRollType = store(effect.attackRollType);
+  node.savingThrowType = store(effect.savingThrowType);
+  node.damageDice = store(effect.damageDice);
+  node.damageType = store(effect.damageType);
+  node.damageModifierAbility = store(effect.damageModifierAbility);
+  node.conditionToApply = store(effect.conditionToApply);
+  // append() may grow m_nodes, so the node is written by index afterwards.
+  node.children = append(effect.childEffects);
+  m_nodes[index] = node;
+}
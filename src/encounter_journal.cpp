@@ -0,0 +1,160 @@
+#include "encounter_journal.h"
+
+namespace {
+
+// Appends LEB128 integers; signed ones are zigzagged first so that small
+// negative numbers stay short too.
+struct Writer {
+  std::vector<uint8_t> &out;
+
+  void number(uint64_t value) {
+    while (value >= 0x80) {
+      out.push_back(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+  }
+  void integer(const int &value) {
+    const int64_t wide = value;
+    number((static_cast<uint64_t>(wide) << 1) ^
+           static_cast<uint64_t>(wide >> 63));
+  }
+  void index(const uint32_t &value) { number(value); }
+  void handle(const CombatantHandle &handle) {
+    number(handle.slot);
+    number(handle.generation);
+  }
+  void action(const ActionHandle &action) {
+    handle(action.owner);
+    number(static_cast<uint64_t>(action.kind));
+    integer(action.index);
+  }
+  void text(const std::string &text) {
+    number(text.size());
+    out.insert(out.end(), text.begin(), text.end());
+  }
+  void handles(const std::vector<CombatantHandle> &handles) {
+    number(handles.size());
+    for (const auto &each : handles) {
+      handle(each);
+    }
+  }
+};
+
+// Reads back what Writer wrote.
+struct Reader {
+  const uint8_t *at;
+
+  uint64_t number() {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      const uint8_t byte = *at++;
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+  }
+  void integer(int &value) {
+    const uint64_t zigzag = number();
+    value = static_cast<int>(static_cast<int64_t>(zigzag >> 1) ^
+                             -static_cast<int64_t>(zigzag & 1));
+  }
+  void index(uint32_t &value) { value = static_cast<uint32_t>(number()); }
+  void handle(CombatantHandle &handle) {
+    handle.slot = static_cast<uint32_t>(number());
+    handle.generation = static_cast<uint32_t>(number());
+  }
+  void action(ActionHandle &action) {
+    handle(action.owner);
+    action.kind = static_cast<ActionKind>(number());
+    integer(action.index);
+  }
+  void text(std::string &text) {
+    const size_t size = number();
+    text.assign(reinterpret_cast<const char *>(at), size);
+    at += size;
+  }
+  void handles(std::vector<CombatantHandle> &handles) {
+    handles.resize(number());
+    for (auto &each : handles) {
+      handle(each);
+    }
+  }
+};
+
+// The fields each type keeps, in order, for both Writer and Reader.
+template <typename Io, typename Event> void transfer(Io &io, Event &event) {
+  switch (event.type) {
+  case EncounterEvent::ADD_MONSTER:
+    io.index(event.monster);
+    break;
+  case EncounterEvent::ADD_PLAYER:
+    io.text(event.name);
+    io.integer(event.value);
+    break;
+  case EncounterEvent::REMOVE:
+  case EncounterEvent::SET_CURRENT:
+    io.handle(event.combatant);
+    break;
+  case EncounterEvent::ADJUST_HIT_POINTS:
+  case EncounterEvent::SET_INITIATIVE:
+    io.handle(event.combatant);
+    io.integer(event.value);
+    break;
+  case EncounterEvent::SET_RESOURCE:
+    io.handle(event.combatant);
+    io.integer(event.index);
+    io.integer(event.value);
+    break;
+  case EncounterEvent::RESOLVE_ACTION:
+    io.action(event.action);
+    io.handles(event.targets);
+    break;
+  case EncounterEvent::PLAYER_SAVE:
+    io.action(event.action);
+    io.handle(event.combatant);
+    io.integer(event.value);
+    break;
+  case EncounterEvent::BEGIN_COMBAT:
+  case EncounterEvent::END_COMBAT:
+  case EncounterEvent::NEXT_TURN:
+  case EncounterEvent::PREVIOUS_TURN:
+  case EncounterEvent::LONG_REST:
+  case EncounterEvent::DISMISS_SAVES:
+    break;
+  }
+}
+
+} // namespace
+
+uint32_t
+EncounterJournal::internMonster(const std::shared_ptr<const Monster> &monster) {
+  auto found = m_monsterNumbers.find(monster.get());
+  if (found != m_monsterNumbers.end()) {
+    return found->second;
+  }
+  const uint32_t number = static_cast<uint32_t>(m_monsters.size());
+  m_monsters.push_back(monster);
+  m_monsterNumbers.emplace(monster.get(), number);
+  return number;
+}
+
+void EncounterJournal::append(const EncounterEvent &event) {
+  if (m_cursor < m_offsets.size()) {
+    m_bytes.resize(m_offsets[m_cursor]);
+    m_offsets.resize(m_cursor);
+  }
+  m_offsets.push_back(static_cast<uint32_t>(m_bytes.size()));
+  m_bytes.push_back(event.type);
+  Writer writer{m_bytes};
+  transfer(writer, event);
+  m_cursor = m_offsets.size();
+}
+
+void EncounterJournal::read(size_t index, EncounterEvent &event) const {
+  event = EncounterEvent(
+      static_cast<EncounterEvent::Type>(m_bytes[m_offsets[index]]));
+  Reader reader{m_bytes.data() + m_offsets[index] + 1};
+  transfer(reader, event);
+}
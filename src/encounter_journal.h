@@ -0,0 +1,113 @@
+#pragma once
+
+#include "handles.h"
+#include "monster.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Something done to the encounter. Each type uses only the fields named in
+// its comment.
+struct EncounterEvent {
+  enum Type : uint8_t {
+    ADD_MONSTER,       // `monster` joins, from EncounterJournal::monster()
+    ADD_PLAYER,        // The player `name` joins with initiative `value`
+    REMOVE,            // `combatant` leaves
+    ADJUST_HIT_POINTS, // `combatant` gains `value` hit points (or loses)
+    SET_INITIATIVE,    // `combatant`'s initiative becomes `value`
+    SET_RESOURCE,      // `combatant`'s Resources::values[`index`] = `value`
+    SET_CURRENT,       // The turn is handed to `combatant`
+    BEGIN_COMBAT,      // Initiative is rolled and the first turn starts
+    END_COMBAT,
+    NEXT_TURN,
+    PREVIOUS_TURN,
+    RESOLVE_ACTION, // `action` is taken against `targets`
+    PLAYER_SAVE,    // The player `combatant` saved (`value` 1) or failed
+                    // against `action`
+    LONG_REST,
+    DISMISS_SAVES // The saves still waiting on players go unanswered
+  };
+
+  EncounterEvent() = default;
+  explicit EncounterEvent(Type type, CombatantHandle combatant = {},
+                          int value = 0)
+      : type(type), combatant(combatant), value(value) {}
+
+  Type type = BEGIN_COMBAT;
+  CombatantHandle combatant;
+  int value = 0;
+  int index = 0;
+  uint32_t monster = 0;
+  std::string name;
+  ActionHandle action;
+  std::vector<CombatantHandle> targets;
+};
+
+// --- Encounter Journal ---
+// The encounter as the list of everything done to it, so that any point in
+// a session can be gone back to. Events are packed into one byte buffer as
+// variable-length integers, a few bytes each, and a Monster is stored once
+// and referred to by number. Events past the cursor are ones that were
+// undone; they stay for redo until something new is recorded over them.
+class EncounterJournal {
+public:
+  // The number that refers to `monster` in ADD_MONSTER events.
+  uint32_t internMonster(const std::shared_ptr<const Monster> &monster);
+  const std::shared_ptr<const Monster> &monster(uint32_t number) const {
+    return m_monsters[number];
+  }
+
+  // Records `event` at the cursor, dropping any undone events, and moves the
+  // cursor past it.
+  void append(const EncounterEvent &event);
+  // Event `index`, which must be below size().
+  void read(size_t index, EncounterEvent &event) const;
+
+  size_t size() const { return m_offsets.size(); }
+  size_t bytes() const { return m_bytes.size(); }
+  // Events applied to the encounter as it stands; the rest were undone.
+  size_t cursor() const { return m_cursor; }
+  void setCursor(size_t cursor) { m_cursor = std::min(cursor, size()); }
+
+private:
+  std::vector<uint8_t> m_bytes;
+  std::vector<uint32_t> m_offsets; // Where each event starts in m_bytes
+  size_t m_cursor = 0;
+  std::vector<std::shared_ptr<const Monster>> m_monsters;
+  std::unordered_map<const Monster *, uint32_t> m_monsterNumbers;
+};
+
+// --- Checkpoints ---
+// Copies of the encounter taken every kInterval events, so that going to
+// any event restores the nearest copy at or before it and replays fewer
+// than kInterval events, however long the session has run.
+template <typename State> class Checkpoints {
+public:
+  static constexpr size_t kInterval = 64;
+
+  // Whether a copy should be taken on reaching `event`; one is needed at 0.
+  bool due(size_t event) const {
+    return event % kInterval == 0 && event / kInterval == m_states.size();
+  }
+  void take(const State &state) { m_states.push_back(state); }
+
+  // The event of the latest copy at or before `event`.
+  size_t before(size_t event) const {
+    return std::min(event / kInterval, m_states.size() - 1) * kInterval;
+  }
+  // The copy taken at `event`, a value before() returned.
+  const State &at(size_t event) const { return m_states[event / kInterval]; }
+
+  // Forgets the copies after `event`, which something else now follows.
+  void dropAfter(size_t event) {
+    const size_t kept = std::min(m_states.size(), event / kInterval + 1);
+    m_states.erase(m_states.begin() + kept, m_states.end());
+  }
+
+private:
+  std::vector<State> m_states; // m_states[i] is at event i * kInterval
+};
@@ -0,0 +1,259 @@
+#include "encounter_odds.h"
+#include "rules.h"
+#include <algorithm>
+
+namespace {
+
+// Changes whenever a condition is gained, lost or re-applied.
+size_t conditionsKey(const Combatant &combatant) {
+  size_t key = combatant.conditions.mask();
+  combatant.conditions.forEach([&key](Condition, uint32_t expiresAt) {
+    key = key * 31 + expiresAt;
+  });
+  return key;
+}
+
+// Chance of a d20 landing on one of `faces` faces.
+float d20Chance(int faces) {
+  return static_cast<float>(std::min(20, std::max(0, faces))) / 20.f;
+}
+
+// How a target's defenses scale an action's damage: immunity ignores it,
+// resistance adds a halving and vulnerability doubles what is left.
+struct DamageScale {
+  bool immune = false;
+  int halvings = 0;
+  int multiplier = 1;
+};
+
+DamageScale damageScale(DamageType type, const DamageDefenses &defenses) {
+  const DamageTypeMask bit = damageTypeBit(type);
+  DamageScale scale;
+  scale.immune = (defenses.immune & bit) != 0;
+  scale.halvings = (defenses.resistant & bit) != 0;
+  scale.multiplier = (defenses.vulnerable & bit) != 0 ? 2 : 1;
+  return scale;
+}
+
+// Mean of the total after `halvings` halvings, each rounding toward zero.
+double halvedMean(const DiceDistribution &damage, int halvings) {
+  switch (halvings) {
+  case 0:
+    return damage.mean();
+  case 1:
+    return damage.halvedMean();
+  default:
+    return damage.quarteredMean();
+  }
+}
+
+// Smallest rolled total that reaches `hitPoints` once halved `halvings`
+// times and multiplied by `multiplier`.
+int totalNeeded(int hitPoints, int halvings, int multiplier) {
+  if (hitPoints <= 0) {
+    return halvings == 0 && multiplier == 1 ? hitPoints : 0;
+  }
+  return ((hitPoints + multiplier - 1) / multiplier) << halvings;
+}
+
+} // namespace
+
+template <typename Fn> void EncounterOdds::forEachRow(Fn fn) {
+  for (uint32_t slot : m_live) {
+    Actor &actor = m_actors[slot];
+    for (ActionRow &row : actor.abilities) {
+      fn(actor, row);
+    }
+    for (ActionRow &row : actor.spells) {
+      fn(actor, row);
+    }
+  }
+}
+
+void EncounterOdds::sync(const std::vector<Combatant> &combatants) {
+  const size_t epoch = ++m_stats.syncs;
+  m_live.clear();
+  m_newActors.clear();
+  m_changedColumns.clear();
+  m_changedHitPoints.clear();
+
+  for (const auto &combatant : combatants) {
+    const uint32_t slot = combatant.handle.slot;
+    if (slot >= m_targets.size()) {
+      m_targets.resize(slot + 1);
+      m_actors.resize(slot + 1);
+    }
+    Target &target = m_targets[slot];
+    const size_t key = conditionsKey(combatant);
+    // Undoing an add and adding again can hand out the same handle to
+    // someone else.
+    if (target.handle != combatant.handle ||
+        target.base != combatant.base.get()) {
+      target.handle = combatant.handle;
+      target.base = combatant.base.get();
+      target.isPlayer = combatant.isPlayer;
+      target.hitPoints = combatant.currentHitPoints;
+      target.conditionsKey = key;
+      target.defenses = combatant.damageDefenses;
+      addActor(combatant);
+      m_actors[slot].joined = epoch;
+      m_newActors.push_back(slot);
+      m_changedColumns.push_back(slot);
+    } else if (target.conditionsKey != key ||
+               target.defenses != combatant.damageDefenses) {
+      target.conditionsKey = key;
+      target.defenses = combatant.damageDefenses;
+      target.hitPoints = combatant.currentHitPoints;
+      m_changedColumns.push_back(slot);
+    } else if (target.hitPoints != combatant.currentHitPoints) {
+      target.hitPoints = combatant.currentHitPoints;
+      m_changedHitPoints.push_back(slot);
+    }
+    target.lastSeen = epoch;
+    m_live.push_back(slot);
+  }
+
+  // Anyone not seen this time has left; their stale cells in other rows are
+  // never read, since find() checks the target's handle.
+  for (uint32_t slot = 0; slot < m_targets.size(); ++slot) {
+    if (m_targets[slot].handle && m_targets[slot].lastSeen != epoch) {
+      m_targets[slot] = Target{};
+      m_actors[slot] = Actor{};
+    }
+  }
+
+  for (uint32_t actorSlot : m_newActors) {
+    Actor &actor = m_actors[actorSlot];
+    for (auto *rows : {&actor.abilities, &actor.spells}) {
+      for (ActionRow &row : *rows) {
+        for (uint32_t targetSlot : m_live) {
+          computeCell(row, m_targets[targetSlot]);
+        }
+      }
+    }
+  }
+  for (uint32_t targetSlot : m_changedColumns) {
+    const Target &target = m_targets[targetSlot];
+    forEachRow([&](const Actor &actor, ActionRow &row) {
+      if (actor.joined != epoch) { // New rows already cover every column
+        computeCell(row, target);
+      }
+    });
+  }
+  for (uint32_t targetSlot : m_changedHitPoints) {
+    const Target &target = m_targets[targetSlot];
+    forEachRow([&](const Actor &, ActionRow &row) {
+      refreshDrop(row, target);
+      ++m_stats.dropsRefreshed;
+    });
+  }
+}
+
+const ActionOdds *EncounterOdds::find(const ActionHandle &action,
+                                      CombatantHandle target) const {
+  if (action.owner.slot >= m_actors.size() ||
+      target.slot >= m_targets.size() ||
+      m_actors[action.owner.slot].handle != action.owner ||
+      m_targets[target.slot].handle != target) {
+    return nullptr;
+  }
+  const Actor &actor = m_actors[action.owner.slot];
+  const auto &rows =
+      action.kind == ActionKind::ABILITY ? actor.abilities : actor.spells;
+  if (action.index < 0 || static_cast<size_t>(action.index) >= rows.size()) {
+    return nullptr;
+  }
+  const ActionRow &row = rows[action.index];
+  if (target.slot >= row.cells.size()) {
+    return nullptr;
+  }
+  return &row.cells[target.slot];
+}
+
+void EncounterOdds::addActor(const Combatant &combatant) {
+  Actor &actor = m_actors[combatant.handle.slot];
+  actor.handle = combatant.handle;
+  actor.abilities.clear();
+  actor.spells.clear();
+  ActionDef action;
+  for (int i = 0; i < static_cast<int>(combatant.base->abilities.size());
+       ++i) {
+    makeActionDef(combatant, {combatant.handle, ActionKind::ABILITY, i},
+                  action);
+    actor.abilities.push_back(makeRow(action));
+  }
+  for (int i = 0; i < static_cast<int>(combatant.base->spells.size()); ++i) {
+    makeActionDef(combatant, {combatant.handle, ActionKind::SPELL, i}, action);
+    actor.spells.push_back(makeRow(action));
+  }
+}
+
+EncounterOdds::ActionRow EncounterOdds::makeRow(const ActionDef &action) {
+  ActionRow row;
+  if (action.attack) {
+    row.kind = ActionOdds::ATTACK;
+    row.attackBonus = action.attackBonus;
+  } else if (action.save) {
+    row.kind = ActionOdds::SAVE;
+    row.saveDC = action.saveDC;
+    row.saveAbility = action.saveAbility;
+  }
+  row.halfOnMiss = action.save && !action.attack;
+  row.damageKind = action.damageKind;
+  if (action.damages && action.damageKind != DamageType::HEALING) {
+    row.damage = &m_distributions.get(action.damage);
+  }
+  return row;
+}
+
+void EncounterOdds::computeCell(ActionRow &row, const Target &target) {
+  if (row.cells.size() < m_targets.size()) {
+    row.cells.resize(m_targets.size());
+  }
+  ActionOdds &cell = row.cells[target.handle.slot];
+  cell.kind = row.kind;
+  cell.known = !target.isPlayer;
+  cell.successChance = 1.f;
+  if (cell.known && row.kind == ActionOdds::ATTACK) {
+    // Hits when d20 + bonus >= AC.
+    cell.successChance = d20Chance(21 - (target.base->armorClass -
+                                         row.attackBonus));
+  } else if (cell.known && row.kind == ActionOdds::SAVE) {
+    // Fails when d20 + modifier < DC.
+    int saveModifier =
+        calculateModifier(getAbilityScore(*target.base, row.saveAbility));
+    cell.successChance = d20Chance(row.saveDC - saveModifier - 1);
+  }
+
+  cell.expectedDamage = 0.f;
+  const DamageScale scale = damageScale(row.damageKind, target.defenses);
+  if (row.damage && !scale.immune) {
+    double p = cell.successChance;
+    double expected = p * halvedMean(*row.damage, scale.halvings);
+    if (row.halfOnMiss) {
+      expected += (1.0 - p) * halvedMean(*row.damage, scale.halvings + 1);
+    }
+    cell.expectedDamage = static_cast<float>(expected * scale.multiplier);
+  }
+  ++m_stats.cellsComputed;
+  refreshDrop(row, target);
+}
+
+void EncounterOdds::refreshDrop(ActionRow &row, const Target &target) {
+  ActionOdds &cell = row.cells[target.handle.slot];
+  const DamageScale scale = damageScale(row.damageKind, target.defenses);
+  if (!row.damage || !cell.known || scale.immune) {
+    cell.dropChance = 0.f;
+    return;
+  }
+  const int hp = target.hitPoints;
+  double p = cell.successChance;
+  double drop = p * row.damage->chanceAtLeast(
+                        totalNeeded(hp, scale.halvings, scale.multiplier));
+  if (row.halfOnMiss) {
+    drop += (1.0 - p) *
+            row.damage->chanceAtLeast(
+                totalNeeded(hp, scale.halvings + 1, scale.multiplier));
+  }
+  cell.dropChance = static_cast<float>(std::min(1.0, drop));
+}
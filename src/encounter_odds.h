@@ -0,0 +1,100 @@
+#pragma once
+
+#include "action_pipeline.h"
+#include "dice_distribution.h"
+#include "handles.h"
+#include "monster.h"
+#include "rules.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The predicted outcome of one action against one target, worked out the way
+// resolveAction rolls it.
+struct ActionOdds {
+  enum Kind : uint8_t { AUTOMATIC, ATTACK, SAVE };
+
+  Kind kind = AUTOMATIC;
+  bool known = true;         // False for players, whose stats are not kept
+  float successChance = 1.f; // Attack hits, or the target fails its save
+  float expectedDamage = 0.f;
+  float dropChance = 0.f; // Damage reaches the target's current hit points
+};
+
+// How much work the matrix has done, for checking that it stays incremental.
+struct EncounterOddsStats {
+  size_t syncs = 0;
+  size_t cellsComputed = 0;  // Full recomputations of a cell
+  size_t dropsRefreshed = 0; // Cells whose target only changed hit points
+};
+
+// --- Encounter Odds Matrix ---
+// Every action of every combatant against every combatant. Rows and columns
+// are addressed by handle slot, so lookups are two array indexings. sync()
+// compares the encounter against what the matrix last saw and only computes
+// what changed:
+// - a newly joined combatant gets its rows and its column;
+// - a removed one has them cleared;
+// - a change of conditions or damage defenses recomputes that target's
+//   column;
+// - a change of hit points only refreshes the column's drop chances.
+// Damage comes from the shared DiceDistributionCache.
+class EncounterOdds {
+public:
+  explicit EncounterOdds(DiceDistributionCache &distributions)
+      : m_distributions(distributions) {}
+
+  void sync(const std::vector<Combatant> &combatants);
+
+  // Odds for `action` against `target` as of the last sync(), or nullptr if
+  // either has left the encounter since.
+  const ActionOdds *find(const ActionHandle &action,
+                         CombatantHandle target) const;
+
+  const EncounterOddsStats &stats() const { return m_stats; }
+
+private:
+  struct ActionRow {
+    ActionOdds::Kind kind = ActionOdds::AUTOMATIC;
+    int attackBonus = 0;
+    int saveDC = 0;
+    AbilityScore saveAbility = AbilityScore::NONE;
+    bool halfOnMiss = false; // Resolved by a save, which halves when made
+    DamageType damageKind = DamageType::NONE;
+    const DiceDistribution *damage = nullptr; // Harmful damage only
+    std::vector<ActionOdds> cells;            // By target slot
+  };
+
+  struct Actor {
+    CombatantHandle handle;
+    size_t joined = 0; // Sync that first saw it
+    std::vector<ActionRow> abilities;
+    std::vector<ActionRow> spells;
+  };
+
+  struct Target {
+    CombatantHandle handle;
+    const Monster *base = nullptr;
+    bool isPlayer = false;
+    int hitPoints = 0;
+    size_t conditionsKey = 0;
+    DamageDefenses defenses;
+    size_t lastSeen = 0; // Sync that last found it in the encounter
+  };
+
+  void addActor(const Combatant &combatant);
+  ActionRow makeRow(const ActionDef &action);
+  void computeCell(ActionRow &row, const Target &target);
+  void refreshDrop(ActionRow &row, const Target &target);
+  template <typename Fn> void forEachRow(Fn fn);
+
+  DiceDistributionCache &m_distributions;
+  std::vector<Actor> m_actors;   // By handle slot
+  std::vector<Target> m_targets; // By handle slot
+  std::vector<uint32_t> m_live;  // Slots present at the last sync
+  std::vector<uint32_t> m_newActors;
+  std::vector<uint32_t> m_changedColumns;
+  std::vector<uint32_t> m_changedHitPoints;
+  EncounterOddsStats m_stats;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// --- Stable Handles ---
+// Value types that name a combatant, or one of its actions, without pointing
+// into the encounter list. They stay valid while the list reallocates, is
+// sorted or is compacted, and resolve to nothing once the combatant they name
+// has been removed (see CombatantRegistry).
+
+struct CombatantHandle {
+  uint32_t slot = 0;
+  uint32_t generation = 0; // Never 0 for an issued handle
+
+  explicit operator bool() const { return generation != 0; }
+  bool operator==(const CombatantHandle &other) const {
+    return slot == other.slot && generation == other.generation;
+  }
+  bool operator!=(const CombatantHandle &other) const {
+    return !(*this == other);
+  }
+};
+
+enum class ActionKind { ABILITY, SPELL };
+
+// An entry of the owner's base->abilities or base->spells. The Monster behind
+// a combatant never changes, so the owner's generation also guards the index.
+struct ActionHandle {
+  CombatantHandle owner;
+  ActionKind kind = ActionKind::ABILITY;
+  int index = -1;
+};
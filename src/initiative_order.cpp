@@ -0,0 +1,120 @@
+#include "initiative_order.h"
+#include <algorithm>
+
+bool InitiativeOrder::Entry::operator<(const Entry &other) const {
+  if (initiative != other.initiative) {
+    return initiative > other.initiative;
+  }
+  if (dexterity != other.dexterity) {
+    return dexterity > other.dexterity;
+  }
+  return joined < other.joined;
+}
+
+InitiativeOrder::Entry
+InitiativeOrder::keyFor(const Combatant &combatant) const {
+  Entry entry;
+  entry.initiative = combatant.initiative;
+  entry.dexterity = combatant.base->dexterity;
+  entry.joined = m_keys[combatant.handle.slot].joined;
+  entry.handle = combatant.handle;
+  return entry;
+}
+
+size_t InitiativeOrder::find(const Entry &entry) const {
+  return std::lower_bound(m_entries.begin(), m_entries.end(), entry) -
+         m_entries.begin();
+}
+
+void InitiativeOrder::insert(const Combatant &combatant) {
+  const uint32_t slot = combatant.handle.slot;
+  if (slot >= m_keys.size()) {
+    m_keys.resize(slot + 1);
+  }
+  Entry entry;
+  entry.initiative = combatant.initiative;
+  entry.dexterity = combatant.base->dexterity;
+  entry.joined = m_joined++;
+  entry.handle = combatant.handle;
+  m_keys[slot] = entry;
+  m_entries.insert(m_entries.begin() + find(entry), entry);
+}
+
+void InitiativeOrder::remove(CombatantHandle handle) {
+  const int position = positionOf(handle);
+  if (position < 0) {
+    return;
+  }
+  m_entries.erase(m_entries.begin() + position);
+  m_keys[handle.slot] = Entry{};
+  if (handle == m_current) {
+    m_current = m_entries.empty()
+                    ? CombatantHandle{}
+                    : m_entries[position % m_entries.size()].handle;
+  }
+}
+
+void InitiativeOrder::update(const Combatant &combatant) {
+  const int position = positionOf(combatant.handle);
+  if (position < 0) {
+    return;
+  }
+  Entry entry = keyFor(combatant);
+  m_keys[combatant.handle.slot] = entry;
+  // Slide it into place, shifting only the keys it passes.
+  auto from = m_entries.begin() + position;
+  auto to = m_entries.begin() + find(entry);
+  if (to > from) {
+    std::rotate(from, from + 1, to);
+    *(to - 1) = entry;
+  } else {
+    std::rotate(to, from, from + 1);
+    *to = entry;
+  }
+}
+
+void InitiativeOrder::updateAll(const std::vector<Combatant> &combatants) {
+  for (const auto &combatant : combatants) {
+    if (positionOf(combatant.handle) >= 0) {
+      m_keys[combatant.handle.slot] = keyFor(combatant);
+    }
+  }
+  for (Entry &entry : m_entries) {
+    entry = m_keys[entry.handle.slot];
+  }
+  std::sort(m_entries.begin(), m_entries.end());
+}
+
+void InitiativeOrder::clear() {
+  m_entries.clear();
+  m_keys.clear();
+  m_current = CombatantHandle{};
+}
+
+int InitiativeOrder::positionOf(CombatantHandle handle) const {
+  if (handle.slot >= m_keys.size() || m_keys[handle.slot].handle != handle) {
+    return -1;
+  }
+  return static_cast<int>(find(m_keys[handle.slot]));
+}
+
+InitiativeOrder::Entry
+InitiativeOrder::entryOf(CombatantHandle handle) const {
+  if (handle.slot >= m_keys.size() || m_keys[handle.slot].handle != handle) {
+    return Entry{};
+  }
+  return m_keys[handle.slot];
+}
+
+CombatantHandle InitiativeOrder::advance(int steps) {
+  if (m_entries.empty()) {
+    return m_current = CombatantHandle{};
+  }
+  const int count = static_cast<int>(m_entries.size());
+  const int position = positionOf(m_current);
+  if (position < 0) {
+    return m_current = m_entries.front().handle;
+  }
+  const int next = ((position + steps) % count + count) % count;
+  return m_current = m_entries[next].handle;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "handles.h"
+#include "monster.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --- Initiative Order ---
+// Who acts when, kept apart from the encounter list so that ordering never
+// moves a Combatant. Entries are small keys sorted highest initiative first,
+// ties going to the higher Dexterity and then to whoever joined first.
+// Joining, leaving and changing initiative find their place by binary search
+// and shift only keys. The creature whose turn it is is held by handle, so
+// it keeps the turn through every change around it.
+class InitiativeOrder {
+public:
+  struct Entry {
+    int initiative = 0;
+    int dexterity = 0;
+    uint64_t joined = 0;
+    CombatantHandle handle;
+
+    bool operator<(const Entry &other) const; // Acts earlier
+  };
+
+  void insert(const Combatant &combatant);
+  // The creature after `handle` takes the turn if it was `handle`'s.
+  void remove(CombatantHandle handle);
+  // Moves `combatant` to where its initiative now puts it.
+  void update(const Combatant &combatant);
+  // update() for everyone at once, e.g. after rolling initiative for all.
+  void updateAll(const std::vector<Combatant> &combatants);
+  void clear();
+
+  size_t size() const { return m_entries.size(); }
+  bool empty() const { return m_entries.empty(); }
+  CombatantHandle operator[](size_t position) const {
+    return m_entries[position].handle;
+  }
+  int positionOf(CombatantHandle handle) const; // -1 if not in the order
+  // `handle`'s place in the order, or an Entry with a null handle.
+  Entry entryOf(CombatantHandle handle) const;
+
+  // The creature whose turn it is; a null handle outside combat.
+  CombatantHandle current() const { return m_current; }
+  void setCurrent(CombatantHandle handle) { m_current = handle; }
+  // Passes the turn `steps` places on (back if negative), wrapping around.
+  // Starts at the top of the order if there is no current creature.
+  CombatantHandle advance(int steps);
+
+private:
+  Entry keyFor(const Combatant &combatant) const;
+  size_t find(const Entry &entry) const;
+
+  std::vector<Entry> m_entries; // In turn order
+  std::vector<Entry> m_keys;    // By handle slot, for finding an entry
+  uint64_t m_joined = 0;
+  CombatantHandle m_current;
+};
@@ -1,10 +1,30 @@
+#include "action_pipeline.h"
+#include "benchmark.h"
+#include "bestiary_snapshot.h"
+#include "combatant_registry.h"
+#include "condition_wheel.h"
+#include "dice_distribution.h"
+#include "encounter_journal.h"
+#include "encounter_odds.h"
+#include "initiative_order.h"
 #include "monster.h" // Include our new monster definition
+#include "monster_db.h"
+#include "monster_filter.h"
+#include "monster_loader.h"
+#include "rules.h"
+#include "schema_migrations.h"
+#include "turn_scheduler.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h> // We will use this with ImGui
 #include <SQLiteCpp/SQLiteCpp.h>
 #include <algorithm> // For std::transform
 #include <algorithm> // For std::sort
 #include <cctype>    // For ::tolower
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <future>
 #include <iostream>
 #include <random> // For the casting of lots
 #include <sstream>
@@ -15,52 +35,81 @@
 #include "imgui.h"
 #include "imgui_impl_opengl3.h"
 #include "imgui_impl_sdl2.h"
-#include <regex> // For regular expressions
 
 // --- Global Variables ---
 std::vector<std::string> g_monsterNames;
 static int g_selectedMonsterIndex = 0;
-static Monster g_currentMonster;
-static SQLite::Database *g_db = nullptr;
-static char g_searchBuffer[256] = ""; // Buffer for the search input
-static std::vector<std::string>
-    g_filteredMonsterNames; // To hold the filtered names
+static std::shared_ptr<const Monster> g_currentMonster;
+static MonsterLoader *g_loader = nullptr; // Owns SQLite and the snapshot
+static std::future<std::vector<std::string>> g_pendingBestiary;
+static std::unique_ptr<MonsterSearchIndex> g_searchIndex;
+static std::future<std::unique_ptr<MonsterSearchIndex>> g_pendingSearchIndex;
+// Newest selection in flight
+static std::future<std::shared_ptr<const Monster>> g_pendingMonster;
+static std::string g_pendingMonsterName;
+static char g_searchBuffer[MonsterFilter::kMaxQuery] = ""; // Search input
+static MonsterFilter g_monsterFilter; // Indices into g_monsterNames
 static std::vector<Combatant>
     g_encounterList; // Our assembled forces are now Combatants
+static CombatantRegistry g_combatants; // Handles into g_encounterList
+static DiceDistributionCache g_damageOdds; // Exact odds per damage formula
+static EncounterOdds g_encounterOdds(g_damageOdds); // Per action and target
+static ConditionWheel g_conditionWheel; // When each condition runs out
 static char g_newPlayerNameBuffer[256] = ""; // Buffer for the new player's name
 static int g_newPlayerInitiative = 0; // Buffer for the new player's initiative
-static int g_currentTurnIndex = -1;   // -1 indicates combat has not begun
+static InitiativeOrder g_initiative; // Turn order and whose turn it is
 static bool g_combatHasBegun = false; // Is the battle joined?
-static std::mt19937 g_rng(std::random_device{}()); // Random number generator
+// Recharges, legendary actions and lair actions as the turns pass
+static TurnScheduler g_turnScheduler(g_encounterList, g_combatants,
+                                     g_initiative);
+// Every roll comes from a stream derived from this seed, which the combat log
+// records; `--seed N` replays an encounter.
+static uint64_t g_encounterSeed = 0;
+static RngStream g_encounterRng;
+static uint64_t g_combatantsJoined = 0; // Labels each combatant's stream
 
 // --- Targeting State ---
 struct TargetingState {
   bool isTargeting = false;
-  const Ability *ability = nullptr;
-  const Spell *spell = nullptr;
-  std::vector<int> selectedTargets;
+  ActionHandle action;
+  std::vector<CombatantHandle> selectedTargets;
 };
 static TargetingState g_targetingState;
 
 // --- Player Save Prompt State ---
 struct PlayerSaveState {
   bool isActive = false;
-  int targetIndex = -1;
-  std::string saveType;
-  int saveDC = 0;
-  const Ability *ability = nullptr;
-  const Spell *spell = nullptr;
+  ActionHandle action;
+  std::vector<CombatantHandle> targets; // Players still to roll, in order
 };
 static PlayerSaveState g_playerSaveState;
 
+// --- Action Resolution ---
+static ActionResolver g_actionResolver(g_encounterList, g_combatants,
+                                       g_conditionWheel);
+static std::vector<ActionEvent> g_actionEvents; // Of the latest resolution
+
 // --- Combat Log ---
-struct LogEntry {
-  enum LogEntryType { DAMAGE, HEALING, EVENT, INFO };
-  std::string message;
-  LogEntryType type;
-};
 std::vector<LogEntry> g_combatLog;
 
+// --- Encounter History ---
+// Every change to the state above goes through record() as an event, so the
+// session can be undone, redone or wound to any point. The combat log is
+// only ever appended to by events, so a checkpoint keeps just its length.
+struct EncounterSnapshot {
+  std::vector<Combatant> encounterList;
+  CombatantRegistry combatants;
+  InitiativeOrder initiative;
+  ConditionWheel conditionWheel;
+  TurnScheduler turnScheduler;
+  bool combatHasBegun;
+  uint64_t combatantsJoined;
+  PlayerSaveState playerSave;
+  size_t combatLogSize;
+};
+static EncounterJournal g_journal; // Everything done to the encounter
+static Checkpoints<EncounterSnapshot> g_checkpoints;
+
 // --- Function Declarations ---
 void renderBestiaryUI();
 void renderCombatUI();
@@ -69,10 +118,12 @@ void renderCombatLogUI();
 void renderStatBlock(const Monster &monster);
 void initImGui(SDL_Window *window, SDL_GLContext gl_context);
 void shutdownImGui();
-ActionType stringToActionType(const std::string &str);
 void renderTargetingUI();
-void resolveAction(TargetingState &targetingState);
+void record(const EncounterEvent &event);
+EncounterSnapshot captureEncounter();
 void renderPlayerSaveUI();
+void addCombatant(Combatant combatant);
+void removeCombatant(CombatantHandle handle);
 
 // --- Combat Log UI ---
 void renderCombatLogUI() {
@@ -102,318 +153,121 @@ void renderCombatLogUI() {
   }
   ImGui::End();
 }
-std::vector<std::string> getMonsterNames(SQLite::Database &db);
-Monster getMonsterByName(SQLite::Database &db, const std::string &monsterName);
-
-std::vector<std::string> getMonsterSkills(int monsterId, SQLite::Database &db);
-std::vector<std::string> getMonsterSavingThrows(int monsterId,
-                                                SQLite::Database &db);
-std::vector<std::string> getMonsterSenses(int monsterId, SQLite::Database &db);
-std::vector<std::string> getMonsterConditionImmunities(int monsterId,
-                                                       SQLite::Database &db);
-std::vector<std::string> getMonsterDamageImmunities(int monsterId,
-                                                    SQLite::Database &db);
-std::vector<std::string> getMonsterDamageResistances(int monsterId,
-                                                     SQLite::Database &db);
-std::vector<std::string> getMonsterDamageVulnerabilities(int monsterId,
-                                                         SQLite::Database &db);
-std::vector<Ability> getMonsterAbilities(int monsterId, SQLite::Database &db);
-std::vector<std::string> getMonsterSpeeds(int monsterId, SQLite::Database &db);
-std::vector<int> getMonsterSpellSlots(int monsterId, SQLite::Database &db);
-std::vector<Spell> getMonsterSpells(int monsterId, SQLite::Database &db);
-
-std::vector<std::string> getMonsterNames(SQLite::Database &db) {
-  std::vector<std::string> monsterNames;
-  try {
-    SQLite::Statement query(db, "SELECT Name FROM Monsters ORDER BY Name ASC");
-    while (query.executeStep()) {
-      monsterNames.push_back(query.getColumn(0).getString());
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterNames: " << e.what() << std::endl;
-  }
-  return monsterNames;
-}
 
-std::vector<int> getMonsterSpellSlots(int monsterId, SQLite::Database &db) {
-  std::vector<int> spellSlots(9, 0);
-  try {
-    SQLite::Statement query(
-        db,
-        "SELECT SpellLevel, Slots FROM Monster_SpellSlots WHERE MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      int level = query.getColumn(0).getInt();
-      int slots = query.getColumn(1).getInt();
-      if (level >= 1 && level <= 9) {
-        spellSlots[level - 1] = slots;
-      }
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterSpellSlots: " << e.what()
-              << std::endl;
-  }
-  return spellSlots;
+// --- Frame Timing ---
+struct FrameStats {
+  double lastMs = 0.0;    // CPU time of the previous frame, excluding vsync
+  double longestMs = 0.0; // Worst frame since the last reset
+};
+static FrameStats g_frameStats;
+
+// --- Asynchronous Monster Loading ---
+// Asks the loader for `name`; the stat block shows a placeholder until the
+// monster arrives.
+void selectMonster(const std::string &name) {
+  g_pendingMonsterName = name;
+  g_pendingMonster = g_loader->requestMonster(name);
 }
 
-std::vector<Spell> getMonsterSpells(int monsterId, SQLite::Database &db) {
-  std::vector<Spell> spells;
-  try {
-    SQLite::Statement query(
-        db, "SELECT S.Name, S.Level, S.CastingTime, S.Description, "
-            "S.SavingThrowType, S.SavingThrowDC, S.DamageDice, S.DamageType, "
-            "S.DamageModifierAbility FROM Spells AS S INNER JOIN "
-            "Monster_Spells AS MS ON S.SpellID = MS.SpellID WHERE MS.MonsterID "
-            "= ? ORDER BY S.Level, S.Name");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      Spell spell;
-      spell.name = query.getColumn(0).getString();
-      spell.level = query.getColumn(1).getInt();
-      spell.actionType = stringToActionType(query.getColumn(2).getString());
-      spell.description = query.getColumn(3).getString();
-      spell.savingThrowType = query.getColumn(4).getString();
-      spell.savingThrowDC = query.getColumn(5).getInt();
-      spell.damageDice = query.getColumn(6).getString();
-      spell.damageType = query.getColumn(7).getString();
-      spell.damageModifierAbility = query.getColumn(8).getString();
-      spells.push_back(spell);
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterSpells: " << e.what() << std::endl;
-  }
-  return spells;
+template <typename T> bool isReady(const std::future<T> &future) {
+  return future.valid() && future.wait_for(std::chrono::seconds(0)) ==
+                               std::future_status::ready;
 }
 
-Monster getMonsterByName(SQLite::Database &db, const std::string &monsterName) {
-  Monster monster;
-  try {
-    SQLite::Statement idQuery(db,
-                              "SELECT MonsterID FROM Monsters WHERE Name = ?");
-    idQuery.bind(1, monsterName);
-    int monsterId = -1;
-    if (idQuery.executeStep()) {
-      monsterId = idQuery.getColumn(0).getInt();
-    } else {
-      std::cerr << "Monster not found: " << monsterName << std::endl;
-      return monster;
+// Collects whatever the loader has finished without ever blocking the frame.
+void pollMonsterLoader() {
+  if (isReady(g_pendingBestiary)) {
+    try {
+      g_monsterNames = g_pendingBestiary.get();
+    } catch (const std::exception &e) {
+      std::cerr << "Failed to load the bestiary: " << e.what() << std::endl;
     }
-
-    SQLite::Statement coreQuery(
-        db, "SELECT Name, Size, Type, Alignment, ArmorClass, HitPoints_Avg, "
-            "HitPoints_Formula, Strength, Dexterity, Constitution, "
-            "Intelligence, Wisdom, Charisma, ChallengeRating, Languages, "
-            "SpellSaveDC, SpellAttackBonus FROM Monsters WHERE MonsterID = ?");
-    coreQuery.bind(1, monsterId);
-
-    if (coreQuery.executeStep()) {
-      monster.name = coreQuery.getColumn(0).getString();
-      monster.size = coreQuery.getColumn(1).getString();
-      monster.type = coreQuery.getColumn(2).getString();
-      monster.alignment = coreQuery.getColumn(3).getString();
-      monster.armorClass = coreQuery.getColumn(4).getInt();
-      monster.hitPoints = coreQuery.getColumn(5).getInt();
-      monster.hitDice = coreQuery.getColumn(6).getString();
-      monster.strength = coreQuery.getColumn(7).getInt();
-      monster.dexterity = coreQuery.getColumn(8).getInt();
-      monster.constitution = coreQuery.getColumn(9).getInt();
-      monster.intelligence = coreQuery.getColumn(10).getInt();
-      monster.wisdom = coreQuery.getColumn(11).getInt();
-      monster.charisma = coreQuery.getColumn(12).getInt();
-      monster.challengeRating = coreQuery.getColumn(13).getString();
-      monster.languages = coreQuery.getColumn(14).getString();
-      monster.spellSaveDC = coreQuery.getColumn(15).getInt();
-      monster.spellAttackBonus = coreQuery.getColumn(16).getInt();
+    g_monsterFilter.setNames(g_monsterNames);
+    if (!g_monsterNames.empty()) {
+      selectMonster(g_monsterNames[0]);
     }
-
-    monster.speeds = getMonsterSpeeds(monsterId, db);
-    monster.skills = getMonsterSkills(monsterId, db);
-    monster.savingThrows = getMonsterSavingThrows(monsterId, db);
-    monster.senses = getMonsterSenses(monsterId, db);
-    monster.conditionImmunities = getMonsterConditionImmunities(monsterId, db);
-    monster.damageImmunities = getMonsterDamageImmunities(monsterId, db);
-    monster.damageResistances = getMonsterDamageResistances(monsterId, db);
-    monster.damageVulnerabilities =
-        getMonsterDamageVulnerabilities(monsterId, db);
-    monster.abilities = getMonsterAbilities(monsterId, db);
-    monster.spells = getMonsterSpells(monsterId, db);
-
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterByName: " << e.what() << std::endl;
-  }
-  return monster;
-}
-
-std::vector<std::string> getMonsterSpeeds(int monsterId, SQLite::Database &db) {
-  std::vector<std::string> speeds;
-  try {
-    SQLite::Statement query(
-        db, "SELECT SpeedType, Value FROM Monster_Speeds WHERE MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      std::stringstream ss;
-      ss << query.getColumn(0).getString() << " "
-         << query.getColumn(1).getString();
-      speeds.push_back(ss.str());
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterSpeeds: " << e.what() << std::endl;
   }
-  return speeds;
-}
-
-std::vector<std::string> getMonsterSkills(int monsterId, SQLite::Database &db) {
-  std::vector<std::string> skills;
-  try {
-    SQLite::Statement query(
-        db, "SELECT Name, Value FROM Skills INNER JOIN Monster_Skills ON "
-            "Skills.SkillID = Monster_Skills.SkillID WHERE "
-            "Monster_Skills.MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      std::stringstream ss;
-      ss << query.getColumn(0).getString() << " +"
-         << query.getColumn(1).getInt();
-      skills.push_back(ss.str());
+  if (isReady(g_pendingSearchIndex)) {
+    try {
+      g_searchIndex = g_pendingSearchIndex.get();
+      g_monsterFilter.setSearchIndex(g_searchIndex.get());
+    } catch (const std::exception &e) {
+      std::cerr << "Failed to index the bestiary: " << e.what() << std::endl;
     }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterSkills: " << e.what() << std::endl;
   }
-  return skills;
-}
-
-std::vector<std::string> getMonsterSavingThrows(int monsterId,
-                                                SQLite::Database &db) {
-  std::vector<std::string> savingThrows;
-  try {
-    SQLite::Statement query(
-        db,
-        "SELECT Name, Value FROM SavingThrows INNER JOIN Monster_SavingThrows "
-        "ON SavingThrows.SavingThrowID = Monster_SavingThrows.SavingThrowID "
-        "WHERE Monster_SavingThrows.MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      std::stringstream ss;
-      ss << query.getColumn(0).getString() << " +"
-         << query.getColumn(1).getInt();
-      savingThrows.push_back(ss.str());
+  if (isReady(g_pendingMonster)) {
+    try {
+      g_currentMonster = g_pendingMonster.get();
+    } catch (const std::exception &e) {
+      std::cerr << "Monster request dropped: " << e.what() << std::endl;
     }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterSavingThrows: " << e.what()
-              << std::endl;
   }
-  return savingThrows;
 }
 
-std::vector<std::string> getMonsterSenses(int monsterId, SQLite::Database &db) {
-  std::vector<std::string> senses;
-  try {
-    SQLite::Statement query(
-        db, "SELECT Name, Value FROM Senses INNER JOIN Monster_Senses ON "
-            "Senses.SenseID = Monster_Senses.SenseID WHERE "
-            "Monster_Senses.MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      std::stringstream ss;
-      ss << query.getColumn(0).getString() << " "
-         << query.getColumn(1).getString();
-      senses.push_back(ss.str());
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterSenses: " << e.what() << std::endl;
-  }
-  return senses;
+void renderStatBlockPlaceholder(const std::string &monsterName) {
+  ImGui::SetNextWindowSize(ImVec2(500, 700), ImGuiCond_FirstUseEver);
+  ImGui::Begin("Monster Statblock", nullptr, ImGuiWindowFlags_MenuBar);
+  ImGui::TextDisabled("Loading %s...", monsterName.c_str());
+  ImGui::End();
 }
 
-std::vector<std::string> getMonsterConditionImmunities(int monsterId,
-                                                       SQLite::Database &db) {
-  std::vector<std::string> immunities;
-  try {
-    SQLite::Statement query(
-        db,
-        "SELECT Name FROM Conditions INNER JOIN Monster_ConditionImmunities ON "
-        "Conditions.ConditionID = Monster_ConditionImmunities.ConditionID "
-        "WHERE Monster_ConditionImmunities.MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      immunities.push_back(query.getColumn(0).getString());
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterConditionImmunities: " << e.what()
-              << std::endl;
-  }
-  return immunities;
-}
+int main(int argc, char *argv[]) {
+  auto launchTime = std::chrono::steady_clock::now();
 
-std::vector<std::string> getMonsterDamageImmunities(int monsterId,
-                                                    SQLite::Database &db) {
-  std::vector<std::string> immunities;
-  try {
-    SQLite::Statement query(
-        db,
-        "SELECT Name FROM DamageTypes INNER JOIN Monster_DamageImmunities ON "
-        "DamageTypes.DamageTypeID = Monster_DamageImmunities.DamageTypeID "
-        "WHERE Monster_DamageImmunities.MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      immunities.push_back(query.getColumn(0).getString());
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterDamageImmunities: " << e.what()
-              << std::endl;
+  if (argc > 2 && std::string(argv[1]) == "--benchmark") {
+    return runBenchmark(argv[2]);
   }
-  return immunities;
-}
-
-std::vector<std::string> getMonsterDamageResistances(int monsterId,
-                                                     SQLite::Database &db) {
-  std::vector<std::string> resistances;
-  try {
-    SQLite::Statement query(
-        db,
-        "SELECT Name FROM DamageTypes INNER JOIN Monster_DamageResistances ON "
-        "DamageTypes.DamageTypeID = Monster_DamageResistances.DamageTypeID "
-        "WHERE Monster_DamageResistances.MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      resistances.push_back(query.getColumn(0).getString());
+  if (argc > 1 && std::string(argv[1]) == "--migrate") {
+    return migrateDatabase(kDatabasePath) ? 0 : 1;
+  }
+  if (argc > 1 && std::string(argv[1]) == "--check-query-plans") {
+    SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+    if (schemaVersion(db) < latestSchemaVersion()) {
+      std::cerr << "Database is at schema version " << schemaVersion(db)
+                << " of " << latestSchemaVersion() << "; run --migrate first."
+                << std::endl;
+      return 1;
     }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterDamageResistances: " << e.what()
-              << std::endl;
+    return checkLoaderQueryPlans(db) == 0 ? 0 : 1;
+  }
+  if (argc > 1 && std::string(argv[1]) == "--compile-snapshot") {
+    migrateDatabase(kDatabasePath);
+    SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+    MonsterCatalog catalog = loadMonsterCatalog(db);
+    return compileBestiarySnapshot(catalog, checksumFile(kDatabasePath),
+                                   kSnapshotPath)
+               ? 0
+               : 1;
   }
-  return resistances;
-}
 
-std::vector<std::string> getMonsterDamageVulnerabilities(int monsterId,
-                                                         SQLite::Database &db) {
-  std::vector<std::string> vulnerabilities;
-  try {
-    SQLite::Statement query(
-        db, "SELECT Name FROM DamageTypes INNER JOIN "
-            "Monster_DamageVulnerabilities ON DamageTypes.DamageTypeID = "
-            "Monster_DamageVulnerabilities.DamageTypeID WHERE "
-            "Monster_DamageVulnerabilities.MonsterID = ?");
-    query.bind(1, monsterId);
-    while (query.executeStep()) {
-      vulnerabilities.push_back(query.getColumn(0).getString());
+  g_encounterSeed = (static_cast<uint64_t>(std::random_device{}()) << 32) |
+                    std::random_device{}();
+  if (argc > 1 && std::string(argv[1]) == "--seed") {
+    const char *seed = argc > 2 ? argv[2] : "";
+    const char *end = seed + std::strlen(seed);
+    auto parsed = std::from_chars(seed, end, g_encounterSeed);
+    if (parsed.ec != std::errc() || parsed.ptr != end) {
+      std::cerr << "Usage: " << argv[0]
+                << " --seed <number from 0 to 18446744073709551615>"
+                << std::endl;
+      return 1;
     }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterDamageVulnerabilities: " << e.what()
-              << std::endl;
   }
-  return vulnerabilities;
-}
+  g_encounterRng = RngStream(g_encounterSeed);
+  g_checkpoints.take(captureEncounter()); // The empty encounter
+
+  // Start loading before the window exists so the two overlap.
+  MonsterLoader loader;
+  g_loader = &loader;
+  g_pendingBestiary = loader.loadBestiary();
+  g_pendingSearchIndex = loader.loadSearchIndex();
 
-int main(int argc, char *argv[]) {
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) !=
       0) {
     std::cerr << "Error: " << SDL_GetError() << std::endl;
     return -1;
   }
 
-  srand(time(nullptr));
-
   const char *glsl_version = "#version 130";
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
@@ -435,20 +289,10 @@ int main(int argc, char *argv[]) {
 
   initImGui(window, gl_context);
 
-  static SQLite::Database db("../data/initiativ.sqlite", SQLite::OPEN_READONLY);
-  g_db = &db;
-  std::cout << "Successfully opened database." << std::endl;
-  g_monsterNames = getMonsterNames(db);
-  std::cout << "Successfully fetched " << g_monsterNames.size()
-            << " monster names." << std::endl;
-
-  g_filteredMonsterNames = g_monsterNames;
-  if (!g_filteredMonsterNames.empty()) {
-    g_currentMonster = getMonsterByName(db, g_filteredMonsterNames[0]);
-  }
-
   bool done = false;
+  bool firstFrame = true;
   while (!done) {
+    auto frameStart = std::chrono::steady_clock::now();
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
       ImGui_ImplSDL2_ProcessEvent(&event);
@@ -460,6 +304,8 @@ int main(int argc, char *argv[]) {
         done = true;
     }
 
+    pollMonsterLoader();
+
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame();
     ImGui::NewFrame();
@@ -477,8 +323,10 @@ int main(int argc, char *argv[]) {
     } else {
       renderBestiaryUI();
       renderEncounterUI();
-      if (!g_currentMonster.name.empty()) {
-        renderStatBlock(g_currentMonster);
+      if (g_pendingMonster.valid()) {
+        renderStatBlockPlaceholder(g_pendingMonsterName);
+      } else if (g_currentMonster) {
+        renderStatBlock(*g_currentMonster);
       }
     }
 
@@ -487,7 +335,22 @@ int main(int argc, char *argv[]) {
                (int)ImGui::GetIO().DisplaySize.y);
     glClear(GL_COLOR_BUFFER_BIT);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+    std::chrono::duration<double, std::milli> frameTime =
+        std::chrono::steady_clock::now() - frameStart;
+    g_frameStats.lastMs = frameTime.count();
+    g_frameStats.longestMs =
+        std::max(g_frameStats.longestMs, frameTime.count());
+
     SDL_GL_SwapWindow(window);
+
+    if (firstFrame) {
+      firstFrame = false;
+      std::chrono::duration<double, std::milli> startup =
+          std::chrono::steady_clock::now() - launchTime;
+      std::cout << "First frame presented after " << startup.count() << " ms."
+                << std::endl;
+    }
   }
 
   shutdownImGui();
@@ -542,68 +405,13 @@ void renderLabeledField(const char *label, const char *value) {
   ImGui::Text("%s", value);
 }
 
-int calculateModifier(int score) { return (score - 10) / 2; }
-
-int rollDice(const std::string &diceString) {
-  int total = 0;
-  std::string s = diceString;
-  std::transform(s.begin(), s.end(), s.begin(), ::tolower);
-
-  std::regex pattern(R"((\d+)d(\d+)(?:([+-])(\d+))?)");
-  std::smatch matches;
-
-  if (std::regex_match(s, matches, pattern)) {
-    int numDice = std::stoi(matches[1].str());
-    int dieType = std::stoi(matches[2].str());
-
-    for (int i = 0; i < numDice; ++i) {
-      total += (std::uniform_int_distribution<>(1, dieType))(g_rng);
-    }
-
-    if (matches[3].matched) {
-      char sign = matches[3].str()[0];
-      int modifier = std::stoi(matches[4].str());
-      if (sign == '+') {
-        total += modifier;
-      } else if (sign == '-') {
-        total -= modifier;
-      }
-    }
-  } else {
-    try {
-      total = std::stoi(diceString);
-    } catch (const std::invalid_argument &e) {
-      std::cerr << "Error: Invalid dice string format: " << diceString
-                << std::endl;
-      return 0;
-    } catch (const std::out_of_range &e) {
-      std::cerr << "Error: Dice string out of range: " << diceString
-                << std::endl;
-      return 0;
-    }
-  }
-  return total;
-}
-
-int getAbilityScore(const Combatant &combatant,
-                    const std::string &abilityName) {
-  std::string lowerAbilityName = abilityName;
-  std::transform(lowerAbilityName.begin(), lowerAbilityName.end(),
-                 lowerAbilityName.begin(), ::tolower);
-
-  if (lowerAbilityName == "strength")
-    return combatant.base.strength;
-  if (lowerAbilityName == "dexterity")
-    return combatant.base.dexterity;
-  if (lowerAbilityName == "constitution")
-    return combatant.base.constitution;
-  if (lowerAbilityName == "intelligence")
-    return combatant.base.intelligence;
-  if (lowerAbilityName == "wisdom")
-    return combatant.base.wisdom;
-  if (lowerAbilityName == "charisma")
-    return combatant.base.charisma;
-  return 0;
+// Exact odds for one use of an ability or spell by `monster`, including the
+// ability-score bonus that resolveAction adds to the dice.
+const DiceDistribution &damageOdds(const Monster &monster,
+                                   const DiceExpr &damage,
+                                   const std::string &damageModifierAbility) {
+  return g_damageOdds.get(
+      damageWithBonus(monster, damage, damageModifierAbility));
 }
 
 void renderStatBlock(const Monster &monster) {
@@ -715,6 +523,14 @@ void renderStatBlock(const Monster &monster) {
         ImGui::Text("[%s] %s", ability.type.c_str(), ability.name.c_str());
         ImGui::PopStyleColor();
         ImGui::TextWrapped("%s", ability.description.c_str());
+        if (!ability.damage.empty()) {
+          const DiceDistribution &odds = damageOdds(
+              monster, ability.damage, ability.damageModifierAbility);
+          ImGui::TextDisabled("%s %s: average %.1f, 10-90%% %d-%d",
+                              ability.damageDice.c_str(),
+                              ability.damageType.c_str(), odds.mean(),
+                              odds.percentile(0.1), odds.percentile(0.9));
+        }
         ImGui::Separator();
       }
       ImGui::PopStyleColor();
@@ -727,89 +543,441 @@ void renderStatBlock(const Monster &monster) {
 
 void renderBestiaryUI() {
   ImGui::Begin("Bestiary");
-  ImGui::Text("Select a monster:");
+  if (g_pendingBestiary.valid()) {
+    ImGui::TextDisabled("Loading bestiary...");
+  } else {
+    ImGui::Text("Select a monster:");
+  }
 
   if (ImGui::InputText("Search", g_searchBuffer,
                        IM_ARRAYSIZE(g_searchBuffer))) {
     g_selectedMonsterIndex = 0;
   }
-
-  std::string filter = g_searchBuffer;
-  std::transform(filter.begin(), filter.end(), filter.begin(),
-                 [](unsigned char c) { return std::tolower(c); });
-
-  g_filteredMonsterNames.clear();
-  if (filter.empty()) {
-    g_filteredMonsterNames = g_monsterNames;
-  } else {
-    for (const auto &name : g_monsterNames) {
-      std::string lower_name = name;
-      std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(),
-                     [](unsigned char c) { return std::tolower(c); });
-      if (lower_name.find(filter) != std::string::npos) {
-        g_filteredMonsterNames.push_back(name);
-      }
-    }
-  }
+  // Cheap when nothing changed, so it can run every frame.
+  g_monsterFilter.update(g_searchBuffer);
+  const int count = static_cast<int>(g_monsterFilter.size());
 
   if (ImGui::ListBox(
           "##MonsterList", &g_selectedMonsterIndex,
           [](void *data, int idx) -> const char * {
-            auto *names = static_cast<std::vector<std::string> *>(data);
-            if (idx >= 0 && idx < names->size()) {
-              return (*names)[idx].c_str();
+            auto *filter = static_cast<MonsterFilter *>(data);
+            if (idx >= 0 && idx < static_cast<int>(filter->size())) {
+              return g_monsterNames[(*filter)[idx]].c_str();
             }
             return "";
           },
-          (void *)&g_filteredMonsterNames, g_filteredMonsterNames.size(), 20)) {
-    if (g_selectedMonsterIndex >= 0 &&
-        g_selectedMonsterIndex < g_filteredMonsterNames.size()) {
-      g_currentMonster = getMonsterByName(
-          *g_db, g_filteredMonsterNames[g_selectedMonsterIndex]);
+          (void *)&g_monsterFilter, count, 20)) {
+    if (g_selectedMonsterIndex >= 0 && g_selectedMonsterIndex < count) {
+      selectMonster(g_monsterNames[g_monsterFilter[g_selectedMonsterIndex]]);
     }
   }
 
   ImGui::Separator();
 
-  if (!g_filteredMonsterNames.empty() && g_selectedMonsterIndex >= 0 &&
-      g_selectedMonsterIndex < g_filteredMonsterNames.size()) {
-    if (ImGui::Button("Add to Encounter")) {
-      Combatant newCombatant(g_currentMonster);
-      try {
-        SQLite::Statement idQuery(
-            *g_db, "SELECT MonsterID FROM Monsters WHERE Name = ?");
-        idQuery.bind(1, g_currentMonster.name);
-        if (idQuery.executeStep()) {
-          int monsterId = idQuery.getColumn(0).getInt();
-          newCombatant.spellSlots = getMonsterSpellSlots(monsterId, *g_db);
-          newCombatant.maxSpellSlots = newCombatant.spellSlots;
-        }
-      } catch (const std::exception &e) {
-        std::cerr << "Failed to get monster ID for spell slot assignment: "
-                  << e.what() << std::endl;
-      }
+  if (count > 0 && g_selectedMonsterIndex >= 0 &&
+      g_selectedMonsterIndex < count) {
+    bool is_loading = g_pendingMonster.valid() || !g_currentMonster;
+    if (is_loading) {
+      ImGui::BeginDisabled();
+    }
+    bool add_clicked = ImGui::Button("Add to Encounter");
+    if (is_loading) {
+      ImGui::EndDisabled();
+    }
+    if (add_clicked) {
+      EncounterEvent event(EncounterEvent::ADD_MONSTER);
+      event.monster = g_journal.internMonster(g_currentMonster);
+      record(event);
+    }
+  }
 
-      int count = 0;
-      for (const auto &combatant : g_encounterList) {
-        if (combatant.base.name == newCombatant.base.name) {
-          count++;
-        }
-      }
-      if (count > 0) {
-        newCombatant.displayName =
-            newCombatant.base.name + " " + std::to_string(count + 1);
-      }
+  ImGui::TextDisabled("Frame %.2f ms, longest %.2f ms", g_frameStats.lastMs,
+                      g_frameStats.longestMs);
+  ImGui::SameLine();
+  if (ImGui::SmallButton("Reset")) {
+    g_frameStats.longestMs = 0.0;
+  }
+  MonsterCacheStats cache = g_loader->cacheStats();
+  ImGui::TextDisabled("Cache %zu hits, %zu misses, %zu evicted (%zu, %zu KiB)",
+                      cache.hits, cache.misses, cache.evictions, cache.entries,
+                      cache.bytes / 1024);
+
+  ImGui::End();
+}
+
+// --- Encounter Membership ---
+// Every insertion and removal goes through here so the registry's handles
+// keep pointing at the right entries of g_encounterList.
+void addCombatant(Combatant combatant) {
+  combatant.handle = g_combatants.acquire();
+  combatant.rng = g_encounterRng.derive(g_combatantsJoined++);
+  g_encounterList.push_back(std::move(combatant));
+  g_combatants.reindex(g_encounterList);
+  g_initiative.insert(g_encounterList.back());
+  g_turnScheduler.join(g_encounterList.back());
+}
 
-      g_encounterList.push_back(newCombatant);
-      {
-        std::stringstream ss;
-        ss << newCombatant.displayName << " has joined the fray!";
-        g_combatLog.push_back({ss.str(), LogEntry::INFO});
+// Runs whatever g_turnScheduler has due before the current creature's turn
+// and logs it. Call before startTurn() when the turn moves forward.
+void dispatchTurnEvents() {
+  std::vector<TurnEvent> fired;
+  g_turnScheduler.nextTurn(fired);
+  for (const auto &event : fired) {
+    const Combatant *owner =
+        g_combatants.resolve(g_encounterList, event.owner);
+    std::stringstream ss;
+    switch (event.type) {
+    case TurnEvent::RECHARGE:
+      ss << owner->displayName << "'s "
+         << owner->base->abilities[event.ability].name
+         << (event.recharged ? " recharges" : " does not recharge")
+         << " (rolled " << event.roll << ").";
+      break;
+    case TurnEvent::LEGENDARY:
+      ss << owner->displayName << " regains its legendary actions.";
+      break;
+    case TurnEvent::LAIR:
+      ss << "Initiative count 20: " << owner->displayName
+         << " can take a lair action.";
+      break;
+    }
+    g_combatLog.push_back({ss.str(), LogEntry::EVENT});
+  }
+}
+
+// Hands the turn to whoever g_initiative says is current.
+void startTurn() {
+  Combatant *combatant =
+      g_combatants.resolve(g_encounterList, g_initiative.current());
+  if (!combatant) {
+    return;
+  }
+  combatant->hasUsedAction = false;
+  combatant->hasUsedBonusAction = false;
+  std::stringstream ss;
+  ss << "It is now " << combatant->displayName << "'s turn.";
+  g_combatLog.push_back({ss.str(), LogEntry::EVENT});
+}
+
+void removeCombatant(CombatantHandle handle) {
+  const int index = g_combatants.indexOf(handle);
+  if (index < 0) {
+    return;
+  }
+  const bool hadTurn = handle == g_initiative.current();
+  g_turnScheduler.leave(handle);
+  g_initiative.remove(handle);
+  g_combatants.release(handle);
+  g_encounterList.erase(g_encounterList.begin() + index);
+  g_combatants.reindex(g_encounterList);
+
+  // A player who left no longer rolls; nobody does if the attacker left.
+  auto &targets = g_playerSaveState.targets;
+  if (handle == g_playerSaveState.action.owner) {
+    targets.clear();
+  }
+  targets.erase(std::remove(targets.begin(), targets.end(), handle),
+                targets.end());
+  g_playerSaveState.isActive = !targets.empty();
+
+  if (hadTurn) {
+    dispatchTurnEvents();
+    startTurn();
+  }
+}
+
+// --- Encounter Events ---
+// What each EncounterEvent does. Only applyEncounterEvent() calls these, so
+// replaying the journal does exactly what the table did.
+void addMonster(const std::shared_ptr<const Monster> &monster) {
+  Combatant newCombatant(monster);
+
+  int count = 0;
+  for (const auto &combatant : g_encounterList) {
+    if (combatant.base->name == newCombatant.base->name) {
+      count++;
+    }
+  }
+  if (count > 0) {
+    newCombatant.displayName =
+        newCombatant.base->name + " " + std::to_string(count + 1);
+  }
+
+  addCombatant(newCombatant);
+  {
+    std::stringstream ss;
+    ss << newCombatant.displayName << " has joined the fray!";
+    g_combatLog.push_back({ss.str(), LogEntry::INFO});
+  }
+}
+
+void addPlayer(const std::string &name, int initiative) {
+  Combatant newPlayer;
+  newPlayer.isPlayer = true;
+  newPlayer.displayName = name;
+  newPlayer.initiative = initiative;
+  newPlayer.currentHitPoints = 0;
+  newPlayer.maxHitPoints = 0;
+  addCombatant(newPlayer);
+  {
+    std::stringstream ss;
+    ss << newPlayer.displayName << " has joined the fray!";
+    g_combatLog.push_back({ss.str(), LogEntry::INFO});
+  }
+}
+
+void adjustHitPoints(Combatant &combatant, int amount) {
+  combatant.currentHitPoints += amount;
+  std::stringstream ss;
+  if (amount < 0) {
+    ss << combatant.displayName << " takes " << -amount << " damage.";
+    g_combatLog.push_back({ss.str(), LogEntry::DAMAGE});
+  } else {
+    ss << combatant.displayName << " heals " << amount << " damage.";
+    g_combatLog.push_back({ss.str(), LogEntry::HEALING});
+  }
+}
+
+void beginCombat() {
+  g_combatLog.push_back({"Combat has begun!", LogEntry::EVENT});
+  g_combatLog.push_back(
+      {"Encounter seed " + std::to_string(g_encounterSeed), LogEntry::INFO});
+  for (auto &combatant : g_encounterList) {
+    if (!combatant.isPlayer) {
+      combatant.initiative = rollFace(20, combatant.rng) +
+                             calculateModifier(combatant.base->dexterity);
+    }
+  }
+  g_initiative.updateAll(g_encounterList);
+  g_initiative.setCurrent(CombatantHandle{});
+  g_initiative.advance(1);
+  g_combatHasBegun = true;
+  g_turnScheduler.begin();
+  dispatchTurnEvents();
+  startTurn();
+}
+
+void endCombat() {
+  g_initiative.setCurrent(CombatantHandle{});
+  g_turnScheduler.end();
+  g_combatHasBegun = false;
+  g_combatLog.push_back({"Combat has ended.", LogEntry::EVENT});
+}
+
+void nextTurn() {
+  if (!g_initiative.current()) {
+    return;
+  }
+  std::vector<ExpiredCondition> expired;
+  g_conditionWheel.advance(g_encounterList, g_combatants, expired);
+  for (const auto &condition : expired) {
+    const Combatant *combatant =
+        g_combatants.resolve(g_encounterList, condition.combatant);
+    std::stringstream ss;
+    ss << combatant->displayName << " is no longer "
+       << conditionName(condition.condition) << ".";
+    g_combatLog.push_back({ss.str(), LogEntry::EVENT});
+  }
+
+  g_initiative.advance(1);
+  dispatchTurnEvents();
+  startTurn();
+}
+
+void previousTurn() {
+  if (!g_initiative.current()) {
+    return;
+  }
+  g_initiative.advance(-1);
+  g_turnScheduler.previousTurn();
+  startTurn();
+}
+
+void longRest() {
+  for (auto &combatant : g_encounterList) {
+    combatant.restoreResources();
+  }
+  g_combatLog.push_back(
+      {"Everyone has finished a long rest.", LogEntry::EVENT});
+}
+
+// Sends the log text for the events of the last resolution to the combat log
+// and queues a prompt for each save a player has to roll.
+void logActionEvents(const ActionDef &action, const Combatant &actor) {
+  bool promptQueued = false;
+  for (const ActionEvent &event : g_actionEvents) {
+    const Combatant *target =
+        g_combatants.resolve(g_encounterList, event.target);
+    if (!target) {
+      continue;
+    }
+    g_combatLog.push_back(formatActionEvent(action, actor, *target, event));
+    // Saves deep in an effect tree are only logged; the table applies them.
+    if (event.type == ActionEvent::PLAYER_SAVE && event.effect < 0) {
+      if (!promptQueued) {
+        g_playerSaveState.targets.clear();
+        g_playerSaveState.action = action.handle;
+        promptQueued = true;
       }
+      g_playerSaveState.targets.push_back(event.target);
+      g_playerSaveState.isActive = true;
     }
   }
+}
 
-  ImGui::End();
+void resolveAction(const ActionHandle &actionHandle,
+                   const std::vector<CombatantHandle> &targets) {
+  Combatant *actor =
+      g_combatants.resolve(g_encounterList, actionHandle.owner);
+  ActionDef action;
+  if (!actor || !makeActionDef(*actor, actionHandle, action)) {
+    return;
+  }
+  g_actionEvents.clear();
+  g_actionResolver.resolve(action, *actor, targets, g_actionEvents);
+  g_turnScheduler.spent(*actor, action);
+  logActionEvents(action, *actor);
+}
+
+void answerPlayerSave(const ActionHandle &actionHandle,
+                      CombatantHandle targetHandle, bool saved) {
+  Combatant *attacker =
+      g_combatants.resolve(g_encounterList, actionHandle.owner);
+  Combatant *target = g_combatants.resolve(g_encounterList, targetHandle);
+  ActionDef action;
+  if (attacker && target &&
+      makeActionDef(*attacker, actionHandle, action)) {
+    g_actionEvents.clear();
+    g_actionResolver.finishPlayerSave(action, *attacker, *target, saved,
+                                      g_actionEvents);
+    logActionEvents(action, *attacker);
+  }
+  auto &targets = g_playerSaveState.targets;
+  targets.erase(std::remove(targets.begin(), targets.end(), targetHandle),
+                targets.end());
+  g_playerSaveState.isActive = !targets.empty();
+}
+
+void applyEncounterEvent(const EncounterEvent &event) {
+  Combatant *combatant =
+      g_combatants.resolve(g_encounterList, event.combatant);
+  switch (event.type) {
+  case EncounterEvent::ADD_MONSTER:
+    addMonster(g_journal.monster(event.monster));
+    break;
+  case EncounterEvent::ADD_PLAYER:
+    addPlayer(event.name, event.value);
+    break;
+  case EncounterEvent::REMOVE:
+    if (combatant) {
+      g_combatLog.push_back(
+          {combatant->displayName + " has been removed from combat.",
+           LogEntry::INFO});
+      removeCombatant(event.combatant);
+    }
+    break;
+  case EncounterEvent::ADJUST_HIT_POINTS:
+    if (combatant) {
+      adjustHitPoints(*combatant, event.value);
+    }
+    break;
+  case EncounterEvent::SET_INITIATIVE:
+    if (combatant) {
+      combatant->initiative = event.value;
+      g_initiative.update(*combatant);
+      g_turnScheduler.moved(*combatant);
+    }
+    break;
+  case EncounterEvent::SET_RESOURCE:
+    if (combatant) {
+      combatant->resources.values[event.index] = event.value;
+    }
+    break;
+  case EncounterEvent::SET_CURRENT:
+    g_initiative.setCurrent(event.combatant);
+    break;
+  case EncounterEvent::BEGIN_COMBAT:
+    beginCombat();
+    break;
+  case EncounterEvent::END_COMBAT:
+    endCombat();
+    break;
+  case EncounterEvent::NEXT_TURN:
+    nextTurn();
+    break;
+  case EncounterEvent::PREVIOUS_TURN:
+    previousTurn();
+    break;
+  case EncounterEvent::RESOLVE_ACTION:
+    resolveAction(event.action, event.targets);
+    break;
+  case EncounterEvent::PLAYER_SAVE:
+    answerPlayerSave(event.action, event.combatant, event.value != 0);
+    break;
+  case EncounterEvent::LONG_REST:
+    longRest();
+    break;
+  case EncounterEvent::DISMISS_SAVES:
+    g_playerSaveState.targets.clear();
+    g_playerSaveState.isActive = false;
+    break;
+  }
+}
+
+// --- Encounter History ---
+EncounterSnapshot captureEncounter() {
+  return {g_encounterList,    g_combatants,       g_initiative,
+          g_conditionWheel,   g_turnScheduler,    g_combatHasBegun,
+          g_combatantsJoined, g_playerSaveState, g_combatLog.size()};
+}
+
+void restoreEncounter(const EncounterSnapshot &snapshot) {
+  g_encounterList = snapshot.encounterList;
+  g_combatants = snapshot.combatants;
+  g_initiative = snapshot.initiative;
+  g_conditionWheel = snapshot.conditionWheel;
+  g_turnScheduler = snapshot.turnScheduler;
+  g_combatHasBegun = snapshot.combatHasBegun;
+  g_combatantsJoined = snapshot.combatantsJoined;
+  g_playerSaveState = snapshot.playerSave;
+  g_combatLog.resize(snapshot.combatLogSize);
+}
+
+void takeCheckpointIfDue() {
+  if (g_checkpoints.due(g_journal.cursor())) {
+    g_checkpoints.take(captureEncounter());
+  }
+}
+
+// Does `event` to the encounter and journals it. Anything undone before it
+// can no longer be redone.
+void record(const EncounterEvent &event) {
+  g_checkpoints.dropAfter(g_journal.cursor());
+  g_journal.append(event);
+  applyEncounterEvent(event);
+  takeCheckpointIfDue();
+}
+
+// Puts the encounter as it was after the first `cursor` events: from the
+// state it is in when going forward within the same checkpoint, otherwise
+// from the nearest checkpoint at or before `cursor`.
+void seekEncounter(size_t cursor) {
+  cursor = std::min(cursor, g_journal.size());
+  size_t from = g_checkpoints.before(cursor);
+  if (g_journal.cursor() > cursor || g_journal.cursor() < from) {
+    restoreEncounter(g_checkpoints.at(from));
+  } else {
+    from = g_journal.cursor();
+  }
+  EncounterEvent event;
+  for (size_t i = from; i < cursor; ++i) {
+    g_journal.read(i, event);
+    g_journal.setCursor(i + 1);
+    applyEncounterEvent(event);
+    takeCheckpointIfDue();
+  }
+  g_journal.setCursor(cursor);
+  g_targetingState = TargetingState{};
 }
 
 void renderEncounterUI() {
@@ -829,18 +997,10 @@ void renderEncounterUI() {
 
   if (ImGui::Button("Add Player")) {
     if (strlen(g_newPlayerNameBuffer) > 0) {
-      Combatant newPlayer;
-      newPlayer.isPlayer = true;
-      newPlayer.displayName = g_newPlayerNameBuffer;
-      newPlayer.initiative = g_newPlayerInitiative;
-      newPlayer.currentHitPoints = 0;
-      newPlayer.maxHitPoints = 0;
-      g_encounterList.push_back(newPlayer);
-      {
-        std::stringstream ss;
-        ss << newPlayer.displayName << " has joined the fray!";
-        g_combatLog.push_back({ss.str(), LogEntry::INFO});
-      }
+      EncounterEvent event(EncounterEvent::ADD_PLAYER, {},
+                           g_newPlayerInitiative);
+      event.name = g_newPlayerNameBuffer;
+      record(event);
       g_newPlayerNameBuffer[0] = '\0';
       g_newPlayerInitiative = 0;
     }
@@ -851,87 +1011,26 @@ void renderEncounterUI() {
   if (!g_encounterList.empty()) {
     if (!g_combatHasBegun) {
       if (ImGui::Button("Begin Combat")) {
-        g_combatLog.push_back({"Combat has begun!", LogEntry::EVENT});
-        for (auto &combatant : g_encounterList) {
-          if (!combatant.isPlayer) {
-            combatant.initiative =
-                (std::uniform_int_distribution<>(1, 20))(g_rng) +
-                calculateModifier(combatant.base.dexterity);
-          }
-        }
-        std::sort(g_encounterList.begin(), g_encounterList.end(),
-                  [](const Combatant &a, const Combatant &b) {
-                    return a.initiative > b.initiative;
-                  });
-        g_currentTurnIndex = 0;
-        if (g_currentTurnIndex >= 0 &&
-            g_currentTurnIndex < g_encounterList.size()) {
-          g_encounterList[g_currentTurnIndex].hasUsedAction = false;
-          g_encounterList[g_currentTurnIndex].hasUsedBonusAction = false;
-        }
-        g_combatHasBegun = true;
-        {
-          std::stringstream ss;
-          ss << "It is now " << g_encounterList[g_currentTurnIndex].displayName
-             << "'s turn.";
-          g_combatLog.push_back({ss.str(), LogEntry::EVENT});
-        }
+        record(EncounterEvent(EncounterEvent::BEGIN_COMBAT));
+      }
+      ImGui::SameLine();
+      if (ImGui::Button("Long Rest")) {
+        record(EncounterEvent(EncounterEvent::LONG_REST));
       }
     } else {
       if (ImGui::Button("End Combat")) {
-        g_currentTurnIndex = -1;
-        g_combatHasBegun = false;
-        g_combatLog.push_back({"Combat has ended.", LogEntry::EVENT});
+        record(EncounterEvent(EncounterEvent::END_COMBAT));
       }
     }
 
     if (g_combatHasBegun) {
       ImGui::SameLine();
-      if (ImGui::Button("Next Turn")) {
-        if (g_currentTurnIndex != -1) {
-          for (auto &combatant : g_encounterList) {
-            std::vector<std::pair<std::string, int>> remainingConditions;
-            for (const auto &condition : combatant.activeConditions) {
-              if (condition.second > 1) {
-                remainingConditions.push_back(
-                    {condition.first, condition.second - 1});
-              } else {
-                std::stringstream ss;
-                ss << combatant.displayName << " is no longer "
-                   << condition.first << ".";
-                g_combatLog.push_back({ss.str(), LogEntry::EVENT});
-              }
-            }
-            combatant.activeConditions = remainingConditions;
-          }
-
-          g_currentTurnIndex =
-              (g_currentTurnIndex + 1) % g_encounterList.size();
-          g_encounterList[g_currentTurnIndex].hasUsedAction = false;
-          g_encounterList[g_currentTurnIndex].hasUsedBonusAction = false;
-          {
-            std::stringstream ss;
-            ss << "It is now "
-               << g_encounterList[g_currentTurnIndex].displayName << "'s turn.";
-            g_combatLog.push_back({ss.str(), LogEntry::EVENT});
-          }
-        }
+      if (ImGui::Button("Next Turn") && g_initiative.current()) {
+        record(EncounterEvent(EncounterEvent::NEXT_TURN));
       }
       ImGui::SameLine();
-      if (ImGui::Button("Previous Turn")) {
-        if (g_currentTurnIndex != -1) {
-          g_currentTurnIndex =
-              (g_currentTurnIndex - 1 + g_encounterList.size()) %
-              g_encounterList.size();
-          g_encounterList[g_currentTurnIndex].hasUsedAction = false;
-          g_encounterList[g_currentTurnIndex].hasUsedBonusAction = false;
-          {
-            std::stringstream ss;
-            ss << "It is now "
-               << g_encounterList[g_currentTurnIndex].displayName << "'s turn.";
-            g_combatLog.push_back({ss.str(), LogEntry::EVENT});
-          }
-        }
+      if (ImGui::Button("Previous Turn") && g_initiative.current()) {
+        record(EncounterEvent(EncounterEvent::PREVIOUS_TURN));
       }
     }
   }
@@ -951,13 +1050,19 @@ void renderEncounterUI() {
                               100.0f);
       ImGui::TableHeadersRow();
 
-      int combatant_to_remove = -1;
-      for (int i = 0; i < g_encounterList.size(); ++i) {
-        ImGui::PushID(i);
+      // Rows follow the initiative order. Changes wait until after the loop
+      // so that the order does not shift under it.
+      CombatantHandle combatant_to_remove;
+      CombatantHandle initiative_changed;
+      int new_initiative = 0;
+      for (size_t position = 0; position < g_initiative.size(); ++position) {
+        const CombatantHandle handle = g_initiative[position];
+        const int i = g_combatants.indexOf(handle);
+        ImGui::PushID(static_cast<int>(handle.slot));
         ImGui::TableNextRow();
 
         ImGui::TableSetColumnIndex(0);
-        bool is_current_turn = (i == g_currentTurnIndex);
+        bool is_current_turn = (handle == g_initiative.current());
         if (is_current_turn) {
           ImGui::PushStyleColor(ImGuiCol_Header,
                                 ImVec4(0.9f, 0.6f, 0.0f, 1.0f));
@@ -965,7 +1070,7 @@ void renderEncounterUI() {
         std::string label = g_encounterList[i].displayName + " (" +
                             std::to_string(g_encounterList[i].initiative) + ")";
         if (ImGui::Selectable(label.c_str(), is_current_turn)) {
-          g_currentTurnIndex = i;
+          record(EncounterEvent(EncounterEvent::SET_CURRENT, handle));
         }
         if (is_current_turn) {
           ImGui::PopStyleColor();
@@ -980,12 +1085,8 @@ void renderEncounterUI() {
             ImGui::BeginDisabled();
           }
           if (ImGui::Button("-")) {
-            g_encounterList[i].currentHitPoints--;
-            {
-              std::stringstream ss;
-              ss << g_encounterList[i].displayName << " takes 1 damage.";
-              g_combatLog.push_back({ss.str(), LogEntry::DAMAGE});
-            }
+            record(
+                EncounterEvent(EncounterEvent::ADJUST_HIT_POINTS, handle, -1));
           }
           if (is_dead) {
             ImGui::EndDisabled();
@@ -1002,12 +1103,8 @@ void renderEncounterUI() {
             ImGui::BeginDisabled();
           }
           if (ImGui::Button("+")) {
-            g_encounterList[i].currentHitPoints++;
-            {
-              std::stringstream ss;
-              ss << g_encounterList[i].displayName << " heals 1 damage.";
-              g_combatLog.push_back({ss.str(), LogEntry::HEALING});
-            }
+            record(
+                EncounterEvent(EncounterEvent::ADJUST_HIT_POINTS, handle, 1));
           }
           if (at_max_hp) {
             ImGui::EndDisabled();
@@ -1015,51 +1112,157 @@ void renderEncounterUI() {
         }
 
         ImGui::TableSetColumnIndex(2);
-        ImGui::InputInt("##Initiative", &g_encounterList[i].initiative);
+        int initiative = g_encounterList[i].initiative;
+        if (ImGui::InputInt("##Initiative", &initiative)) {
+          initiative_changed = handle;
+          new_initiative = initiative;
+        }
 
         ImGui::TableSetColumnIndex(3);
-        if (!g_encounterList[i].activeConditions.empty()) {
-          for (const auto &condition : g_encounterList[i].activeConditions) {
-            ImGui::TextWrapped("- %s (%d turns)", condition.first.c_str(),
-                               condition.second);
-          }
+        const Combatant &combatant = g_encounterList[i];
+        if (!combatant.conditions.empty()) {
+          combatant.conditions.forEach([&](Condition condition, uint32_t) {
+            std::string_view name = conditionName(condition);
+            ImGui::TextWrapped("- %.*s (%d turns)",
+                               static_cast<int>(name.size()), name.data(),
+                               g_conditionWheel.remaining(combatant,
+                                                          condition));
+          });
         } else {
           ImGui::Text("None");
         }
 
         ImGui::TableSetColumnIndex(4);
         if (ImGui::Button("Remove")) {
-          combatant_to_remove = i;
+          combatant_to_remove = handle;
         }
 
         ImGui::PopID();
       }
 
-      if (combatant_to_remove != -1) {
-        if (combatant_to_remove == g_currentTurnIndex) {
-          g_currentTurnIndex = -1;
-        }
-        g_combatLog.push_back(
-            {g_encounterList[combatant_to_remove].displayName +
-                 " has been removed from combat.",
-             LogEntry::INFO});
-        g_encounterList.erase(g_encounterList.begin() + combatant_to_remove);
+      if (initiative_changed) {
+        record(EncounterEvent(EncounterEvent::SET_INITIATIVE,
+                              initiative_changed, new_initiative));
+      }
+      if (combatant_to_remove) {
+        record(EncounterEvent(EncounterEvent::REMOVE, combatant_to_remove));
       }
       ImGui::EndTable();
     }
   }
 
+  ImGui::SeparatorText("History");
+  const size_t cursor = g_journal.cursor();
+  if (cursor == 0) {
+    ImGui::BeginDisabled();
+  }
+  if (ImGui::Button("Undo")) {
+    seekEncounter(cursor - 1);
+  }
+  if (cursor == 0) {
+    ImGui::EndDisabled();
+  }
+  ImGui::SameLine();
+  if (cursor == g_journal.size()) {
+    ImGui::BeginDisabled();
+  }
+  if (ImGui::Button("Redo")) {
+    seekEncounter(cursor + 1);
+  }
+  if (cursor == g_journal.size()) {
+    ImGui::EndDisabled();
+  }
+  ImGui::SameLine();
+  int position = static_cast<int>(g_journal.cursor());
+  ImGui::PushItemWidth(200);
+  if (ImGui::SliderInt("##History", &position, 0,
+                       static_cast<int>(g_journal.size()))) {
+    seekEncounter(static_cast<size_t>(position));
+  }
+  ImGui::PopItemWidth();
+  ImGui::SameLine();
+  ImGui::TextDisabled("%zu events, %zu bytes", g_journal.size(),
+                      g_journal.bytes());
+
   ImGui::End();
 }
+
+// Buttons for `combatant`'s abilities of `type`, LEGENDARY or LAIR, usable
+// while it has the legendary actions left or its lair action is ready.
+void renderSpecialActions(const Combatant &combatant, ActionType type) {
+  const auto &abilities = combatant.base->abilities;
+  ImGui::Text("%s", combatant.displayName.c_str());
+  if (type == ActionType::LEGENDARY) {
+    ImGui::SameLine();
+    ImGui::TextDisabled("(%d of %d left)", combatant.legendaryActions,
+                        combatant.base->legendaryActions);
+  }
+  for (int abilityIndex = 0;
+       abilityIndex < static_cast<int>(abilities.size()); ++abilityIndex) {
+    const Ability &ability = abilities[abilityIndex];
+    if (ability.actionType != type) {
+      continue;
+    }
+    ImGui::PushID(&ability);
+    bool usable = type == ActionType::LAIR
+                      ? combatant.lairActionReady
+                      : ability.legendaryCost <= combatant.legendaryActions;
+    if (!usable) {
+      ImGui::BeginDisabled();
+    }
+    if (ImGui::Button(ability.name.c_str())) {
+      g_targetingState.isTargeting = true;
+      g_targetingState.action = {combatant.handle, ActionKind::ABILITY,
+                                 abilityIndex};
+    }
+    if (!usable) {
+      ImGui::EndDisabled();
+    }
+    ImGui::PopID();
+  }
+}
+
+// Legendary actions are taken at the end of other creatures' turns, so
+// everyone's but the current creature's are offered; lair actions only once
+// initiative count 20 has come round.
+void renderLegendaryActions(const Combatant &current) {
+  const auto &legendary = g_turnScheduler.legendary();
+  const auto &lairReady = g_turnScheduler.lairReady();
+  if ((legendary.empty() ||
+       (legendary.size() == 1 && legendary.front() == current.handle)) &&
+      lairReady.empty()) {
+    return;
+  }
+  ImGui::SeparatorText("Legendary & Lair Actions");
+  for (CombatantHandle handle : legendary) {
+    const Combatant *combatant =
+        g_combatants.resolve(g_encounterList, handle);
+    if (combatant && handle != current.handle) {
+      ImGui::PushID(static_cast<int>(handle.slot));
+      renderSpecialActions(*combatant, ActionType::LEGENDARY);
+      ImGui::PopID();
+    }
+  }
+  for (CombatantHandle handle : lairReady) {
+    if (const Combatant *combatant =
+            g_combatants.resolve(g_encounterList, handle)) {
+      ImGui::PushID(-1 - static_cast<int>(handle.slot));
+      renderSpecialActions(*combatant, ActionType::LAIR);
+      ImGui::PopID();
+    }
+  }
+}
+
 void renderCombatUI() {
-  if (!g_combatHasBegun || g_currentTurnIndex < 0 ||
-      g_currentTurnIndex >= g_encounterList.size()) {
+  Combatant *current =
+      g_combatants.resolve(g_encounterList, g_initiative.current());
+  if (!g_combatHasBegun || !current) {
     return;
   }
 
   ImGui::Begin("Combat Operations");
 
-  Combatant &activeCombatant = g_encounterList[g_currentTurnIndex];
+  Combatant &activeCombatant = *current;
 
   ImGui::Text("Current Turn: ");
   ImGui::SameLine();
@@ -1082,11 +1285,15 @@ void renderCombatUI() {
 
   if (!activeCombatant.isPlayer) {
     ImGui::SeparatorText("Abilities");
-    if (activeCombatant.base.abilities.empty()) {
+    if (activeCombatant.base->abilities.empty()) {
       ImGui::Text("This creature has no special abilities.");
     } else {
-      auto &usesMap = activeCombatant.abilityUses;
-      for (const auto &ability : activeCombatant.base.abilities) {
+      const auto &resources = activeCombatant.resources.values;
+      const auto &abilities = activeCombatant.base->abilities;
+      for (int abilityIndex = 0;
+           abilityIndex < static_cast<int>(abilities.size());
+           ++abilityIndex) {
+        const Ability &ability = abilities[abilityIndex];
         if (ability.name == "Spellcasting") {
           continue;
         }
@@ -1097,8 +1304,9 @@ void renderCombatUI() {
              ability.actionType == ActionType::BONUS_ACTION);
 
         if (is_usable_action) {
-          bool is_limited_by_uses = (ability.usesMax > 0);
-          int remaining_uses = is_limited_by_uses ? usesMap[ability.name] : 0;
+          bool is_limited_by_uses = (ability.resource >= 0);
+          int remaining_uses =
+              is_limited_by_uses ? resources[ability.resource] : 0;
 
           bool action_already_used =
               (ability.actionType == ActionType::ACTION &&
@@ -1114,14 +1322,26 @@ void renderCombatUI() {
           ImGui::SameLine();
           if (ImGui::Button("Use")) {
             g_targetingState.isTargeting = true;
-            g_targetingState.ability = &ability;
-            g_targetingState.spell = nullptr;
+            g_targetingState.action = {activeCombatant.handle,
+                                       ActionKind::ABILITY, abilityIndex};
           }
 
           if ((is_limited_by_uses && remaining_uses <= 0) ||
               action_already_used) {
             ImGui::EndDisabled();
           }
+
+          if (is_limited_by_uses && ability.usesMax == 0) {
+            // Rolled for at the start of each turn; this overrides the dice.
+            bool charged = remaining_uses > 0;
+            ImGui::SameLine();
+            if (ImGui::Checkbox("Charged", &charged)) {
+              EncounterEvent event(EncounterEvent::SET_RESOURCE,
+                                   activeCombatant.handle, charged ? 1 : 0);
+              event.index = ability.resource;
+              record(event);
+            }
+          }
         }
 
         ImGui::Separator();
@@ -1129,13 +1349,17 @@ void renderCombatUI() {
       }
     }
 
-    if (!activeCombatant.base.spells.empty()) {
+    if (!activeCombatant.base->spells.empty()) {
       ImGui::SeparatorText("Spells");
-      for (const auto &spell : activeCombatant.base.spells) {
+      const auto &spells = activeCombatant.base->spells;
+      for (int spellIndex = 0; spellIndex < static_cast<int>(spells.size());
+           ++spellIndex) {
+        const Spell &spell = spells[spellIndex];
         ImGui::PushID(&spell);
 
-        bool has_slots = (spell.level == 0) ||
-                         (activeCombatant.spellSlots[spell.level - 1] > 0);
+        bool has_slots =
+            (spell.level == 0) ||
+            (activeCombatant.resources.spellSlots(spell.level) > 0);
         bool action_available = (spell.actionType == ActionType::ACTION &&
                                  !activeCombatant.hasUsedAction) ||
                                 (spell.actionType == ActionType::BONUS_ACTION &&
@@ -1149,8 +1373,8 @@ void renderCombatUI() {
         ImGui::SameLine();
         if (ImGui::Button("Cast")) {
           g_targetingState.isTargeting = true;
-          g_targetingState.spell = &spell;
-          g_targetingState.ability = nullptr;
+          g_targetingState.action = {activeCombatant.handle, ActionKind::SPELL,
+                                     spellIndex};
         }
 
         if (!has_slots || !action_available) {
@@ -1161,9 +1385,10 @@ void renderCombatUI() {
       }
     }
 
+    const Resources &maxResources = activeCombatant.base->maxResources;
     bool is_spellcaster = false;
-    for (const auto &slot : activeCombatant.spellSlots) {
-      if (slot > 0) {
+    for (int level = 1; level <= Resources::kSpellLevels; ++level) {
+      if (maxResources.spellSlots(level) > 0) {
         is_spellcaster = true;
         break;
       }
@@ -1177,21 +1402,20 @@ void renderCombatUI() {
         ImGui::TableSetupColumn("Slots", ImGuiTableColumnFlags_WidthStretch);
         ImGui::TableHeadersRow();
 
-        for (int i = 0; i < activeCombatant.spellSlots.size(); ++i) {
-          if (activeCombatant.maxSpellSlots[i] > 0) {
+        for (int level = 1; level <= Resources::kSpellLevels; ++level) {
+          if (maxResources.spellSlots(level) > 0) {
+            int slots = activeCombatant.resources.spellSlots(level);
             ImGui::TableNextRow();
             ImGui::TableSetColumnIndex(0);
-            ImGui::Text("Level %d", i + 1);
+            ImGui::Text("Level %d", level);
             ImGui::TableSetColumnIndex(1);
-            if (ImGui::InputInt(("##level" + std::to_string(i)).c_str(),
-                                &activeCombatant.spellSlots[i])) {
-              if (activeCombatant.spellSlots[i] < 0) {
-                activeCombatant.spellSlots[i] = 0;
-              } else if (activeCombatant.spellSlots[i] >
-                         activeCombatant.maxSpellSlots[i]) {
-                activeCombatant.spellSlots[i] =
-                    activeCombatant.maxSpellSlots[i];
-              }
+            if (ImGui::InputInt(("##level" + std::to_string(level)).c_str(),
+                                &slots)) {
+              EncounterEvent event(
+                  EncounterEvent::SET_RESOURCE, activeCombatant.handle,
+                  std::clamp(slots, 0, maxResources.spellSlots(level)));
+              event.index = level - 1; // Resources::spellSlots(level)
+              record(event);
             }
           }
         }
@@ -1202,31 +1426,72 @@ void renderCombatUI() {
   } else {
     ImGui::Text("Player characters manage their own abilities.");
   }
+
+  renderLegendaryActions(activeCombatant);
   ImGui::End();
 }
 
+// One target's line in the targeting window, e.g.
+// "65% to hit, 7.4 avg, 12% to drop".
+void renderActionOdds(const ActionOdds &odds, bool harmful) {
+  if (!odds.known) {
+    ImGui::TextDisabled("no odds for players");
+    return;
+  }
+  char line[96] = "";
+  int length = 0;
+  if (odds.kind == ActionOdds::ATTACK) {
+    length = snprintf(line, sizeof(line), "%.0f%% to hit",
+                      100.0 * odds.successChance);
+  } else if (odds.kind == ActionOdds::SAVE) {
+    length = snprintf(line, sizeof(line), "%.0f%% to fail save",
+                      100.0 * odds.successChance);
+  }
+  if (harmful) {
+    snprintf(line + length, sizeof(line) - length,
+             "%s%.1f avg, %.0f%% to drop", length > 0 ? ", " : "",
+             odds.expectedDamage, 100.0 * odds.dropChance);
+  }
+  ImGui::TextDisabled("%s", line);
+}
+
 void renderTargetingUI() {
   if (!g_targetingState.isTargeting) {
     return;
   }
 
+  // The actor may have been removed since the action was picked.
+  Combatant *actor =
+      g_combatants.resolve(g_encounterList, g_targetingState.action.owner);
+  if (!actor) {
+    g_targetingState.isTargeting = false;
+    g_targetingState.selectedTargets.clear();
+    return;
+  }
+
   ImGui::Begin("Select Target(s)", &g_targetingState.isTargeting);
 
-  const char *actionName = "";
   int maxTargets = 1;
-  if (g_targetingState.ability) {
-    actionName = g_targetingState.ability->name.c_str();
-  } else if (g_targetingState.spell) {
-    actionName = g_targetingState.spell->name.c_str();
+  ActionDef action;
+  makeActionDef(*actor, g_targetingState.action, action);
+  const DiceDistribution *odds = nullptr; // Harmful damage only
+  if (action.damages && action.damageKind != DamageType::HEALING) {
+    odds = &g_damageOdds.get(action.damage);
   }
 
-  ImGui::Text("Choose target(s) for %s", actionName);
+  g_encounterOdds.sync(g_encounterList);
+  ImGui::Text("Choose target(s) for %.*s", static_cast<int>(action.name.size()),
+              action.name.data());
+  if (odds) {
+    ImGui::TextDisabled("Average %.1f damage on a full hit", odds->mean());
+  }
   ImGui::Separator();
 
   for (int i = 0; i < g_encounterList.size(); ++i) {
+    CombatantHandle handle = g_encounterList[i].handle;
     bool is_selected = false;
-    for (int selected_idx : g_targetingState.selectedTargets) {
-      if (i == selected_idx) {
+    for (CombatantHandle selected : g_targetingState.selectedTargets) {
+      if (handle == selected) {
         is_selected = true;
         break;
       }
@@ -1237,20 +1502,28 @@ void renderTargetingUI() {
       if (is_selected) {
         g_targetingState.selectedTargets.erase(
             std::remove(g_targetingState.selectedTargets.begin(),
-                        g_targetingState.selectedTargets.end(), i),
+                        g_targetingState.selectedTargets.end(), handle),
             g_targetingState.selectedTargets.end());
       } else {
         if (g_targetingState.selectedTargets.size() < maxTargets) {
-          g_targetingState.selectedTargets.push_back(i);
+          g_targetingState.selectedTargets.push_back(handle);
         }
       }
     }
+    if (const ActionOdds *cell =
+            g_encounterOdds.find(g_targetingState.action, handle)) {
+      ImGui::SameLine(200.0f);
+      renderActionOdds(*cell, odds != nullptr);
+    }
   }
 
   ImGui::Separator();
 
   if (ImGui::Button("Confirm")) {
-    resolveAction(g_targetingState);
+    EncounterEvent event(EncounterEvent::RESOLVE_ACTION);
+    event.action = g_targetingState.action;
+    event.targets = g_targetingState.selectedTargets;
+    record(event);
     g_targetingState.isTargeting = false;
     g_targetingState.selectedTargets.clear();
   }
@@ -1263,481 +1536,42 @@ void renderTargetingUI() {
   ImGui::End();
 }
 
-void resolveAction(TargetingState &targetingState) {
-  if (!targetingState.isTargeting) {
-    return;
-  }
-
-  Combatant &activeCombatant = g_encounterList[g_currentTurnIndex];
-
-  if (targetingState.ability) {
-    const Ability &ability = *targetingState.ability;
-    auto &usesMap = activeCombatant.abilityUses;
-
-    if (ability.usesMax > 0) {
-      usesMap[ability.name]--;
-    }
-
-    if (ability.actionType == ActionType::ACTION) {
-      activeCombatant.hasUsedAction = true;
-    } else if (ability.actionType == ActionType::BONUS_ACTION) {
-      activeCombatant.hasUsedBonusAction = true;
-    }
-
-    std::stringstream log_ss;
-    log_ss << activeCombatant.displayName << " uses " << ability.name << ".";
-    g_combatLog.push_back({log_ss.str(), LogEntry::INFO});
-
-    for (int target_idx : targetingState.selectedTargets) {
-      log_ss.str("");
-      Combatant &target = g_encounterList[target_idx];
-
-      bool hit = true;
-      if (!ability.attackRollType.empty()) {
-        int attack_roll = rollDice("1d20");
-        int attacker_ability_score =
-            getAbilityScore(activeCombatant, ability.damageModifierAbility);
-        int attack_modifier = calculateModifier(attacker_ability_score);
-        int total_attack = attack_roll + attack_modifier;
-
-        if (total_attack >= target.base.armorClass) {
-          log_ss << activeCombatant.displayName << "'s " << ability.name
-                 << " hits " << target.displayName
-                 << " (Attack Roll: " << attack_roll << " + " << attack_modifier
-                 << " = " << total_attack << " vs AC " << target.base.armorClass
-                 << ").";
-          hit = true;
-        } else {
-          log_ss << activeCombatant.displayName << "'s " << ability.name
-                 << " misses " << target.displayName
-                 << " (Attack Roll: " << attack_roll << " + " << attack_modifier
-                 << " = " << total_attack << " vs AC " << target.base.armorClass
-                 << ").";
-          hit = false;
-        }
-        g_combatLog.push_back({log_ss.str(), LogEntry::INFO});
-
-      } else if (!ability.savingThrowType.empty()) {
-        if (target.isPlayer) {
-          g_playerSaveState.isActive = true;
-          g_playerSaveState.targetIndex = target_idx;
-          g_playerSaveState.saveType = ability.savingThrowType;
-          g_playerSaveState.saveDC = ability.savingThrowDC;
-          g_playerSaveState.ability = &ability;
-          g_playerSaveState.spell = nullptr;
-          return;
-        } else {
-          int save_roll = rollDice("1d20");
-          int target_ability_score =
-              getAbilityScore(target, ability.savingThrowType);
-          int save_modifier = calculateModifier(target_ability_score);
-          int total_save = save_roll + save_modifier;
-
-          if (total_save >= ability.savingThrowDC) {
-            log_ss << target.displayName << " succeeds on a DC "
-                   << ability.savingThrowDC << " " << ability.savingThrowType
-                   << " saving throw (Roll: " << save_roll << " + "
-                   << save_modifier << " = " << total_save << ").";
-            hit = false;
-          } else {
-            log_ss << target.displayName << " fails on a DC "
-                   << ability.savingThrowDC << " " << ability.savingThrowType
-                   << " saving throw (Roll: " << save_roll << " + "
-                   << save_modifier << " = " << total_save << ").";
-            hit = true;
-          }
-          g_combatLog.push_back({log_ss.str(), LogEntry::INFO});
-        }
-      }
-
-      if (!ability.damageDice.empty()) {
-        log_ss.str("");
-        int damage_roll = rollDice(ability.damageDice);
-        int damage_modifier = 0;
-        if (!ability.damageModifierAbility.empty()) {
-          int attacker_ability_score =
-              getAbilityScore(activeCombatant, ability.damageModifierAbility);
-          damage_modifier = calculateModifier(attacker_ability_score);
-        }
-        int total_calculated_value = damage_roll + damage_modifier;
-        int final_value = total_calculated_value;
-
-        if (!hit && !ability.savingThrowType.empty()) {
-          final_value /= 2;
-          target.currentHitPoints -= final_value;
-          log_ss << target.displayName << " takes " << final_value << " "
-                 << ability.damageType << " damage (half on successful save).";
-          g_combatLog.push_back({log_ss.str(), LogEntry::DAMAGE});
-        } else if (hit) {
-          if (ability.damageType == "healing") {
-            target.currentHitPoints = std::min(
-                target.maxHitPoints, target.currentHitPoints + final_value);
-            log_ss << target.displayName << " heals for " << final_value
-                   << " hit points.";
-            g_combatLog.push_back({log_ss.str(), LogEntry::HEALING});
-          } else {
-            target.currentHitPoints -= final_value;
-            log_ss << target.displayName << " takes " << final_value << " "
-                   << ability.damageType << " damage.";
-            g_combatLog.push_back({log_ss.str(), LogEntry::DAMAGE});
-          }
-        }
-      }
-
-      std::regex condition_pattern(R"(\[APPLY_CONDITION:([^:]+)(?::(\d+))?\])");
-      std::smatch condition_matches;
-      if (std::regex_search(ability.description, condition_matches,
-                            condition_pattern)) {
-        log_ss.str("");
-        std::string condition_name = condition_matches[1].str();
-        int duration = 1;
-        if (condition_matches.size() > 2 && condition_matches[2].matched) {
-          duration = std::stoi(condition_matches[2].str());
-        }
-        target.activeConditions.push_back({condition_name, duration});
-        log_ss << target.displayName << " is now " << condition_name << " for "
-               << duration << " turn(s).";
-        g_combatLog.push_back({log_ss.str(), LogEntry::EVENT});
-      }
-    }
-  } else if (targetingState.spell) {
-    const Spell &spell = *targetingState.spell;
-
-    if (spell.level > 0) {
-      activeCombatant.spellSlots[spell.level - 1]--;
-    }
-
-    if (spell.actionType == ActionType::ACTION) {
-      activeCombatant.hasUsedAction = true;
-    } else if (spell.actionType == ActionType::BONUS_ACTION) {
-      activeCombatant.hasUsedBonusAction = true;
-    }
-
-    std::stringstream log_ss;
-    log_ss << activeCombatant.displayName << " casts " << spell.name << ".";
-    g_combatLog.push_back({log_ss.str(), LogEntry::INFO});
-
-    for (int target_idx : targetingState.selectedTargets) {
-      log_ss.str("");
-      Combatant &target = g_encounterList[target_idx];
-
-      bool hit = true;
-      if (!spell.attackRollType.empty()) {
-        int attack_roll = rollDice("1d20");
-        int attack_modifier = activeCombatant.spellAttackBonus;
-        int total_attack = attack_roll + attack_modifier;
-
-        if (total_attack >= target.base.armorClass) {
-          log_ss << activeCombatant.displayName << "'s " << spell.name
-                 << " hits " << target.displayName
-                 << " (Attack Roll: " << attack_roll << " + " << attack_modifier
-                 << " = " << total_attack << " vs AC " << target.base.armorClass
-                 << ").";
-          hit = true;
-        } else {
-          log_ss << activeCombatant.displayName << "'s " << spell.name
-                 << " misses " << target.displayName
-                 << " (Attack Roll: " << attack_roll << " + " << attack_modifier
-                 << " = " << total_attack << " vs AC " << target.base.armorClass
-                 << ").";
-          hit = false;
-        }
-        g_combatLog.push_back({log_ss.str(), LogEntry::INFO});
-
-      } else if (!spell.savingThrowType.empty()) {
-        if (target.isPlayer) {
-          g_playerSaveState.isActive = true;
-          g_playerSaveState.targetIndex = target_idx;
-          g_playerSaveState.saveType = spell.savingThrowType;
-          g_playerSaveState.saveDC = activeCombatant.spellSaveDC;
-          g_playerSaveState.ability = nullptr;
-          g_playerSaveState.spell = &spell;
-          return;
-        } else {
-          int save_roll = rollDice("1d20");
-          int target_ability_score =
-              getAbilityScore(target, spell.savingThrowType);
-          int save_modifier = calculateModifier(target_ability_score);
-          int total_save = save_roll + save_modifier;
-
-          if (total_save >= activeCombatant.spellSaveDC) {
-            log_ss << target.displayName << " succeeds on a DC "
-                   << activeCombatant.spellSaveDC << " "
-                   << spell.savingThrowType
-                   << " saving throw (Roll: " << save_roll << " + "
-                   << save_modifier << " = " << total_save << ").";
-            hit = false;
-          } else {
-            log_ss << target.displayName << " fails on a DC "
-                   << activeCombatant.spellSaveDC << " "
-                   << spell.savingThrowType
-                   << " saving throw (Roll: " << save_roll << " + "
-                   << save_modifier << " = " << total_save << ").";
-            hit = true;
-          }
-          g_combatLog.push_back({log_ss.str(), LogEntry::INFO});
-        }
-      }
-
-      if (!spell.damageDice.empty()) {
-        log_ss.str("");
-        int damage_roll = rollDice(spell.damageDice);
-        int damage_modifier = 0;
-        if (!spell.damageModifierAbility.empty()) {
-          int caster_ability_score =
-              getAbilityScore(activeCombatant, spell.damageModifierAbility);
-          damage_modifier = calculateModifier(caster_ability_score);
-        }
-        int total_calculated_value = damage_roll + damage_modifier;
-        int final_value = total_calculated_value;
-
-        if (!hit && !spell.savingThrowType.empty()) {
-          final_value /= 2;
-          target.currentHitPoints -= final_value;
-          log_ss << target.displayName << " takes " << final_value << " "
-                 << spell.damageType << " damage (half on successful save).";
-          g_combatLog.push_back({log_ss.str(), LogEntry::DAMAGE});
-        } else if (hit) {
-          if (spell.damageType == "healing") {
-            target.currentHitPoints = std::min(
-                target.maxHitPoints, target.currentHitPoints + final_value);
-            log_ss << target.displayName << " heals for " << final_value
-                   << " hit points.";
-            g_combatLog.push_back({log_ss.str(), LogEntry::HEALING});
-          } else {
-            target.currentHitPoints -= final_value;
-            log_ss << target.displayName << " takes " << final_value << " "
-                   << spell.damageType << " damage.";
-            g_combatLog.push_back({log_ss.str(), LogEntry::DAMAGE});
-          }
-        }
-      }
-
-      std::regex condition_pattern(R"(\[APPLY_CONDITION:([^:]+)(?::(\d+))?\])");
-      std::smatch condition_matches;
-      if (std::regex_search(spell.description, condition_matches,
-                            condition_pattern)) {
-        log_ss.str("");
-        std::string condition_name = condition_matches[1].str();
-        int duration = 1;
-        if (condition_matches.size() > 2 && condition_matches[2].matched) {
-          duration = std::stoi(condition_matches[2].str());
-        }
-        target.activeConditions.push_back({condition_name, duration});
-        log_ss << target.displayName << " is now " << condition_name << " for "
-               << duration << " turn(s).";
-        g_combatLog.push_back({log_ss.str(), LogEntry::EVENT});
-      }
-    }
-  }
-}
-
-ActionType stringToActionType(const std::string &str) {
-  std::string lower_str = str;
-  std::transform(lower_str.begin(), lower_str.end(), lower_str.begin(),
-                 [](unsigned char c) { return std::tolower(c); });
-
-  if (lower_str.find("bonus action") != std::string::npos) {
-    return ActionType::BONUS_ACTION;
-  }
-  if (lower_str.find("action") != std::string::npos) {
-    return ActionType::ACTION;
-  }
-  if (lower_str.find("reaction") != std::string::npos) {
-    return ActionType::REACTION;
-  }
-  if (lower_str.find("legendary") != std::string::npos) {
-    return ActionType::LEGENDARY;
-  }
-  if (lower_str.find("lair") != std::string::npos) {
-    return ActionType::LAIR;
-  }
-  return ActionType::NONE;
-}
-
-std::vector<Ability> getMonsterAbilities(int monsterId, SQLite::Database &db) {
-  std::vector<Ability> abilities;
-  try {
-    SQLite::Statement query(
-        db, "SELECT A.Name, A.Description, A.AbilityType, AU.UsageType, "
-            "AU.UsesMax, AU.RechargeValue, A.ActionType, A.TargetType, "
-            "A.AttackRollType, A.SavingThrowType, A.SavingThrowDC, "
-            "A.DamageDice, A.DamageType, A.DamageModifierAbility FROM "
-            "Abilities AS A LEFT JOIN Ability_Usage AS AU ON A.AbilityID = "
-            "AU.AbilityID WHERE A.MonsterID = ?");
-    query.bind(1, monsterId);
-
-    while (query.executeStep()) {
-      Ability ability;
-      ability.name = query.getColumn(0).getString();
-      ability.description = query.getColumn(1).getString();
-      ability.type = query.getColumn(2).getString();
-
-      if (!query.getColumn(3).isNull()) {
-        ability.usageType = query.getColumn(3).getString();
-        ability.usesMax = query.getColumn(4).getInt();
-        ability.rechargeValue = query.getColumn(5).getInt();
-      }
-
-      if (!query.getColumn(6).isNull()) {
-        ability.actionType = stringToActionType(query.getColumn(6).getString());
-      } else {
-        ability.actionType = ActionType::NONE;
-      }
-
-      ability.targetType = query.getColumn(7).getString();
-      ability.attackRollType = query.getColumn(8).getString();
-      ability.savingThrowType = query.getColumn(9).getString();
-      ability.savingThrowDC = query.getColumn(10).getInt();
-      ability.damageDice = query.getColumn(11).getString();
-      ability.damageType = query.getColumn(12).getString();
-      ability.damageModifierAbility = query.getColumn(13).getString();
-
-      abilities.push_back(ability);
-    }
-  } catch (const std::exception &e) {
-    std::cerr << "SQLite error in getMonsterAbilities: " << e.what()
-              << std::endl;
-  }
-  return abilities;
-}
-
 void renderPlayerSaveUI() {
   if (!g_playerSaveState.isActive) {
     return;
   }
 
-  ImGui::Begin("Player Saving Throw", &g_playerSaveState.isActive);
-
-  Combatant &target = g_encounterList[g_playerSaveState.targetIndex];
-  const char *actionName = "";
-  const std::string *description_ptr = nullptr;
-
-  if (g_playerSaveState.ability) {
-    actionName = g_playerSaveState.ability->name.c_str();
-    description_ptr = &g_playerSaveState.ability->description;
-  } else if (g_playerSaveState.spell) {
-    actionName = g_playerSaveState.spell->name.c_str();
-    description_ptr = &g_playerSaveState.spell->description;
+  // Only events change the prompt, so that history replays it exactly;
+  // removeCombatant() drops players who leave while theirs is queued.
+  const Combatant *target = g_combatants.resolve(
+      g_encounterList, g_playerSaveState.targets.front());
+  const Combatant *attacker =
+      g_combatants.resolve(g_encounterList, g_playerSaveState.action.owner);
+  ActionDef action;
+  if (!target || !attacker ||
+      !makeActionDef(*attacker, g_playerSaveState.action, action)) {
+    return;
   }
 
-  ImGui::Text("%s must make a %s saving throw vs DC %d for %s.",
-              target.displayName.c_str(), g_playerSaveState.saveType.c_str(),
-              g_playerSaveState.saveDC, actionName);
-  ImGui::Separator();
-
-  if (ImGui::Button("Success")) {
-    std::stringstream log_ss;
-
-    const std::string *damageDice = g_playerSaveState.ability
-                                        ? &g_playerSaveState.ability->damageDice
-                                        : &g_playerSaveState.spell->damageDice;
-    const std::string *damageType = g_playerSaveState.ability
-                                        ? &g_playerSaveState.ability->damageType
-                                        : &g_playerSaveState.spell->damageType;
-    const std::string *damageModifierAbility =
-        g_playerSaveState.ability
-            ? &g_playerSaveState.ability->damageModifierAbility
-            : &g_playerSaveState.spell->damageModifierAbility;
-
-    if (!damageDice->empty()) {
-      int damage_roll = rollDice(*damageDice);
-      int damage_modifier = 0;
-      if (!damageModifierAbility->empty()) {
-        int attacker_ability_score = getAbilityScore(
-            g_encounterList[g_currentTurnIndex], *damageModifierAbility);
-        damage_modifier = calculateModifier(attacker_ability_score);
-      }
-      int full_damage_value = damage_roll + damage_modifier;
-      int total_damage = full_damage_value / 2;
-
-      if (*damageType == "healing") {
-        target.currentHitPoints = std::min(
-            target.maxHitPoints, target.currentHitPoints + total_damage);
-        log_ss << target.displayName << " successfully saves against "
-               << actionName << ", healing for " << total_damage
-               << " hit points (half effect).";
-        g_combatLog.push_back({log_ss.str(), LogEntry::HEALING});
-      } else {
-        target.currentHitPoints -= total_damage;
-        log_ss << target.displayName << " resists the " << actionName
-               << ", taking only " << total_damage << " " << *damageType
-               << " damage instead of the full " << full_damage_value << ".";
-        g_combatLog.push_back({log_ss.str(), LogEntry::DAMAGE});
-      }
-    } else {
-      log_ss << target.displayName << " successfully saves against "
-             << actionName << ".";
-      g_combatLog.push_back({log_ss.str(), LogEntry::INFO});
-    }
+  bool open = true;
+  ImGui::Begin("Player Saving Throw", &open);
 
-    g_playerSaveState.isActive = false;
-  }
+  ImGui::Text("%s must make a %.*s saving throw vs DC %d for %.*s.",
+              target->displayName.c_str(),
+              static_cast<int>(action.saveName.size()),
+              action.saveName.data(), action.saveDC,
+              static_cast<int>(action.name.size()), action.name.data());
+  ImGui::Separator();
 
+  bool saved = ImGui::Button("Success");
   ImGui::SameLine();
-
-  if (ImGui::Button("Failure")) {
-    std::stringstream log_ss;
-
-    const std::string *damageDice = g_playerSaveState.ability
-                                        ? &g_playerSaveState.ability->damageDice
-                                        : &g_playerSaveState.spell->damageDice;
-    const std::string *damageType = g_playerSaveState.ability
-                                        ? &g_playerSaveState.ability->damageType
-                                        : &g_playerSaveState.spell->damageType;
-    const std::string *damageModifierAbility =
-        g_playerSaveState.ability
-            ? &g_playerSaveState.ability->damageModifierAbility
-            : &g_playerSaveState.spell->damageModifierAbility;
-
-    if (!damageDice->empty()) {
-      int damage_roll = rollDice(*damageDice);
-      int damage_modifier = 0;
-      if (!damageModifierAbility->empty()) {
-        int attacker_ability_score = getAbilityScore(
-            g_encounterList[g_currentTurnIndex], *damageModifierAbility);
-        damage_modifier = calculateModifier(attacker_ability_score);
-      }
-      int total_damage = damage_roll + damage_modifier;
-
-      if (*damageType == "healing") {
-        target.currentHitPoints = std::min(
-            target.maxHitPoints, target.currentHitPoints + total_damage);
-        log_ss << target.displayName << " fails to save against " << actionName
-               << ", healing for " << total_damage << " hit points.";
-        g_combatLog.push_back({log_ss.str(), LogEntry::HEALING});
-      } else {
-        target.currentHitPoints -= total_damage;
-        log_ss << target.displayName << " fails to save against " << actionName
-               << ", taking " << total_damage << " " << *damageType
-               << " damage.";
-        g_combatLog.push_back({log_ss.str(), LogEntry::DAMAGE});
-      }
-    } else {
-      log_ss << target.displayName << " fails to save against " << actionName
-             << ".";
-      g_combatLog.push_back({log_ss.str(), LogEntry::INFO});
-    }
-
-    if (description_ptr) {
-      std::regex condition_pattern(R"(\[APPLY_CONDITION:([^:]+)(?::(\d+))?\])");
-      std::smatch condition_matches;
-      if (std::regex_search(*description_ptr, condition_matches,
-                            condition_pattern)) {
-        log_ss.str("");
-        std::string condition_name = condition_matches[1].str();
-        int duration = 1;
-        if (condition_matches.size() > 2 && condition_matches[2].matched) {
-          duration = std::stoi(condition_matches[2].str());
-        }
-        target.activeConditions.push_back({condition_name, duration});
-        log_ss << target.displayName << " is now " << condition_name << " for "
-               << duration << " turn(s).";
-        g_combatLog.push_back({log_ss.str(), LogEntry::EVENT});
-      }
-    }
-
-    g_playerSaveState.isActive = false;
+  bool failed = ImGui::Button("Failure");
+  if (saved || failed) {
+    EncounterEvent event(EncounterEvent::PLAYER_SAVE, target->handle, saved);
+    event.action = g_playerSaveState.action;
+    record(event);
+  } else if (!open) {
+    record(EncounterEvent(EncounterEvent::DISMISS_SAVES));
   }
 
   ImGui::End();
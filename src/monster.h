@@ -1,8 +1,15 @@
 #pragma once
 
-#include <map>
-#include <memory> // For std::unique_ptr
+#include "action_tags.h"
+#include "conditions.h"
+#include "dice.h"
+#include "handles.h"
+#include "rng.h"
+#include <array>
+#include <cstdint>
+#include <memory> // For std::shared_ptr
 #include <string>
+#include <string_view>
 #include <vector>
 
 // An enum for clarity and to prevent trivial errors
@@ -14,8 +21,55 @@ enum class TriggerCondition {
   ON_SAVE_SUCCESS,
   ON_SAVE_FAIL
 };
+enum class AbilityScore : uint8_t {
+  NONE,
+  STRENGTH,
+  DEXTERITY,
+  CONSTITUTION,
+  INTELLIGENCE,
+  WISDOM,
+  CHARISMA
+};
+// Interned from the DamageTypes names when loaded. HEALING is the
+// pseudo-type healing abilities and spells use.
+enum class DamageType : uint8_t {
+  NONE,
+  ACID,
+  BLUDGEONING,
+  COLD,
+  FIRE,
+  FORCE,
+  LIGHTNING,
+  NECROTIC,
+  PIERCING,
+  POISON,
+  PSYCHIC,
+  RADIANT,
+  SLASHING,
+  THUNDER,
+  HEALING
+};
+
+// Bit (1 << DamageType) per damage type.
+using DamageTypeMask = uint16_t;
+
+struct DamageDefenses {
+  DamageTypeMask immune = 0;
+  DamageTypeMask resistant = 0;
+  DamageTypeMask vulnerable = 0;
+
+  bool operator==(const DamageDefenses &other) const {
+    return immune == other.immune && resistant == other.resistant &&
+           vulnerable == other.vulnerable;
+  }
+  bool operator!=(const DamageDefenses &other) const {
+    return !(*this == other);
+  }
+};
 
 // --- The Core of the New Engine: The Effect Tree ---
+// Effects are authored as a nested tree and stored flattened in the owning
+// Monster's EffectArena, which is what resolution walks.
 struct Effect {
   // --- Core Mechanics ---
   std::string description;
@@ -29,53 +83,81 @@ struct Effect {
 
   // --- Chaining Logic ---
   TriggerCondition trigger = TriggerCondition::ALWAYS;
-  std::vector<std::unique_ptr<Effect>> childEffects;
-
-  // --- Rule of Five for correct resource management of unique_ptr ---
-  Effect() = default;
-
-  // 1. Copy Constructor (for deep copying the effect tree)
-  Effect(const Effect &other)
-      : description(other.description), attackRollType(other.attackRollType),
-        savingThrowType(other.savingThrowType),
-        savingThrowDC(other.savingThrowDC), damageDice(other.damageDice),
-        damageType(other.damageType),
-        damageModifierAbility(other.damageModifierAbility),
-        conditionToApply(other.conditionToApply), trigger(other.trigger) {
-    childEffects.reserve(other.childEffects.size());
-    for (const auto &child : other.childEffects) {
-      childEffects.push_back(std::make_unique<Effect>(*child));
-    }
+  std::vector<Effect> childEffects;
+};
+
+// Text held in an EffectArena.
+struct EffectText {
+  uint32_t offset = 0;
+  uint32_t length = 0;
+};
+
+// Consecutive nodes of an EffectArena: the roots of one ability or spell, or
+// the children of one node.
+struct EffectRange {
+  uint32_t first = 0;
+  uint32_t count = 0;
+
+  bool empty() const { return count == 0; }
+};
+
+// One flattened Effect. Trivially copyable, with names already looked up and
+// dice already compiled; the text is kept for the log and the snapshot.
+struct EffectNode {
+  TriggerCondition trigger = TriggerCondition::ALWAYS;
+  bool attack = false;  // Rolls d20 + modifier against AC
+  bool save = false;    // The target saves against savingThrowDC
+  bool damages = false; // Has damage dice, even if they failed to parse
+  DamageType damageKind = DamageType::NONE;
+  Condition condition = Condition::NONE; // Interned from conditionToApply
+  AbilityScore saveAbility = AbilityScore::NONE;
+  AbilityScore modifierAbility = AbilityScore::NONE; // Attack and damage
+  int32_t savingThrowDC = 0;
+  DiceExpr damage; // Before the modifier
+  EffectRange children;
+
+  EffectText description;
+  EffectText attackRollType;
+  EffectText savingThrowType;
+  EffectText damageDice;
+  EffectText damageType;
+  EffectText damageModifierAbility;
+  EffectText conditionToApply;
+};
+
+// Every effect node of one Monster in a single array, children of a node
+// stored next to each other, plus one buffer for all their text. Copying a
+// Monster copies two flat buffers instead of a tree of allocations.
+class EffectArena {
+public:
+  // Flattens `roots` and everything below them; returns where the roots
+  // went.
+  EffectRange append(const std::vector<Effect> &roots);
+
+  const EffectNode &operator[](uint32_t index) const { return m_nodes[index]; }
+  std::string_view text(EffectText text) const {
+    return std::string_view(m_text).substr(text.offset, text.length);
+  }
+  size_t size() const { return m_nodes.size(); }
+  size_t bytes() const {
+    return m_nodes.capacity() * sizeof(EffectNode) + m_text.capacity();
   }
 
-  // 2. Copy Assignment Operator
-  Effect &operator=(const Effect &other) {
-    if (this != &other) {
-      description = other.description;
-      attackRollType = other.attackRollType;
-      savingThrowType = other.savingThrowType;
-      savingThrowDC = other.savingThrowDC;
-      damageDice = other.damageDice;
-      damageType = other.damageType;
-      damageModifierAbility = other.damageModifierAbility;
-      conditionToApply = other.conditionToApply;
-      trigger = other.trigger;
-
-      childEffects.clear();
-      childEffects.reserve(other.childEffects.size());
-      for (const auto &child : other.childEffects) {
-        childEffects.push_back(std::make_unique<Effect>(*child));
-      }
-    }
-    return *this;
+  // The two buffers as they are, for the bestiary snapshot to store and
+  // copy back with assign().
+  const EffectNode *data() const { return m_nodes.data(); }
+  std::string_view allText() const { return m_text; }
+  void assign(const EffectNode *nodes, size_t count, std::string_view text) {
+    m_nodes.assign(nodes, nodes + count);
+    m_text.assign(text);
   }
 
-  // 3. Move Constructor (efficiently transfers ownership)
-  Effect(Effect &&other) noexcept = default;
-  // 4. Move Assignment Operator
-  Effect &operator=(Effect &&other) noexcept = default;
-  // 5. Destructor (implicitly handled by unique_ptr)
-  ~Effect() = default;
+private:
+  EffectText store(const std::string &text);
+  void fill(uint32_t index, const Effect &effect);
+
+  std::vector<EffectNode> m_nodes;
+  std::string m_text;
 };
 
 struct Ability {
@@ -86,44 +168,19 @@ struct Ability {
   std::string usageType;
   int usesMax = 0;
   int rechargeValue = 0;
-  std::vector<std::unique_ptr<Effect>> rootEffects;
-
-  // --- Rule of Five for correct copying of abilities ---
-  Ability() = default;
-
-  Ability(const Ability &other)
-      : name(other.name), description(other.description),
-        actionType(other.actionType), type(other.type),
-        usageType(other.usageType), usesMax(other.usesMax),
-        rechargeValue(other.rechargeValue) {
-    rootEffects.reserve(other.rootEffects.size());
-    for (const auto &effect : other.rootEffects) {
-      rootEffects.push_back(std::make_unique<Effect>(*effect));
-    }
-  }
-
-  Ability &operator=(const Ability &other) {
-    if (this != &other) {
-      name = other.name;
-      description = other.description;
-      actionType = other.actionType;
-      type = other.type;
-      usageType = other.usageType;
-      usesMax = other.usesMax;
-      rechargeValue = other.rechargeValue;
-
-      rootEffects.clear();
-      rootEffects.reserve(other.rootEffects.size());
-      for (const auto &effect : other.rootEffects) {
-        rootEffects.push_back(std::make_unique<Effect>(*effect));
-      }
-    }
-    return *this;
-  }
-
-  Ability(Ability &&other) noexcept = default;
-  Ability &operator=(Ability &&other) noexcept = default;
-  ~Ability() = default;
+  int resource = -1; // In Resources::values if limited, assigned when loaded
+  int legendaryCost = 0; // Legendary actions it takes, if one
+  std::string targetType;
+  std::string attackRollType;
+  std::string savingThrowType;
+  int savingThrowDC = 0;
+  std::string damageDice;
+  DiceExpr damage; // Compiled from damageDice when loaded
+  std::string damageType;
+  DamageType damageKind = DamageType::NONE; // Interned from damageType
+  std::string damageModifierAbility;
+  ActionTags tags;         // Parsed from description when loaded
+  EffectRange rootEffects; // In the owning Monster's effects
 };
 
 struct Spell {
@@ -131,39 +188,32 @@ struct Spell {
   std::string description;
   int level;
   ActionType actionType = ActionType::NONE;
-  std::vector<std::unique_ptr<Effect>> rootEffects;
-
-  // --- Rule of Five for correct copying of spells ---
-  Spell() = default;
-
-  Spell(const Spell &other)
-      : name(other.name), description(other.description), level(other.level),
-        actionType(other.actionType) {
-    rootEffects.reserve(other.rootEffects.size());
-    for (const auto &effect : other.rootEffects) {
-      rootEffects.push_back(std::make_unique<Effect>(*effect));
-    }
-  }
+  std::string attackRollType;
+  std::string savingThrowType;
+  int savingThrowDC = 0;
+  std::string damageDice;
+  DiceExpr damage; // Compiled from damageDice when loaded
+  std::string damageType;
+  DamageType damageKind = DamageType::NONE; // Interned from damageType
+  std::string damageModifierAbility;
+  ActionTags tags;         // Parsed from description when loaded
+  EffectRange rootEffects; // In the owning Monster's effects
+};
 
-  Spell &operator=(const Spell &other) {
-    if (this != &other) {
-      name = other.name;
-      description = other.description;
-      level = other.level;
-      actionType = other.actionType;
-
-      rootEffects.clear();
-      rootEffects.reserve(other.rootEffects.size());
-      for (const auto &effect : other.rootEffects) {
-        rootEffects.push_back(std::make_unique<Effect>(*effect));
-      }
-    }
-    return *this;
-  }
+// --- Combat Resources ---
+// Everything a combatant spends and gets back on a rest, in one fixed-size
+// array: spell slots for levels 1 through 9, then an entry for each limited
+// ability holding its uses left, or 1 while a recharge ability is charged.
+// Abilities are given their entry when the monster is loaded, so checking or
+// spending one is an index and a rest is a single copy of the maximums.
+struct Resources {
+  static constexpr int kSpellLevels = 9;
+  static constexpr int kCapacity = 32;
 
-  Spell(Spell &&other) noexcept = default;
-  Spell &operator=(Spell &&other) noexcept = default;
-  ~Spell() = default;
+  std::array<int, kCapacity> values{};
+
+  int &spellSlots(int level) { return values[level - 1]; } // 1 through 9
+  int spellSlots(int level) const { return values[level - 1]; }
 };
 
 struct Monster {
@@ -194,12 +244,29 @@ struct Monster {
   std::vector<std::string> damageImmunities;
   std::vector<std::string> damageResistances;
   std::vector<std::string> damageVulnerabilities;
+  DamageDefenses damageDefenses; // The three lists above, interned
   std::vector<Ability> abilities;
   std::vector<Spell> spells;
+  std::vector<int> spellSlots; // Slots per spell level, 1 through 9
+  Resources maxResources;      // The slots and limited abilities' uses
+  int legendaryActions = 0;    // Taken per round, if it has any
+  bool lairActions = false;    // Has actions for initiative count 20
+  EffectArena effects; // Every ability's and spell's effect tree
 };
 
+// An all-zero Monster for combatants with no stat block (players).
+inline const std::shared_ptr<const Monster> &blankMonster() {
+  static const std::shared_ptr<const Monster> blank =
+      std::make_shared<const Monster>();
+  return blank;
+}
+
 struct Combatant {
-  Monster base;
+  // Immutable and shared by every combatant of the same kind, so twenty
+  // goblins hold one Goblin. Everything that changes in play lives below.
+  std::shared_ptr<const Monster> base = blankMonster();
+  CombatantHandle handle; // Issued when the combatant joins the encounter
+  RngStream rng;          // Derived from the encounter seed on joining
   std::string displayName;
   int initiative = 0;
   int currentHitPoints = 0;
@@ -207,23 +274,24 @@ struct Combatant {
   bool isPlayer = false;
   int spellSaveDC = 0;
   int spellAttackBonus = 0;
-  std::map<std::string, int> abilityUses;
-  std::vector<int> spellSlots;
-  std::vector<int> maxSpellSlots;
+  DamageDefenses damageDefenses; // Starts as the Monster's
+  Resources resources;           // Starts as the Monster's maxResources
+  int legendaryActions = 0;      // Left until the start of its next turn
+  bool lairActionReady = false;  // Count 20 has passed and it has not acted
   bool hasUsedAction = false;
   bool hasUsedBonusAction = false;
-  std::vector<std::pair<std::string, int>> activeConditions;
+  ConditionSet conditions; // Scheduled to expire by the ConditionWheel
 
   Combatant() = default;
-  explicit Combatant(const Monster &monster)
-      : base(monster), displayName(monster.name),
-        currentHitPoints(monster.hitPoints), maxHitPoints(monster.hitPoints),
-        spellSaveDC(monster.spellSaveDC),
-        spellAttackBonus(monster.spellAttackBonus) {
-    for (const auto &ability : base.abilities) {
-      if (ability.usesMax > 0) {
-        abilityUses[ability.name] = ability.usesMax;
-      }
-    }
-  }
-};
\ No newline at end of file
+  explicit Combatant(std::shared_ptr<const Monster> monster)
+      : base(std::move(monster)), displayName(base->name),
+        currentHitPoints(base->hitPoints), maxHitPoints(base->hitPoints),
+        spellSaveDC(base->spellSaveDC),
+        spellAttackBonus(base->spellAttackBonus),
+        damageDefenses(base->damageDefenses),
+        resources(base->maxResources),
+        legendaryActions(base->legendaryActions) {}
+
+  // A long rest: every use, recharge and spell slot back to its maximum.
+  void restoreResources() { resources = base->maxResources; }
+};
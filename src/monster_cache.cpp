@@ -0,0 +1,118 @@
+#include "monster_cache.h"
+
+std::shared_ptr<const Monster> MonsterCache::find(const std::string &name) {
+  auto it = m_index.find(name);
+  if (it == m_index.end()) {
+    m_stats.misses++;
+    return nullptr;
+  }
+  m_stats.hits++;
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->monster;
+}
+
+void MonsterCache::insert(const std::string &name,
+                          std::shared_ptr<const Monster> monster) {
+  size_t bytes = approximateMonsterBytes(*monster);
+  auto it = m_index.find(name);
+  if (it != m_index.end()) {
+    m_bytes -= it->second->bytes;
+    it->second->monster = std::move(monster);
+    it->second->bytes = bytes;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+  } else {
+    m_entries.push_front({name, std::move(monster), bytes});
+    m_index.emplace(name, m_entries.begin());
+  }
+  m_bytes += bytes;
+  evictOverflow();
+}
+
+void MonsterCache::evictOverflow() {
+  while (m_entries.size() > 1 &&
+         (m_entries.size() > m_maxEntries || m_bytes > m_maxBytes)) {
+    const Entry &coldest = m_entries.back();
+    m_bytes -= coldest.bytes;
+    m_index.erase(coldest.name);
+    m_entries.pop_back();
+    m_stats.evictions++;
+  }
+}
+
+void MonsterCache::clear() {
+  m_entries.clear();
+  m_index.clear();
+  m_bytes = 0;
+}
+
+MonsterCacheStats MonsterCache::stats() const {
+  MonsterCacheStats stats = m_stats;
+  stats.entries = m_entries.size();
+  stats.bytes = m_bytes;
+  return stats;
+}
+
+// --- Footprint Estimate ---
+
+static size_t stringBytes(const std::string &s) {
+  // Short strings live inside the object and cost nothing extra.
+  const char *inlineBegin = reinterpret_cast<const char *>(&s);
+  bool onHeap = s.data() < inlineBegin ||
+                 s.data() >= inlineBegin + sizeof(std::string);
+  return onHeap ? s.capacity() + 1 : 0;
+}
+
+static size_t stringListBytes(const std::vector<std::string> &list) {
+  size_t bytes = list.capacity() * sizeof(std::string);
+  for (const auto &s : list) {
+    bytes += stringBytes(s);
+  }
+  return bytes;
+}
+
+static size_t tagsBytes(const ActionTags &tags) {
+  return tags.conditions.capacity() * sizeof(ConditionTag);
+}
+
+size_t approximateMonsterBytes(const Monster &monster) {
+  size_t bytes = sizeof(Monster) + stringBytes(monster.name) +
+                 stringBytes(monster.size) + stringBytes(monster.type) +
+                 stringBytes(monster.alignment) +
+                 stringBytes(monster.hitDice) +
+                 stringBytes(monster.challengeRating) +
+                 stringBytes(monster.languages);
+  bytes += stringListBytes(monster.speeds) + stringListBytes(monster.skills) +
+           stringListBytes(monster.savingThrows) +
+           stringListBytes(monster.senses) +
+           stringListBytes(monster.conditionImmunities) +
+           stringListBytes(monster.damageImmunities) +
+           stringListBytes(monster.damageResistances) +
+           stringListBytes(monster.damageVulnerabilities);
+
+  bytes += monster.abilities.capacity() * sizeof(Ability);
+  for (const auto &ability : monster.abilities) {
+    bytes += stringBytes(ability.name) + stringBytes(ability.description) +
+             stringBytes(ability.type) + stringBytes(ability.usageType) +
+             stringBytes(ability.targetType) +
+             stringBytes(ability.attackRollType) +
+             stringBytes(ability.savingThrowType) +
+             stringBytes(ability.damageDice) +
+             stringBytes(ability.damageType) +
+             stringBytes(ability.damageModifierAbility) +
+             tagsBytes(ability.tags);
+  }
+
+  bytes += monster.spells.capacity() * sizeof(Spell);
+  for (const auto &spell : monster.spells) {
+    bytes += stringBytes(spell.name) + stringBytes(spell.description) +
+             stringBytes(spell.attackRollType) +
+             stringBytes(spell.savingThrowType) +
+             stringBytes(spell.damageDice) + stringBytes(spell.damageType) +
+             stringBytes(spell.damageModifierAbility) +
+             tagsBytes(spell.tags);
+  }
+
+  bytes += monster.spellSlots.capacity() * sizeof(int);
+  bytes += monster.effects.bytes();
+  return bytes;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "monster.h"
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Counters for tuning the cache limits against real prep sessions.
+struct MonsterCacheStats {
+  size_t hits = 0;      // Lookups answered without hydrating
+  size_t misses = 0;    // Lookups that had to go to the loader
+  size_t evictions = 0; // Entries dropped to stay within the limits
+  size_t entries = 0;
+  size_t bytes = 0; // Approximate heap footprint of the cached monsters
+};
+
+// --- Hydrated Monster Cache ---
+// A least-recently-used map from monster name to one immutable, shared copy
+// of the hydrated Monster. The stat block, the Bestiary and every Combatant
+// built from a hit hold the same object, so evicting an entry only drops the
+// cache's reference. Bounded both by entry count and by approximate bytes;
+// the most recent entry is always kept even if it alone exceeds the budget.
+// Not synchronized: the owner serializes access.
+class MonsterCache {
+public:
+  MonsterCache(size_t maxEntries, size_t maxBytes)
+      : m_maxEntries(maxEntries), m_maxBytes(maxBytes) {}
+
+  // Returns nullptr on a miss. A hit becomes the most recently used entry.
+  std::shared_ptr<const Monster> find(const std::string &name);
+  // Adds or refreshes `name`, then evicts from the cold end while over limit.
+  void insert(const std::string &name, std::shared_ptr<const Monster> monster);
+  void clear();
+
+  MonsterCacheStats stats() const;
+
+private:
+  struct Entry {
+    std::string name;
+    std::shared_ptr<const Monster> monster;
+    size_t bytes;
+  };
+
+  void evictOverflow();
+
+  size_t m_maxEntries;
+  size_t m_maxBytes;
+  size_t m_bytes = 0;
+  std::list<Entry> m_entries; // Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+  MonsterCacheStats m_stats;
+};
+
+// Rough heap cost of a Monster: its own size plus every string, list and
+// effect tree it owns. Good enough to budget a cache, not an exact count.
+size_t approximateMonsterBytes(const Monster &monster);
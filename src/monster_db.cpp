@@ -0,0 +1,590 @@
+#include "monster_db.h"
+#include "rules.h"
+#include <algorithm> // For std::transform
+#include <cctype>    // For ::tolower
+#include <iostream>
+#include <sstream>
+
+// --- Per-Monster Queries ---
+// Every lookup except the first is keyed on MonsterID. They live here rather
+// than inline so perMonsterQueries() can hand them to the query plan check.
+
+static const char *const kMonsterIdByNameSql =
+    "SELECT MonsterID FROM Monsters WHERE Name = ?";
+static const char *const kMonsterByIdSql =
+    "SELECT Name, Size, Type, Alignment, ArmorClass, HitPoints_Avg, "
+    "HitPoints_Formula, Strength, Dexterity, Constitution, Intelligence, "
+    "Wisdom, Charisma, ChallengeRating, Languages, SpellSaveDC, "
+    "SpellAttackBonus FROM Monsters WHERE MonsterID = ?";
+static const char *const kSpeedsSql =
+    "SELECT SpeedType, Value FROM Monster_Speeds WHERE MonsterID = ?";
+static const char *const kSkillsSql =
+    "SELECT Name, Value FROM Skills INNER JOIN Monster_Skills ON "
+    "Skills.SkillID = Monster_Skills.SkillID WHERE "
+    "Monster_Skills.MonsterID = ?";
+static const char *const kSavingThrowsSql =
+    "SELECT Name, Value FROM SavingThrows INNER JOIN Monster_SavingThrows ON "
+    "SavingThrows.SavingThrowID = Monster_SavingThrows.SavingThrowID WHERE "
+    "Monster_SavingThrows.MonsterID = ?";
+static const char *const kSensesSql =
+    "SELECT Name, Value FROM Senses INNER JOIN Monster_Senses ON "
+    "Senses.SenseID = Monster_Senses.SenseID WHERE "
+    "Monster_Senses.MonsterID = ?";
+static const char *const kConditionImmunitiesSql =
+    "SELECT Name FROM Conditions INNER JOIN Monster_ConditionImmunities ON "
+    "Conditions.ConditionID = Monster_ConditionImmunities.ConditionID WHERE "
+    "Monster_ConditionImmunities.MonsterID = ?";
+static const char *const kDamageImmunitiesSql =
+    "SELECT Name FROM DamageTypes INNER JOIN Monster_DamageImmunities ON "
+    "DamageTypes.DamageTypeID = Monster_DamageImmunities.DamageTypeID WHERE "
+    "Monster_DamageImmunities.MonsterID = ?";
+static const char *const kDamageResistancesSql =
+    "SELECT Name FROM DamageTypes INNER JOIN Monster_DamageResistances ON "
+    "DamageTypes.DamageTypeID = Monster_DamageResistances.DamageTypeID WHERE "
+    "Monster_DamageResistances.MonsterID = ?";
+static const char *const kDamageVulnerabilitiesSql =
+    "SELECT Name FROM DamageTypes INNER JOIN Monster_DamageVulnerabilities ON "
+    "DamageTypes.DamageTypeID = Monster_DamageVulnerabilities.DamageTypeID "
+    "WHERE Monster_DamageVulnerabilities.MonsterID = ?";
+static const char *const kAbilitiesSql =
+    "SELECT A.Name, A.Description, A.AbilityType, AU.UsageType, AU.UsesMax, "
+    "AU.RechargeValue, A.ActionType, A.TargetType, A.AttackRollType, "
+    "A.SavingThrowType, A.SavingThrowDC, A.DamageDice, A.DamageType, "
+    "A.DamageModifierAbility FROM Abilities AS A LEFT JOIN Ability_Usage AS "
+    "AU ON A.AbilityID = AU.AbilityID WHERE A.MonsterID = ?";
+static const char *const kSpellsSql =
+    "SELECT S.Name, S.Level, S.CastingTime, S.Description, S.SavingThrowType, "
+    "S.SavingThrowDC, S.DamageDice, S.DamageType, S.DamageModifierAbility "
+    "FROM Spells AS S INNER JOIN Monster_Spells AS MS ON S.SpellID = "
+    "MS.SpellID WHERE MS.MonsterID = ? ORDER BY S.Level, S.Name";
+static const char *const kSpellSlotsSql =
+    "SELECT SpellLevel, Slots FROM Monster_SpellSlots WHERE MonsterID = ?";
+
+// --- Row Readers ---
+// Shared by the per-monster queries and the bulk catalog scans so both paths
+// hydrate identical structs. `column` is the index of the first mapped column.
+
+static void readMonsterRow(SQLite::Statement &query, int column,
+                           Monster &monster) {
+  monster.name = query.getColumn(column + 0).getString();
+  monster.size = query.getColumn(column + 1).getString();
+  monster.type = query.getColumn(column + 2).getString();
+  monster.alignment = query.getColumn(column + 3).getString();
+  monster.armorClass = query.getColumn(column + 4).getInt();
+  monster.hitPoints = query.getColumn(column + 5).getInt();
+  monster.hitDice = query.getColumn(column + 6).getString();
+  monster.strength = query.getColumn(column + 7).getInt();
+  monster.dexterity = query.getColumn(column + 8).getInt();
+  monster.constitution = query.getColumn(column + 9).getInt();
+  monster.intelligence = query.getColumn(column + 10).getInt();
+  monster.wisdom = query.getColumn(column + 11).getInt();
+  monster.charisma = query.getColumn(column + 12).getInt();
+  monster.challengeRating = query.getColumn(column + 13).getString();
+  monster.languages = query.getColumn(column + 14).getString();
+  monster.spellSaveDC = query.getColumn(column + 15).getInt();
+  monster.spellAttackBonus = query.getColumn(column + 16).getInt();
+}
+
+static Ability readAbilityRow(SQLite::Statement &query, int column) {
+  Ability ability;
+  ability.name = query.getColumn(column + 0).getString();
+  ability.description = query.getColumn(column + 1).getString();
+  ability.type = query.getColumn(column + 2).getString();
+
+  if (!query.getColumn(column + 3).isNull()) {
+    ability.usageType = query.getColumn(column + 3).getString();
+    ability.usesMax = query.getColumn(column + 4).getInt();
+    ability.rechargeValue = query.getColumn(column + 5).getInt();
+  }
+
+  if (!query.getColumn(column + 6).isNull()) {
+    ability.actionType =
+        stringToActionType(query.getColumn(column + 6).getString());
+  } else {
+    ability.actionType = ActionType::NONE;
+  }
+
+  ability.targetType = query.getColumn(column + 7).getString();
+  ability.attackRollType = query.getColumn(column + 8).getString();
+  ability.savingThrowType = query.getColumn(column + 9).getString();
+  ability.savingThrowDC = query.getColumn(column + 10).getInt();
+  ability.damageDice = query.getColumn(column + 11).getString();
+  ability.damage = compileDice(ability.damageDice);
+  ability.damageType = query.getColumn(column + 12).getString();
+  ability.damageKind = damageTypeFromName(ability.damageType);
+  ability.damageModifierAbility = query.getColumn(column + 13).getString();
+  ability.tags = parseActionTags(ability.description);
+  return ability;
+}
+
+static Spell readSpellRow(SQLite::Statement &query, int column) {
+  Spell spell;
+  spell.name = query.getColumn(column + 0).getString();
+  spell.level = query.getColumn(column + 1).getInt();
+  spell.actionType =
+      stringToActionType(query.getColumn(column + 2).getString());
+  spell.description = query.getColumn(column + 3).getString();
+  spell.savingThrowType = query.getColumn(column + 4).getString();
+  spell.savingThrowDC = query.getColumn(column + 5).getInt();
+  spell.damageDice = query.getColumn(column + 6).getString();
+  spell.damage = compileDice(spell.damageDice);
+  spell.damageType = query.getColumn(column + 7).getString();
+  spell.damageKind = damageTypeFromName(spell.damageType);
+  spell.damageModifierAbility = query.getColumn(column + 8).getString();
+  spell.tags = parseActionTags(spell.description);
+  return spell;
+}
+
+// --- Per-Monster Loader ---
+
+std::vector<std::string> getMonsterNames(SQLite::Database &db) {
+  std::vector<std::string> monsterNames;
+  try {
+    SQLite::Statement query(db, "SELECT Name FROM Monsters ORDER BY Name ASC");
+    while (query.executeStep()) {
+      monsterNames.push_back(query.getColumn(0).getString());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterNames: " << e.what() << std::endl;
+  }
+  return monsterNames;
+}
+
+std::vector<int> getMonsterSpellSlots(int monsterId,
+                                      StatementCache &statements) {
+  std::vector<int> spellSlots(9, 0);
+  try {
+    SQLite::Statement &query = statements.acquire(kSpellSlotsSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      int level = query.getColumn(0).getInt();
+      int slots = query.getColumn(1).getInt();
+      if (level >= 1 && level <= 9) {
+        spellSlots[level - 1] = slots;
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterSpellSlots: " << e.what()
+              << std::endl;
+  }
+  return spellSlots;
+}
+
+std::vector<Spell> getMonsterSpells(int monsterId, StatementCache &statements) {
+  std::vector<Spell> spells;
+  try {
+    SQLite::Statement &query = statements.acquire(kSpellsSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      spells.push_back(readSpellRow(query, 0));
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterSpells: " << e.what() << std::endl;
+  }
+  return spells;
+}
+
+Monster getMonsterByName(StatementCache &statements,
+                         const std::string &monsterName) {
+  Monster monster;
+  try {
+    SQLite::Statement &idQuery = statements.acquire(kMonsterIdByNameSql);
+    idQuery.bind(1, monsterName);
+    int monsterId = -1;
+    if (idQuery.executeStep()) {
+      monsterId = idQuery.getColumn(0).getInt();
+    } else {
+      std::cerr << "Monster not found: " << monsterName << std::endl;
+      return monster;
+    }
+
+    SQLite::Statement &coreQuery = statements.acquire(kMonsterByIdSql);
+    coreQuery.bind(1, monsterId);
+
+    if (coreQuery.executeStep()) {
+      readMonsterRow(coreQuery, 0, monster);
+    }
+
+    monster.speeds = getMonsterSpeeds(monsterId, statements);
+    monster.skills = getMonsterSkills(monsterId, statements);
+    monster.savingThrows = getMonsterSavingThrows(monsterId, statements);
+    monster.senses = getMonsterSenses(monsterId, statements);
+    monster.conditionImmunities =
+        getMonsterConditionImmunities(monsterId, statements);
+    monster.damageImmunities =
+        getMonsterDamageImmunities(monsterId, statements);
+    monster.damageResistances =
+        getMonsterDamageResistances(monsterId, statements);
+    monster.damageVulnerabilities =
+        getMonsterDamageVulnerabilities(monsterId, statements);
+    monster.damageDefenses = damageDefensesFor(monster);
+    monster.abilities = getMonsterAbilities(monsterId, statements);
+    monster.spells = getMonsterSpells(monsterId, statements);
+    monster.spellSlots = getMonsterSpellSlots(monsterId, statements);
+    assignResources(monster);
+
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterByName: " << e.what() << std::endl;
+  }
+  return monster;
+}
+
+std::vector<std::string> getMonsterSpeeds(int monsterId,
+                                          StatementCache &statements) {
+  std::vector<std::string> speeds;
+  try {
+    SQLite::Statement &query = statements.acquire(kSpeedsSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      std::stringstream ss;
+      ss << query.getColumn(0).getString() << " "
+         << query.getColumn(1).getString();
+      speeds.push_back(ss.str());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterSpeeds: " << e.what() << std::endl;
+  }
+  return speeds;
+}
+
+std::vector<std::string> getMonsterSkills(int monsterId,
+                                          StatementCache &statements) {
+  std::vector<std::string> skills;
+  try {
+    SQLite::Statement &query = statements.acquire(kSkillsSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      std::stringstream ss;
+      ss << query.getColumn(0).getString() << " +"
+         << query.getColumn(1).getInt();
+      skills.push_back(ss.str());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterSkills: " << e.what() << std::endl;
+  }
+  return skills;
+}
+
+std::vector<std::string> getMonsterSavingThrows(int monsterId,
+                                                StatementCache &statements) {
+  std::vector<std::string> savingThrows;
+  try {
+    SQLite::Statement &query = statements.acquire(kSavingThrowsSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      std::stringstream ss;
+      ss << query.getColumn(0).getString() << " +"
+         << query.getColumn(1).getInt();
+      savingThrows.push_back(ss.str());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterSavingThrows: " << e.what()
+              << std::endl;
+  }
+  return savingThrows;
+}
+
+std::vector<std::string> getMonsterSenses(int monsterId,
+                                          StatementCache &statements) {
+  std::vector<std::string> senses;
+  try {
+    SQLite::Statement &query = statements.acquire(kSensesSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      std::stringstream ss;
+      ss << query.getColumn(0).getString() << " "
+         << query.getColumn(1).getString();
+      senses.push_back(ss.str());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterSenses: " << e.what() << std::endl;
+  }
+  return senses;
+}
+
+std::vector<std::string>
+getMonsterConditionImmunities(int monsterId, StatementCache &statements) {
+  std::vector<std::string> immunities;
+  try {
+    SQLite::Statement &query = statements.acquire(kConditionImmunitiesSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      immunities.push_back(query.getColumn(0).getString());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterConditionImmunities: " << e.what()
+              << std::endl;
+  }
+  return immunities;
+}
+
+std::vector<std::string>
+getMonsterDamageImmunities(int monsterId, StatementCache &statements) {
+  std::vector<std::string> immunities;
+  try {
+    SQLite::Statement &query = statements.acquire(kDamageImmunitiesSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      immunities.push_back(query.getColumn(0).getString());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterDamageImmunities: " << e.what()
+              << std::endl;
+  }
+  return immunities;
+}
+
+std::vector<std::string>
+getMonsterDamageResistances(int monsterId, StatementCache &statements) {
+  std::vector<std::string> resistances;
+  try {
+    SQLite::Statement &query = statements.acquire(kDamageResistancesSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      resistances.push_back(query.getColumn(0).getString());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterDamageResistances: " << e.what()
+              << std::endl;
+  }
+  return resistances;
+}
+
+std::vector<std::string>
+getMonsterDamageVulnerabilities(int monsterId, StatementCache &statements) {
+  std::vector<std::string> vulnerabilities;
+  try {
+    SQLite::Statement &query = statements.acquire(kDamageVulnerabilitiesSql);
+    query.bind(1, monsterId);
+    while (query.executeStep()) {
+      vulnerabilities.push_back(query.getColumn(0).getString());
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterDamageVulnerabilities: " << e.what()
+              << std::endl;
+  }
+  return vulnerabilities;
+}
+
+ActionType stringToActionType(const std::string &str) {
+  std::string lower_str = str;
+  std::transform(lower_str.begin(), lower_str.end(), lower_str.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+
+  if (lower_str.find("bonus action") != std::string::npos) {
+    return ActionType::BONUS_ACTION;
+  }
+  if (lower_str.find("action") != std::string::npos) {
+    return ActionType::ACTION;
+  }
+  if (lower_str.find("reaction") != std::string::npos) {
+    return ActionType::REACTION;
+  }
+  if (lower_str.find("legendary") != std::string::npos) {
+    return ActionType::LEGENDARY;
+  }
+  if (lower_str.find("lair") != std::string::npos) {
+    return ActionType::LAIR;
+  }
+  return ActionType::NONE;
+}
+
+std::vector<Ability> getMonsterAbilities(int monsterId,
+                                         StatementCache &statements) {
+  std::vector<Ability> abilities;
+  try {
+    SQLite::Statement &query = statements.acquire(kAbilitiesSql);
+    query.bind(1, monsterId);
+
+    while (query.executeStep()) {
+      abilities.push_back(readAbilityRow(query, 0));
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in getMonsterAbilities: " << e.what()
+              << std::endl;
+  }
+  return abilities;
+}
+
+const std::vector<LoaderQuery> &perMonsterQueries() {
+  static const std::vector<LoaderQuery> queries = {
+      {"monster id by name", kMonsterIdByNameSql},
+      {"monster", kMonsterByIdSql},
+      {"speeds", kSpeedsSql},
+      {"skills", kSkillsSql},
+      {"saving throws", kSavingThrowsSql},
+      {"senses", kSensesSql},
+      {"condition immunities", kConditionImmunitiesSql},
+      {"damage immunities", kDamageImmunitiesSql},
+      {"damage resistances", kDamageResistancesSql},
+      {"damage vulnerabilities", kDamageVulnerabilitiesSql},
+      {"abilities", kAbilitiesSql},
+      {"spells", kSpellsSql},
+      {"spell slots", kSpellSlotsSql},
+  };
+  return queries;
+}
+
+// --- Bulk Catalog Loader ---
+
+const Monster *MonsterCatalog::findById(int monsterId) const {
+  auto it = monsters.find(monsterId);
+  return it != monsters.end() ? &it->second : nullptr;
+}
+
+const Monster *MonsterCatalog::findByName(const std::string &name) const {
+  auto it = idsByName.find(name);
+  return it != idsByName.end() ? findById(it->second) : nullptr;
+}
+
+// Walks one child table ordered by MonsterID and hands each row to `onRow`
+// together with the monster it belongs to. Rows arrive grouped by owner, so
+// the map lookup only happens when the MonsterID changes.
+template <typename RowFn>
+static void scanChildTable(SQLite::Database &db, MonsterCatalog &catalog,
+                           const char *sql, RowFn onRow) {
+  SQLite::Statement query(db, sql);
+  int currentId = -1;
+  Monster *current = nullptr;
+  while (query.executeStep()) {
+    int monsterId = query.getColumn(0).getInt();
+    if (monsterId != currentId) {
+      currentId = monsterId;
+      auto it = catalog.monsters.find(monsterId);
+      current = it != catalog.monsters.end() ? &it->second : nullptr;
+    }
+    if (current) {
+      onRow(*current, query);
+    }
+  }
+}
+
+static void appendNamedValue(std::vector<std::string> &list,
+                             SQLite::Statement &query, const char *separator) {
+  std::string entry = query.getColumn(1).getString();
+  entry += separator;
+  entry += query.getColumn(2).getString();
+  list.push_back(std::move(entry));
+}
+
+MonsterCatalog loadMonsterCatalog(SQLite::Database &db) {
+  MonsterCatalog catalog;
+  try {
+    SQLite::Statement coreQuery(
+        db, "SELECT MonsterID, Name, Size, Type, Alignment, ArmorClass, "
+            "HitPoints_Avg, HitPoints_Formula, Strength, Dexterity, "
+            "Constitution, Intelligence, Wisdom, Charisma, ChallengeRating, "
+            "Languages, SpellSaveDC, SpellAttackBonus FROM Monsters "
+            "ORDER BY Name ASC");
+    while (coreQuery.executeStep()) {
+      int monsterId = coreQuery.getColumn(0).getInt();
+      Monster &monster = catalog.monsters[monsterId];
+      readMonsterRow(coreQuery, 1, monster);
+      monster.spellSlots.assign(9, 0);
+      catalog.names.push_back(monster.name);
+      catalog.idsByName[monster.name] = monsterId;
+    }
+
+    scanChildTable(db, catalog,
+                   "SELECT MonsterID, SpeedType, Value FROM Monster_Speeds "
+                   "ORDER BY MonsterID, SpeedType",
+                   [](Monster &monster, SQLite::Statement &query) {
+                     appendNamedValue(monster.speeds, query, " ");
+                   });
+    scanChildTable(db, catalog,
+                   "SELECT MS.MonsterID, S.Name, MS.Value FROM Skills AS S "
+                   "INNER JOIN Monster_Skills AS MS ON S.SkillID = MS.SkillID "
+                   "ORDER BY MS.MonsterID, MS.SkillID",
+                   [](Monster &monster, SQLite::Statement &query) {
+                     appendNamedValue(monster.skills, query, " +");
+                   });
+    scanChildTable(
+        db, catalog,
+        "SELECT MST.MonsterID, ST.Name, MST.Value FROM SavingThrows AS ST "
+        "INNER JOIN Monster_SavingThrows AS MST ON "
+        "ST.SavingThrowID = MST.SavingThrowID "
+        "ORDER BY MST.MonsterID, MST.SavingThrowID",
+        [](Monster &monster, SQLite::Statement &query) {
+          appendNamedValue(monster.savingThrows, query, " +");
+        });
+    scanChildTable(db, catalog,
+                   "SELECT MS.MonsterID, S.Name, MS.Value FROM Senses AS S "
+                   "INNER JOIN Monster_Senses AS MS ON S.SenseID = MS.SenseID "
+                   "ORDER BY MS.MonsterID, MS.SenseID",
+                   [](Monster &monster, SQLite::Statement &query) {
+                     appendNamedValue(monster.senses, query, " ");
+                   });
+    scanChildTable(
+        db, catalog,
+        "SELECT MCI.MonsterID, C.Name FROM Conditions AS C INNER JOIN "
+        "Monster_ConditionImmunities AS MCI ON C.ConditionID = "
+        "MCI.ConditionID ORDER BY MCI.MonsterID, MCI.ConditionID",
+        [](Monster &monster, SQLite::Statement &query) {
+          monster.conditionImmunities.push_back(query.getColumn(1).getString());
+        });
+    scanChildTable(
+        db, catalog,
+        "SELECT MDI.MonsterID, D.Name FROM DamageTypes AS D INNER JOIN "
+        "Monster_DamageImmunities AS MDI ON D.DamageTypeID = "
+        "MDI.DamageTypeID ORDER BY MDI.MonsterID, MDI.DamageTypeID",
+        [](Monster &monster, SQLite::Statement &query) {
+          monster.damageImmunities.push_back(query.getColumn(1).getString());
+        });
+    scanChildTable(
+        db, catalog,
+        "SELECT MDR.MonsterID, D.Name FROM DamageTypes AS D INNER JOIN "
+        "Monster_DamageResistances AS MDR ON D.DamageTypeID = "
+        "MDR.DamageTypeID ORDER BY MDR.MonsterID, MDR.DamageTypeID",
+        [](Monster &monster, SQLite::Statement &query) {
+          monster.damageResistances.push_back(query.getColumn(1).getString());
+        });
+    scanChildTable(
+        db, catalog,
+        "SELECT MDV.MonsterID, D.Name FROM DamageTypes AS D INNER JOIN "
+        "Monster_DamageVulnerabilities AS MDV ON D.DamageTypeID = "
+        "MDV.DamageTypeID ORDER BY MDV.MonsterID, MDV.DamageTypeID",
+        [](Monster &monster, SQLite::Statement &query) {
+          monster.damageVulnerabilities.push_back(
+              query.getColumn(1).getString());
+        });
+    scanChildTable(
+        db, catalog,
+        "SELECT A.MonsterID, A.Name, A.Description, A.AbilityType, "
+        "AU.UsageType, AU.UsesMax, AU.RechargeValue, A.ActionType, "
+        "A.TargetType, A.AttackRollType, A.SavingThrowType, A.SavingThrowDC, "
+        "A.DamageDice, A.DamageType, A.DamageModifierAbility FROM "
+        "Abilities AS A LEFT JOIN Ability_Usage AS AU ON A.AbilityID = "
+        "AU.AbilityID ORDER BY A.MonsterID, A.AbilityID",
+        [](Monster &monster, SQLite::Statement &query) {
+          monster.abilities.push_back(readAbilityRow(query, 1));
+        });
+    scanChildTable(
+        db, catalog,
+        "SELECT MS.MonsterID, S.Name, S.Level, S.CastingTime, "
+        "S.Description, S.SavingThrowType, S.SavingThrowDC, S.DamageDice, "
+        "S.DamageType, S.DamageModifierAbility FROM Spells AS S INNER JOIN "
+        "Monster_Spells AS MS ON S.SpellID = MS.SpellID "
+        "ORDER BY MS.MonsterID, S.Level, S.Name",
+        [](Monster &monster, SQLite::Statement &query) {
+          monster.spells.push_back(readSpellRow(query, 1));
+        });
+    scanChildTable(db, catalog,
+                   "SELECT MonsterID, SpellLevel, Slots FROM "
+                   "Monster_SpellSlots ORDER BY MonsterID, SpellLevel",
+                   [](Monster &monster, SQLite::Statement &query) {
+                     int level = query.getColumn(1).getInt();
+                     if (level >= 1 && level <= 9) {
+                       monster.spellSlots[level - 1] =
+                           query.getColumn(2).getInt();
+                     }
+                   });
+    for (auto &entry : catalog.monsters) {
+      entry.second.damageDefenses = damageDefensesFor(entry.second);
+      assignResources(entry.second);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in loadMonsterCatalog: " << e.what()
+              << std::endl;
+  }
+  return catalog;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "monster.h"
+#include "statement_cache.h"
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Relative to the build directory the executable is launched from.
+constexpr const char *kDatabasePath = "../data/initiativ.sqlite";
+
+ActionType stringToActionType(const std::string &str);
+
+// --- Per-Monster Loader ---
+// Hydrates one monster at a time with a query per child table.
+std::vector<std::string> getMonsterNames(SQLite::Database &db);
+Monster getMonsterByName(StatementCache &statements,
+                         const std::string &monsterName);
+
+std::vector<std::string> getMonsterSkills(int monsterId,
+                                          StatementCache &statements);
+std::vector<std::string> getMonsterSavingThrows(int monsterId,
+                                                StatementCache &statements);
+std::vector<std::string> getMonsterSenses(int monsterId,
+                                          StatementCache &statements);
+std::vector<std::string>
+getMonsterConditionImmunities(int monsterId, StatementCache &statements);
+std::vector<std::string> getMonsterDamageImmunities(int monsterId,
+                                                    StatementCache &statements);
+std::vector<std::string>
+getMonsterDamageResistances(int monsterId, StatementCache &statements);
+std::vector<std::string>
+getMonsterDamageVulnerabilities(int monsterId, StatementCache &statements);
+std::vector<Ability> getMonsterAbilities(int monsterId,
+                                         StatementCache &statements);
+std::vector<std::string> getMonsterSpeeds(int monsterId,
+                                          StatementCache &statements);
+std::vector<int> getMonsterSpellSlots(int monsterId,
+                                      StatementCache &statements);
+std::vector<Spell> getMonsterSpells(int monsterId, StatementCache &statements);
+
+// The SQL behind the functions above, labelled for diagnostics.
+struct LoaderQuery {
+  const char *name;
+  const char *sql;
+};
+const std::vector<LoaderQuery> &perMonsterQueries();
+
+// --- Bulk Catalog ---
+// The whole bestiary held in memory and keyed by MonsterID. It is built with
+// one ordered scan per child table, so once it is loaded neither the Bestiary
+// nor "Add to Encounter" needs to go back to SQLite.
+struct MonsterCatalog {
+  std::unordered_map<int, Monster> monsters;
+  std::unordered_map<std::string, int> idsByName;
+  std::vector<std::string> names; // Sorted, as shown in the Bestiary list
+
+  const Monster *findById(int monsterId) const;
+  const Monster *findByName(const std::string &name) const;
+};
+
+MonsterCatalog loadMonsterCatalog(SQLite::Database &db);
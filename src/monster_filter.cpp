@@ -0,0 +1,88 @@
+#include "monster_filter.h"
+#include "monster_search.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+void MonsterFilter::setNames(const std::vector<std::string> &names) {
+  m_lowerNames = names;
+  for (auto &name : m_lowerNames) {
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+  }
+  m_results.clear();
+  m_results.reserve(names.size());
+  m_stale = true;
+}
+
+void MonsterFilter::setSearchIndex(MonsterSearchIndex *index) {
+  m_index = index;
+  m_stale = true;
+}
+
+bool MonsterFilter::update(const char *query) {
+  m_stats.updates++;
+
+  char lowered[kMaxQuery];
+  size_t length = 0;
+  bool same = !m_stale;
+  for (; query[length] != '\0' && length + 1 < kMaxQuery; ++length) {
+    lowered[length] = static_cast<char>(
+        std::tolower(static_cast<unsigned char>(query[length])));
+    same = same && lowered[length] == m_query[length];
+  }
+  lowered[length] = '\0';
+  if (same && m_query[length] == '\0') {
+    return false;
+  }
+
+  // Every name matching the new text also matched the old text, so only the
+  // previous matches need checking again.
+  bool extends = !m_stale && m_query[0] != '\0' &&
+                 std::strstr(lowered, m_query) != nullptr;
+  if (length == 0) {
+    matchAll();
+  } else if (m_index && m_index->documentCount() == m_lowerNames.size()) {
+    m_results.clear();
+    for (const auto &hit : m_index->search(lowered)) {
+      m_results.push_back(hit.doc);
+    }
+    m_stats.rebuilds++;
+  } else if (extends) {
+    narrow(lowered);
+  } else {
+    scanNames(lowered);
+  }
+
+  std::memcpy(m_query, lowered, length + 1);
+  m_stale = false;
+  return true;
+}
+
+void MonsterFilter::matchAll() {
+  m_results.resize(m_lowerNames.size());
+  for (uint32_t i = 0; i < m_results.size(); ++i) {
+    m_results[i] = i;
+  }
+  m_stats.rebuilds++;
+}
+
+void MonsterFilter::scanNames(const char *query) {
+  m_results.clear();
+  for (uint32_t i = 0; i < m_lowerNames.size(); ++i) {
+    if (m_lowerNames[i].find(query) != std::string::npos) {
+      m_results.push_back(i);
+    }
+  }
+  m_stats.rebuilds++;
+}
+
+void MonsterFilter::narrow(const char *query) {
+  m_results.erase(std::remove_if(m_results.begin(), m_results.end(),
+                                 [&](uint32_t i) {
+                                   return m_lowerNames[i].find(query) ==
+                                          std::string::npos;
+                                 }),
+                  m_results.end());
+  m_stats.narrowings++;
+}
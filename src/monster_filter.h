@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MonsterSearchIndex;
+
+// How often the filter actually did work, for checking it stays idle.
+struct MonsterFilterStats {
+  size_t updates = 0;    // Calls to update()
+  size_t rebuilds = 0;   // Full passes over every name or a fresh search
+  size_t narrowings = 0; // Passes over only the previous matches
+};
+
+// --- Bestiary Filter ---
+// Turns the search box into a list of indices into the Bestiary names. Names
+// are lowercased once when they arrive; update() is cheap to call every
+// frame and does nothing unless the query or the sources changed. Without a
+// search index, a query that extends the previous one (typing another letter)
+// only re-checks the previous matches. With an index, results come from the
+// ranked full-text search instead. Storage is sized when the names are set,
+// so updating never allocates afterwards.
+class MonsterFilter {
+public:
+  static constexpr size_t kMaxQuery = 256;
+
+  void setNames(const std::vector<std::string> &names);
+  // Non-owning; pass nullptr to fall back to substring matching.
+  void setSearchIndex(MonsterSearchIndex *index);
+
+  // Re-filters if `query` differs from the last one. Returns true when the
+  // result list was recomputed.
+  bool update(const char *query);
+
+  const std::vector<uint32_t> &results() const { return m_results; }
+  size_t size() const { return m_results.size(); }
+  uint32_t operator[](size_t i) const { return m_results[i]; }
+  const MonsterFilterStats &stats() const { return m_stats; }
+
+private:
+  void matchAll();
+  void scanNames(const char *query);
+  void narrow(const char *query);
+
+  std::vector<std::string> m_lowerNames;
+  std::vector<uint32_t> m_results;
+  MonsterSearchIndex *m_index = nullptr;
+  char m_query[kMaxQuery] = ""; // Lowercased, as last applied
+  bool m_stale = true;          // Sources changed since the last update
+  MonsterFilterStats m_stats;
+};
@@ -0,0 +1,170 @@
+#include "monster_loader.h"
+#include "schema_migrations.h"
+#include <iostream>
+
+MonsterLoader::MonsterLoader() : m_worker([this] { run(); }) {}
+
+MonsterLoader::~MonsterLoader() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+    m_jobs.clear();
+  }
+  m_wake.notify_one();
+  m_worker.join();
+}
+
+void MonsterLoader::run() {
+  for (;;) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+      if (m_stopping) {
+        return;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    job();
+  }
+}
+
+void MonsterLoader::enqueue(std::function<void()> job) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back(std::move(job));
+  }
+  m_wake.notify_one();
+}
+
+MonsterLoaderStats MonsterLoader::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+std::future<std::vector<std::string>> MonsterLoader::loadBestiary() {
+  auto promise = std::make_shared<std::promise<std::vector<std::string>>>();
+  std::future<std::vector<std::string>> future = promise->get_future();
+  enqueue([this, promise] {
+    try {
+      promise->set_value(loadSources());
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return future;
+}
+
+MonsterCacheStats MonsterLoader::cacheStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_cache.stats();
+}
+
+std::future<std::unique_ptr<MonsterSearchIndex>>
+MonsterLoader::loadSearchIndex() {
+  auto promise =
+      std::make_shared<std::promise<std::unique_ptr<MonsterSearchIndex>>>();
+  std::future<std::unique_ptr<MonsterSearchIndex>> future =
+      promise->get_future();
+  enqueue([this, promise] {
+    try {
+      promise->set_value(m_snapshot ? buildSearchIndex(*m_snapshot)
+                                    : buildSearchIndex(m_catalog));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return future;
+}
+
+std::future<std::shared_ptr<const Monster>>
+MonsterLoader::requestMonster(const std::string &name) {
+  uint64_t request = ++m_latestRequest;
+  auto promise =
+      std::make_shared<std::promise<std::shared_ptr<const Monster>>>();
+  std::future<std::shared_ptr<const Monster>> future = promise->get_future();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.requested++;
+    if (auto cached = m_cache.find(name)) {
+      m_stats.completed++;
+      promise->set_value(std::move(cached));
+      return future;
+    }
+  }
+  enqueue([this, promise, request, name] {
+    if (request != m_latestRequest.load()) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.cancelled++;
+      return; // Dropping the promise breaks the stale future
+    }
+    try {
+      std::shared_ptr<const Monster> monster;
+      auto hydrated = std::make_shared<Monster>();
+      if (findMonster(name, *hydrated)) {
+        monster = std::move(hydrated);
+      }
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (monster) {
+        m_cache.insert(name, monster);
+      }
+      m_stats.completed++;
+      promise->set_value(std::move(monster));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return future;
+}
+
+// Maps the binary snapshot when it was compiled from the current database;
+// otherwise loads the catalog from SQLite and rewrites the snapshot so the
+// next launch can skip the database entirely. Pending migrations run first,
+// since applying one changes the checksum the snapshot is keyed on.
+std::vector<std::string> MonsterLoader::loadSources() {
+  std::vector<std::string> names;
+  migrateDatabase(kDatabasePath);
+  uint64_t checksum = checksumFile(kDatabasePath);
+  m_snapshot = BestiarySnapshot::open(kSnapshotPath, checksum);
+  if (m_snapshot) {
+    names.reserve(m_snapshot->size());
+    for (uint32_t i = 0; i < m_snapshot->size(); ++i) {
+      names.emplace_back(m_snapshot->name(i));
+    }
+    std::cout << "Mapped bestiary snapshot with " << names.size()
+              << " monsters." << std::endl;
+    return names;
+  }
+
+  SQLite::Database db(kDatabasePath, SQLite::OPEN_READONLY);
+  std::cout << "Successfully opened database." << std::endl;
+  m_catalog = loadMonsterCatalog(db);
+  names = m_catalog.names;
+  std::cout << "Successfully loaded " << names.size()
+            << " monsters into the catalog." << std::endl;
+  if (compileBestiarySnapshot(m_catalog, checksum, kSnapshotPath)) {
+    std::cout << "Compiled bestiary snapshot for the next launch."
+              << std::endl;
+  }
+  return names;
+}
+
+// Copies the named monster out of whichever source loadSources() chose.
+bool MonsterLoader::findMonster(const std::string &name,
+                                Monster &monster) const {
+  if (m_snapshot) {
+    int index = m_snapshot->find(name);
+    if (index < 0) {
+      return false;
+    }
+    monster = m_snapshot->materialize(index);
+    return true;
+  }
+  const Monster *found = m_catalog.findByName(name);
+  if (!found) {
+    return false;
+  }
+  monster = *found;
+  return true;
+}
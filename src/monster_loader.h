@@ -0,0 +1,74 @@
+#pragma once
+
+#include "bestiary_snapshot.h"
+#include "monster.h"
+#include "monster_cache.h"
+#include "monster_db.h"
+#include "monster_search.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct MonsterLoaderStats {
+  size_t requested = 0; // Monster requests queued by the UI
+  size_t completed = 0; // Requests that produced a Monster
+  size_t cancelled = 0; // Requests superseded before the worker reached them
+};
+
+// --- Background Monster Loader ---
+// Owns the bestiary sources (the mapped snapshot or the SQLite catalog) on a
+// dedicated worker thread so the render loop never waits on disk or SQLite.
+// Work is queued and answered through futures the UI polls once per frame.
+// Only the newest monster request matters: when the selection moves on, any
+// older request still waiting in the queue is dropped and its future reports
+// std::future_errc::broken_promise. Hydrated monsters are kept in an LRU
+// cache, and a request that hits it is answered immediately without queueing.
+class MonsterLoader {
+public:
+  MonsterLoader();
+  ~MonsterLoader();
+
+  MonsterLoader(const MonsterLoader &) = delete;
+  MonsterLoader &operator=(const MonsterLoader &) = delete;
+
+  // Maps the snapshot or loads the catalog; resolves to the sorted names.
+  std::future<std::vector<std::string>> loadBestiary();
+  // Indexes whatever loadBestiary() loaded, in the same document order.
+  std::future<std::unique_ptr<MonsterSearchIndex>> loadSearchIndex();
+  // Hydrates `name`, superseding every earlier pending request. Resolves to
+  // nullptr when there is no such monster.
+  std::future<std::shared_ptr<const Monster>>
+  requestMonster(const std::string &name);
+
+  MonsterLoaderStats stats() const;
+  MonsterCacheStats cacheStats() const;
+
+private:
+  void run();
+  void enqueue(std::function<void()> job);
+  std::vector<std::string> loadSources();
+  bool findMonster(const std::string &name, Monster &monster) const;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::deque<std::function<void()>> m_jobs;
+  bool m_stopping = false;
+  std::atomic<uint64_t> m_latestRequest{0};
+  MonsterLoaderStats m_stats;
+  MonsterCache m_cache{64, 4 * 1024 * 1024}; // Guarded by m_mutex
+
+  // Touched only by the worker thread.
+  std::unique_ptr<BestiarySnapshot> m_snapshot;
+  MonsterCatalog m_catalog;
+
+  // Declared last so everything run() touches is constructed before it starts.
+  std::thread m_worker;
+};
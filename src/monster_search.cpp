@@ -0,0 +1,224 @@
+#include "monster_search.h"
+#include "bestiary_snapshot.h"
+#include "monster_db.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+// Folds simple English plurals so "weapons" finds "Breath Weapon" and
+// "immunities" finds "fire immunity". Applied to documents and queries alike.
+static void stemToken(std::string &token) {
+  size_t n = token.size();
+  if (n > 4 && token.compare(n - 3, 3, "ies") == 0) {
+    token.replace(n - 3, 3, "y");
+  } else if (n > 3 && token[n - 1] == 's' && token[n - 2] != 's') {
+    token.pop_back();
+  }
+}
+
+// Calls `onToken` with each lowercase alphanumeric run in `text`, skipping
+// bracketed markup such as [APPLY_CONDITION:Frightened:1].
+template <typename TokenFn>
+static void forEachToken(std::string_view text, std::string &token,
+                         TokenFn onToken) {
+  token.clear();
+  for (size_t i = 0; i <= text.size(); ++i) {
+    unsigned char c = i < text.size() ? text[i] : ' ';
+    if (std::isalnum(c)) {
+      token.push_back(static_cast<char>(std::tolower(c)));
+      continue;
+    }
+    if (!token.empty()) {
+      stemToken(token);
+      onToken(token);
+      token.clear();
+    }
+    if (c == '[') {
+      size_t close = text.find(']', i);
+      if (close != std::string_view::npos) {
+        i = close;
+      }
+    }
+  }
+}
+
+void MonsterSearchIndex::add(uint32_t doc, std::string_view text,
+                             float weight) {
+  std::string token;
+  forEachToken(text, token, [&](const std::string &word) {
+    m_building[word].push_back({doc, weight});
+  });
+}
+
+void MonsterSearchIndex::addMonster(uint32_t doc, const Monster &monster) {
+  auto addTraits = [&](const std::vector<std::string> &traits,
+                       const char *suffix) {
+    for (const auto &trait : traits) {
+      add(doc, trait + suffix, kTraitWeight);
+    }
+  };
+
+  add(doc, monster.name, kNameWeight);
+  add(doc, monster.type, kTypeWeight);
+  for (const auto &ability : monster.abilities) {
+    add(doc, ability.name, kActionNameWeight);
+    add(doc, ability.description, kDescriptionWeight);
+  }
+  for (const auto &spell : monster.spells) {
+    add(doc, spell.name, kActionNameWeight);
+  }
+  addTraits(monster.damageImmunities, " immunity");
+  addTraits(monster.damageResistances, " resistance");
+  addTraits(monster.damageVulnerabilities, " vulnerability");
+  addTraits(monster.conditionImmunities, " immunity");
+}
+
+void MonsterSearchIndex::finalize(uint32_t documentCount) {
+  std::vector<std::pair<std::string, std::vector<Posting>>> terms(
+      std::make_move_iterator(m_building.begin()),
+      std::make_move_iterator(m_building.end()));
+  m_building.clear();
+  std::sort(terms.begin(), terms.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  m_documentCount = documentCount;
+  m_terms.clear();
+  m_termOffsets.clear();
+  m_postings.clear();
+  m_terms.reserve(terms.size());
+  m_termOffsets.reserve(terms.size() + 1);
+  for (auto &term : terms) {
+    auto &postings = term.second;
+    std::stable_sort(
+        postings.begin(), postings.end(),
+        [](const Posting &a, const Posting &b) { return a.doc < b.doc; });
+    m_terms.push_back(std::move(term.first));
+    m_termOffsets.push_back(static_cast<uint32_t>(m_postings.size()));
+    for (size_t i = 0; i < postings.size();) {
+      Posting merged = postings[i];
+      for (++i; i < postings.size() && postings[i].doc == merged.doc; ++i) {
+        merged.weight += postings[i].weight;
+      }
+      // Stored pre-damped so queries only multiply by idf.
+      merged.weight = 1.0f + std::log(merged.weight);
+      m_postings.push_back(merged);
+    }
+  }
+  m_termOffsets.push_back(static_cast<uint32_t>(m_postings.size()));
+
+  m_scores.assign(documentCount, 0.0f);
+  m_matchedWords.assign(documentCount, 0);
+  m_touched.clear();
+  m_touched.reserve(documentCount);
+}
+
+const std::vector<SearchHit> &
+MonsterSearchIndex::search(std::string_view query) {
+  m_results.clear();
+  m_queryWords.clear();
+  std::string token;
+  forEachToken(query, token, [&](const std::string &word) {
+    m_queryWords.push_back(word);
+  });
+  if (m_queryWords.empty() || m_queryWords.size() > UINT16_MAX) {
+    return m_results;
+  }
+
+  // A document survives word N only if it matched words 0..N-1, so after
+  // the first word the candidate set can only shrink.
+  uint16_t wordIndex = 0;
+  for (const auto &word : m_queryWords) {
+    auto term = std::lower_bound(m_terms.begin(), m_terms.end(), word);
+    for (; term != m_terms.end() && term->compare(0, word.size(), word) == 0;
+         ++term) {
+      size_t t = term - m_terms.begin();
+      uint32_t first = m_termOffsets[t];
+      uint32_t last = m_termOffsets[t + 1];
+      float idf = std::log(1.0f + static_cast<float>(m_documentCount) /
+                                      static_cast<float>(last - first));
+      if (term->size() != word.size()) {
+        idf *= kPrefixMatchFactor; // "breath" should favour Breath Weapon
+      }
+      for (uint32_t p = first; p < last; ++p) {
+        const Posting &posting = m_postings[p];
+        uint16_t &matched = m_matchedWords[posting.doc];
+        if (matched == wordIndex) {
+          if (wordIndex == 0) {
+            m_touched.push_back(posting.doc);
+          }
+          matched = wordIndex + 1;
+        } else if (matched != wordIndex + 1) {
+          continue;
+        }
+        m_scores[posting.doc] += idf * posting.weight;
+      }
+    }
+    ++wordIndex;
+  }
+
+  for (uint32_t doc : m_touched) {
+    if (m_matchedWords[doc] == wordIndex) {
+      m_results.push_back({doc, m_scores[doc]});
+    }
+    m_matchedWords[doc] = 0;
+    m_scores[doc] = 0.0f;
+  }
+  m_touched.clear();
+
+  std::sort(m_results.begin(), m_results.end(),
+            [](const SearchHit &a, const SearchHit &b) {
+              return a.score != b.score ? a.score > b.score : a.doc < b.doc;
+            });
+  return m_results;
+}
+
+// --- Index Builders ---
+
+std::unique_ptr<MonsterSearchIndex>
+buildSearchIndex(const BestiarySnapshot &snapshot) {
+  auto index = std::make_unique<MonsterSearchIndex>();
+  std::string trait;
+  auto addTraits = [&](uint32_t doc, SnapshotRange range, const char *suffix) {
+    for (const auto &s : snapshot.strings(range)) {
+      trait.assign(snapshot.str(s));
+      trait += suffix;
+      index->add(doc, trait, MonsterSearchIndex::kTraitWeight);
+    }
+  };
+
+  for (uint32_t doc = 0; doc < snapshot.size(); ++doc) {
+    const SnapshotMonster &m = snapshot.monster(doc);
+    index->add(doc, snapshot.str(m.name), MonsterSearchIndex::kNameWeight);
+    index->add(doc, snapshot.str(m.type), MonsterSearchIndex::kTypeWeight);
+    for (const auto &ability : snapshot.abilities(m)) {
+      index->add(doc, snapshot.str(ability.name),
+                 MonsterSearchIndex::kActionNameWeight);
+      index->add(doc, snapshot.str(ability.description),
+                 MonsterSearchIndex::kDescriptionWeight);
+    }
+    for (const auto &spell : snapshot.spells(m)) {
+      index->add(doc, snapshot.str(spell.name),
+                 MonsterSearchIndex::kActionNameWeight);
+    }
+    addTraits(doc, m.damageImmunities, " immunity");
+    addTraits(doc, m.damageResistances, " resistance");
+    addTraits(doc, m.damageVulnerabilities, " vulnerability");
+    addTraits(doc, m.conditionImmunities, " immunity");
+  }
+  index->finalize(snapshot.size());
+  return index;
+}
+
+std::unique_ptr<MonsterSearchIndex>
+buildSearchIndex(const MonsterCatalog &catalog) {
+  auto index = std::make_unique<MonsterSearchIndex>();
+  uint32_t doc = 0;
+  for (const auto &name : catalog.names) {
+    if (const Monster *monster = catalog.findByName(name)) {
+      index->addMonster(doc, *monster);
+    }
+    ++doc;
+  }
+  index->finalize(doc);
+  return index;
+}
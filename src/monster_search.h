@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class BestiarySnapshot;
+struct Monster;
+struct MonsterCatalog;
+
+struct SearchHit {
+  uint32_t doc; // Position in the name-sorted Bestiary list
+  float score;
+};
+
+// --- Full-Text Monster Search ---
+// An in-memory inverted index over each monster's name, type, ability names
+// and text, spell names and damage/condition immunities and resistances.
+// Text is split into lowercase alphanumeric tokens ([TAG] markup is skipped),
+// and every token keeps the summed weight of the fields it appeared in, so a
+// hit in a name outranks one buried in an ability description.
+//
+// A query matches documents that contain every query word, each treated as a
+// prefix ("breath weap" finds Breath Weapon). Hits are ranked by the sum of
+// idf * (1 + ln(field weight)) over the matching terms, best first; terms
+// that only extend a query word count for a quarter of an exact match.
+class MonsterSearchIndex {
+public:
+  static constexpr float kNameWeight = 8.0f;
+  static constexpr float kTypeWeight = 4.0f;
+  static constexpr float kActionNameWeight = 3.0f;
+  static constexpr float kTraitWeight = 2.0f; // Immunities and resistances
+  static constexpr float kDescriptionWeight = 1.0f;
+  static constexpr float kPrefixMatchFactor = 0.25f;
+
+  // Build phase: add text for document `doc`, then finalize() once.
+  void add(uint32_t doc, std::string_view text, float weight);
+  // Adds every searchable field of `monster` as document `doc`.
+  void addMonster(uint32_t doc, const Monster &monster);
+  void finalize(uint32_t documentCount);
+
+  // Ranked matches for `query`. The returned vector is reused by the next
+  // call, so this is meant for a single (UI) thread.
+  const std::vector<SearchHit> &search(std::string_view query);
+
+  uint32_t documentCount() const { return m_documentCount; }
+  size_t termCount() const { return m_terms.size(); }
+
+private:
+  struct Posting {
+    uint32_t doc;
+    float weight;
+  };
+
+  std::unordered_map<std::string, std::vector<Posting>> m_building;
+
+  uint32_t m_documentCount = 0;
+  std::vector<std::string> m_terms;    // Sorted, for prefix ranges
+  std::vector<uint32_t> m_termOffsets; // m_terms.size() + 1 entries
+  std::vector<Posting> m_postings;     // Per term, by doc, weights summed
+
+  // Query scratch, sized to the document count in finalize().
+  std::vector<float> m_scores;
+  std::vector<uint16_t> m_matchedWords;
+  std::vector<uint32_t> m_touched;
+  std::vector<std::string> m_queryWords;
+  std::vector<SearchHit> m_results;
+};
+
+// Indexes every monster of a loaded source, using the same document order
+// as the Bestiary list that source produces.
+std::unique_ptr<MonsterSearchIndex>
+buildSearchIndex(const BestiarySnapshot &snapshot);
+std::unique_ptr<MonsterSearchIndex>
+buildSearchIndex(const MonsterCatalog &catalog);
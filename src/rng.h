@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// --- Random Streams ---
+// A counter-based generator in the SplitMix64 style: draw n of a stream is
+// mix(key + n * gamma), so a stream is just a key and a position. Streams
+// for an encounter, each combatant and each simulation worker are derived
+// from one recorded seed with derive(), so a replay from that seed rolls
+// identically and parallel work needs no shared generator or locking.
+// Not for cryptography.
+class RngStream {
+public:
+  using result_type = uint64_t;
+
+  RngStream() = default;
+  explicit RngStream(uint64_t seed) : m_key(mix(seed)) {}
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() { return mix(m_key + ++m_position * kGamma); }
+
+  // An independent child stream, e.g. derive(combatantNumber). The same
+  // parent key and label always give the same child.
+  RngStream derive(uint64_t label) const {
+    RngStream child;
+    child.m_key = mix(m_key ^ mix(label + kGamma));
+    return child;
+  }
+
+  // Draws taken so far; seek() back to it to replay from that point.
+  uint64_t position() const { return m_position; }
+  void seek(uint64_t position) { m_position = position; }
+
+private:
+  static constexpr uint64_t kGamma = 0x9e3779b97f4a7c15ULL;
+
+  static uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  uint64_t m_key = 0;
+  uint64_t m_position = 0;
+};
@@ -0,0 +1,160 @@
+#include "rules.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+
+int calculateModifier(int score) { return (score - 10) / 2; }
+
+AbilityScore abilityScoreFromName(const std::string &abilityName) {
+  std::string lowerAbilityName = abilityName;
+  std::transform(lowerAbilityName.begin(), lowerAbilityName.end(),
+                 lowerAbilityName.begin(), ::tolower);
+
+  if (lowerAbilityName == "strength")
+    return AbilityScore::STRENGTH;
+  if (lowerAbilityName == "dexterity")
+    return AbilityScore::DEXTERITY;
+  if (lowerAbilityName == "constitution")
+    return AbilityScore::CONSTITUTION;
+  if (lowerAbilityName == "intelligence")
+    return AbilityScore::INTELLIGENCE;
+  if (lowerAbilityName == "wisdom")
+    return AbilityScore::WISDOM;
+  if (lowerAbilityName == "charisma")
+    return AbilityScore::CHARISMA;
+  return AbilityScore::NONE;
+}
+
+int getAbilityScore(const Monster &monster, AbilityScore ability) {
+  switch (ability) {
+  case AbilityScore::STRENGTH:
+    return monster.strength;
+  case AbilityScore::DEXTERITY:
+    return monster.dexterity;
+  case AbilityScore::CONSTITUTION:
+    return monster.constitution;
+  case AbilityScore::INTELLIGENCE:
+    return monster.intelligence;
+  case AbilityScore::WISDOM:
+    return monster.wisdom;
+  case AbilityScore::CHARISMA:
+    return monster.charisma;
+  case AbilityScore::NONE:
+    break;
+  }
+  return 0;
+}
+
+int getAbilityScore(const Monster &monster, const std::string &abilityName) {
+  return getAbilityScore(monster, abilityScoreFromName(abilityName));
+}
+
+int getAbilityScore(const Combatant &combatant,
+                    const std::string &abilityName) {
+  return getAbilityScore(*combatant.base, abilityName);
+}
+
+DiceExpr damageWithBonus(const Monster &monster, const DiceExpr &damage,
+                         const std::string &modifierAbility) {
+  DiceExpr withBonus = damage;
+  if (!modifierAbility.empty()) {
+    withBonus.modifier +=
+        calculateModifier(getAbilityScore(monster, modifierAbility));
+  }
+  return withBonus;
+}
+
+DamageType damageTypeFromName(std::string_view damageName) {
+  // In DamageType order, after NONE.
+  static const char *const kNames[] = {"acid",     "bludgeoning", "cold",
+                                       "fire",     "force",       "lightning",
+                                       "necrotic", "piercing",    "poison",
+                                       "psychic",  "radiant",     "slashing",
+                                       "thunder",  "healing"};
+  for (size_t i = 0; i < sizeof(kNames) / sizeof(kNames[0]); ++i) {
+    std::string_view name = kNames[i];
+    if (name.size() == damageName.size() &&
+        std::equal(name.begin(), name.end(), damageName.begin(),
+                   [](char a, char b) {
+                     return a == std::tolower(static_cast<unsigned char>(b));
+                   })) {
+      return static_cast<DamageType>(i + 1);
+    }
+  }
+  return DamageType::NONE;
+}
+
+static DamageTypeMask damageTypeMask(const std::vector<std::string> &names) {
+  DamageTypeMask mask = 0;
+  for (const auto &name : names) {
+    DamageType type = damageTypeFromName(name);
+    if (type != DamageType::NONE && type != DamageType::HEALING) {
+      mask |= damageTypeBit(type);
+    }
+  }
+  return mask;
+}
+
+DamageDefenses damageDefensesFor(const Monster &monster) {
+  DamageDefenses defenses;
+  defenses.immune = damageTypeMask(monster.damageImmunities);
+  defenses.resistant = damageTypeMask(monster.damageResistances);
+  defenses.vulnerable = damageTypeMask(monster.damageVulnerabilities);
+  return defenses;
+}
+
+// Recharge abilities come back on a d6 roll of this or higher unless the
+// bestiary says otherwise, as nearly all of them do ("Recharge 5-6").
+static constexpr int kDefaultRecharge = 5;
+
+// Legendary actions per round for a monster that has any.
+static constexpr int kLegendaryActions = 3;
+
+// 2 for "Wing Attack (Costs 2 Actions)", otherwise 1.
+static int legendaryCost(const std::string &name) {
+  const size_t at = name.find("(Costs ");
+  if (at == std::string::npos) {
+    return 1;
+  }
+  const int cost = std::atoi(name.c_str() + at + 7);
+  return cost > 0 ? cost : 1;
+}
+
+void assignResources(Monster &monster) {
+  Resources &max = monster.maxResources;
+  max = Resources{};
+  const int levels = std::min(Resources::kSpellLevels,
+                              static_cast<int>(monster.spellSlots.size()));
+  for (int level = 1; level <= levels; ++level) {
+    max.spellSlots(level) = monster.spellSlots[level - 1];
+  }
+
+  monster.legendaryActions = 0;
+  monster.lairActions = false;
+  int next = Resources::kSpellLevels;
+  for (auto &ability : monster.abilities) {
+    ability.resource = -1;
+    ability.legendaryCost = 0;
+    if (ability.actionType == ActionType::LEGENDARY) {
+      ability.legendaryCost = legendaryCost(ability.name);
+      monster.legendaryActions = kLegendaryActions;
+    } else if (ability.actionType == ActionType::LAIR) {
+      monster.lairActions = true;
+    }
+    if (ability.usageType == "recharge on roll" && ability.rechargeValue <= 0) {
+      ability.rechargeValue = kDefaultRecharge;
+    }
+    const bool recharges = ability.usageType.rfind("recharge", 0) == 0;
+    if (ability.usesMax <= 0 && !recharges) {
+      continue;
+    }
+    if (next == Resources::kCapacity) {
+      std::cerr << "Too many limited abilities on " << monster.name << "; "
+                << ability.name << " is not tracked." << std::endl;
+      continue;
+    }
+    ability.resource = next;
+    max.values[next++] = ability.usesMax > 0 ? ability.usesMax : 1;
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "dice.h"
+#include "monster.h"
+#include <string>
+#include <string_view>
+
+// --- Rules Helpers ---
+// Shared by the combat UI and everything that predicts its outcomes, so the
+// odds shown before an action always match how resolveAction rolls it.
+
+int calculateModifier(int score);
+
+// Case-insensitive; NONE for anything that is not one of the six scores.
+AbilityScore abilityScoreFromName(const std::string &abilityName);
+int getAbilityScore(const Monster &monster, AbilityScore ability); // 0 if NONE
+
+// The named ability score ("strength", "Dexterity", ...), or 0 if unknown.
+int getAbilityScore(const Monster &monster, const std::string &abilityName);
+int getAbilityScore(const Combatant &combatant,
+                    const std::string &abilityName);
+
+// `damage` plus the bonus from `modifierAbility`, as resolveAction adds it.
+DiceExpr damageWithBonus(const Monster &monster, const DiceExpr &damage,
+                         const std::string &modifierAbility);
+
+// Case-insensitive ("fire", "Fire"); NONE for an empty or unknown name.
+DamageType damageTypeFromName(std::string_view damageName);
+
+constexpr DamageTypeMask damageTypeBit(DamageType type) {
+  return static_cast<DamageTypeMask>(1u << static_cast<unsigned>(type));
+}
+
+// The monster's immunity, resistance and vulnerability lists as masks.
+DamageDefenses damageDefensesFor(const Monster &monster);
+
+// Gives each limited-use or recharge ability of `monster` its entry in
+// Resources and fills in maxResources, and works out what its legendary
+// actions cost. Call once abilities and spell slots are loaded.
+void assignResources(Monster &monster);
+
+// `amount` of `type` damage as the target takes it, after any halving for a
+// save: immunity zeroes it, resistance halves it (rounding toward zero, as a
+// save does) and vulnerability doubles it, all in one step with no branches,
+// so every hit costs the same and loops over many targets vectorize.
+inline int applyDamageDefenses(int amount, DamageType type,
+                               const DamageDefenses &defenses) {
+  const DamageTypeMask bit = damageTypeBit(type);
+  const int immune = (defenses.immune & bit) != 0;
+  const int resistant = (defenses.resistant & bit) != 0;
+  const int vulnerable = (defenses.vulnerable & bit) != 0;
+  const int halved = (amount + (resistant & (amount < 0))) >> resistant;
+  return halved * (1 + vulnerable) * (1 - immune);
+}
@@ -0,0 +1,108 @@
+#include "schema_migrations.h"
+#include "monster_db.h"
+#include <iostream>
+
+namespace {
+
+struct Migration {
+  int version;
+  const char *description;
+  const char *sql;
+};
+
+// Append only; a migration that has shipped is never edited. Versions are
+// consecutive, starting at 1.
+const Migration kMigrations[] = {
+    {1, "Index the child tables the loader looks up by MonsterID",
+     // Rowids ride along in every index, so this one also serves the bulk
+     // scan's ORDER BY MonsterID, AbilityID without a sort.
+     "CREATE INDEX IF NOT EXISTS idx_Abilities_MonsterID "
+     "ON Abilities(MonsterID);"
+     // Covering: the join to Spells never has to visit Monster_Spells rows.
+     "CREATE INDEX IF NOT EXISTS idx_Monster_Spells_MonsterID "
+     "ON Monster_Spells(MonsterID, SpellID);"
+     // The UNIQUE(MonsterID, SpellLevel) index finds the rows but not Slots.
+     "CREATE INDEX IF NOT EXISTS idx_Monster_SpellSlots_MonsterID "
+     "ON Monster_SpellSlots(MonsterID, SpellLevel, Slots);"},
+};
+
+} // namespace
+
+int schemaVersion(SQLite::Database &db) {
+  SQLite::Statement query(db, "PRAGMA user_version");
+  return query.executeStep() ? query.getColumn(0).getInt() : 0;
+}
+
+int latestSchemaVersion() {
+  return kMigrations[sizeof(kMigrations) / sizeof(kMigrations[0]) - 1]
+      .version;
+}
+
+bool migrateSchema(SQLite::Database &db) {
+  int version = schemaVersion(db);
+  for (const auto &migration : kMigrations) {
+    if (migration.version <= version) {
+      continue;
+    }
+    try {
+      SQLite::Transaction transaction(db);
+      db.exec(migration.sql);
+      db.exec("PRAGMA user_version = " + std::to_string(migration.version));
+      transaction.commit();
+    } catch (const std::exception &e) {
+      std::cerr << "SQLite error in migration " << migration.version << " ("
+                << migration.description << "): " << e.what() << std::endl;
+      return false;
+    }
+    std::cout << "Migrated database to schema version " << migration.version
+              << ": " << migration.description << std::endl;
+    version = migration.version;
+  }
+  return true;
+}
+
+bool migrateDatabase(const std::string &path) {
+  try {
+    {
+      SQLite::Database db(path, SQLite::OPEN_READONLY);
+      if (schemaVersion(db) >= latestSchemaVersion()) {
+        return true;
+      }
+    }
+    SQLite::Database db(path, SQLite::OPEN_READWRITE);
+    return migrateSchema(db);
+  } catch (const std::exception &e) {
+    std::cerr << "SQLite error in migrateDatabase: " << e.what() << std::endl;
+    return false;
+  }
+}
+
+int checkLoaderQueryPlans(SQLite::Database &db) {
+  int fullScans = 0;
+  for (const auto &loaderQuery : perMonsterQueries()) {
+    bool scans = false;
+    std::cout << loaderQuery.name << ":" << std::endl;
+    try {
+      SQLite::Statement plan(db, std::string("EXPLAIN QUERY PLAN ") +
+                                     loaderQuery.sql);
+      while (plan.executeStep()) {
+        // Column 3 is the human-readable step, e.g. "SCAN A" or
+        // "SEARCH MS USING COVERING INDEX ... (MonsterID=?)".
+        std::string detail = plan.getColumn(3).getString();
+        std::cout << "  " << detail << std::endl;
+        if (detail.compare(0, 5, "SCAN ") == 0) {
+          scans = true;
+        }
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "SQLite error in checkLoaderQueryPlans: " << e.what()
+                << std::endl;
+      scans = true;
+    }
+    if (scans) {
+      std::cout << "  ^ full table scan" << std::endl;
+      fullScans++;
+    }
+  }
+  return fullScans;
+}
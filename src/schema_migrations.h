@@ -0,0 +1,28 @@
+#pragma once
+
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <string>
+
+// --- Schema Migrations ---
+// The database is generated outside the app, so its schema only carries what
+// the generator knows about. Anything the loader depends on beyond that
+// (indexes, for now) is added here by ordered migrations. The version applied
+// so far is stored in the database header via PRAGMA user_version, which a
+// freshly generated file leaves at 0.
+
+int schemaVersion(SQLite::Database &db);
+int latestSchemaVersion();
+
+// Applies every migration newer than the stored version, each in its own
+// transaction. Returns false, leaving the remaining migrations for next time,
+// if one fails.
+bool migrateSchema(SQLite::Database &db);
+
+// Opens `path` read-only to compare versions and only reopens it for writing
+// when there is something to apply. Safe to call on every launch.
+bool migrateDatabase(const std::string &path);
+
+// Runs EXPLAIN QUERY PLAN on every per-monster loader query and prints each
+// plan. Returns the number of queries that scan a whole table instead of
+// searching an index.
+int checkLoaderQueryPlans(SQLite::Database &db);
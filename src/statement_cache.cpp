@@ -0,0 +1,16 @@
+#include "statement_cache.h"
+
+SQLite::Statement &StatementCache::acquire(const std::string &sql) {
+  auto it = m_statements.find(sql);
+  if (it == m_statements.end()) {
+    auto statement = std::make_unique<SQLite::Statement>(m_db, sql);
+    m_stats.prepares++;
+    it = m_statements.emplace(sql, std::move(statement)).first;
+  } else {
+    // A previous caller may have stopped stepping part-way through the rows.
+    it->second->reset();
+    it->second->clearBindings();
+  }
+  m_stats.executions++;
+  return *it->second;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Counters for proving how much SQL work a Bestiary selection really costs.
+struct StatementCacheStats {
+  size_t prepares = 0;   // Statements compiled by SQLite
+  size_t executions = 0; // Times a cached statement was handed out to run
+};
+
+// --- Prepared Statement Registry ---
+// Owns one compiled SQLite::Statement per distinct SQL string for the lifetime
+// of the database handle it was created with. acquire() prepares on first use
+// and afterwards only resets the statement and clears its old bindings, so the
+// caller can bind fresh parameters and step it again straight away.
+class StatementCache {
+public:
+  explicit StatementCache(SQLite::Database &db) : m_db(db) {}
+
+  StatementCache(const StatementCache &) = delete;
+  StatementCache &operator=(const StatementCache &) = delete;
+
+  SQLite::Statement &acquire(const std::string &sql);
+
+  SQLite::Database &database() { return m_db; }
+  const StatementCacheStats &stats() const { return m_stats; }
+  size_t size() const { return m_statements.size(); }
+
+private:
+  SQLite::Database &m_db;
+  std::unordered_map<std::string, std::unique_ptr<SQLite::Statement>>
+      m_statements;
+  StatementCacheStats m_stats;
+};
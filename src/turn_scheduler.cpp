@@ -0,0 +1,260 @@
+#include "turn_scheduler.h"
+#include "dice.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+// Lair actions happen on initiative count 20, after every creature on 20.
+const InitiativeOrder::Entry kLairCount{20, INT_MIN, UINT64_MAX, {}};
+
+// A place before everyone, for the start of combat.
+const InitiativeOrder::Entry kTopOfRound{INT_MAX, INT_MAX, 0, {}};
+
+void eraseHandle(std::vector<CombatantHandle> &handles,
+                 CombatantHandle handle) {
+  handles.erase(std::remove(handles.begin(), handles.end(), handle),
+                handles.end());
+}
+
+} // namespace
+
+bool TurnScheduler::Later::operator()(const Scheduled &a,
+                                      const Scheduled &b) const {
+  if (a.round != b.round) {
+    return a.round > b.round;
+  }
+  if (b.at < a.at) {
+    return true;
+  }
+  if (a.at < b.at) {
+    return false;
+  }
+  return a.owner.slot > b.owner.slot;
+}
+
+void TurnScheduler::begin() {
+  end();
+  m_round = 1;
+  m_now = kTopOfRound;
+  for (auto &combatant : *m_combatants) {
+    combatant.legendaryActions = combatant.base->legendaryActions;
+    join(combatant);
+  }
+}
+
+void TurnScheduler::end() {
+  for (CombatantHandle handle : m_lairReady) {
+    if (Combatant *combatant = m_registry->resolve(*m_combatants, handle)) {
+      combatant->lairActionReady = false;
+    }
+  }
+  m_queue = {};
+  m_owners.clear();
+  m_legendary.clear();
+  m_lairReady.clear();
+  m_round = 0;
+  m_now = InitiativeOrder::Entry{};
+}
+
+TurnScheduler::Owner &TurnScheduler::ownerFor(CombatantHandle handle) {
+  if (handle.slot >= m_owners.size()) {
+    m_owners.resize(handle.slot + 1);
+  }
+  Owner &owner = m_owners[handle.slot];
+  if (owner.handle != handle) {
+    owner.handle = handle;
+    ++owner.generation;
+    owner.turnQueued = false;
+    owner.recharges.clear();
+  }
+  return owner;
+}
+
+int TurnScheduler::nextRound(const InitiativeOrder::Entry &at) const {
+  return m_now < at ? m_round : m_round + 1;
+}
+
+void TurnScheduler::queueTurn(Owner &owner, const Combatant &combatant,
+                              int round) {
+  owner.turnQueued = true;
+  m_queue.push({round, m_order->entryOf(combatant.handle), Kind::TURN,
+                owner.handle, owner.generation});
+}
+
+void TurnScheduler::queueLair(Owner &owner, int round) {
+  m_queue.push(
+      {round, kLairCount, Kind::LAIR, owner.handle, owner.generation});
+}
+
+void TurnScheduler::join(const Combatant &combatant) {
+  if (m_round == 0) {
+    return;
+  }
+  Owner &owner = ownerFor(combatant.handle);
+  if (combatant.base->legendaryActions > 0) {
+    m_legendary.push_back(combatant.handle);
+    queueTurn(owner, combatant,
+              nextRound(m_order->entryOf(combatant.handle)));
+  }
+  if (combatant.base->lairActions) {
+    queueLair(owner, nextRound(kLairCount));
+  }
+}
+
+void TurnScheduler::leave(CombatantHandle handle) {
+  if (handle.slot >= m_owners.size() ||
+      m_owners[handle.slot].handle != handle) {
+    return;
+  }
+  Owner &owner = m_owners[handle.slot];
+  owner.handle = CombatantHandle{};
+  ++owner.generation;
+  owner.turnQueued = false;
+  owner.recharges.clear();
+  eraseHandle(m_legendary, handle);
+  eraseHandle(m_lairReady, handle);
+}
+
+void TurnScheduler::moved(const Combatant &combatant) {
+  const CombatantHandle handle = combatant.handle;
+  if (handle.slot >= m_owners.size() ||
+      m_owners[handle.slot].handle != handle) {
+    return;
+  }
+  // Re-file everything under the new place; the old entries go stale.
+  Owner &owner = m_owners[handle.slot];
+  ++owner.generation;
+  owner.turnQueued = false;
+  const InitiativeOrder::Entry at = m_order->entryOf(handle);
+  if (handle == m_order->current()) {
+    m_now = at;
+  }
+  if (!owner.recharges.empty() || combatant.base->legendaryActions > 0) {
+    queueTurn(owner, combatant, nextRound(at));
+  }
+  if (combatant.base->lairActions) {
+    queueLair(owner, nextRound(kLairCount));
+  }
+}
+
+void TurnScheduler::spent(const Combatant &actor, const ActionDef &action) {
+  if (m_round == 0 || action.recharge <= 0 || action.resource < 0 ||
+      actor.resources.values[action.resource] > 0) {
+    return;
+  }
+  Owner &owner = ownerFor(actor.handle);
+  const int ability = action.handle.index;
+  auto at = std::lower_bound(
+      owner.recharges.begin(), owner.recharges.end(), ability,
+      [](const PendingRecharge &p, int index) { return p.ability < index; });
+  if (at != owner.recharges.end() && at->ability == ability) {
+    return; // Already rolling
+  }
+  owner.recharges.insert(at, {ability, action.resource, action.recharge});
+  if (!owner.turnQueued) {
+    queueTurn(owner, actor, nextRound(m_order->entryOf(actor.handle)));
+  }
+}
+
+void TurnScheduler::nextTurn(std::vector<TurnEvent> &fired) {
+  for (CombatantHandle handle : m_lairReady) {
+    if (Combatant *combatant = m_registry->resolve(*m_combatants, handle)) {
+      combatant->lairActionReady = false;
+    }
+  }
+  m_lairReady.clear();
+
+  const InitiativeOrder::Entry now = m_order->entryOf(m_order->current());
+  if (m_round == 0 || !now.handle) {
+    return;
+  }
+  if (!(m_now < now)) {
+    ++m_round; // Wrapped around to the top of the order
+  }
+  m_now = now;
+
+  while (!m_queue.empty()) {
+    const Scheduled event = m_queue.top();
+    if (event.round > m_round ||
+        (event.round == m_round && now < event.at)) {
+      break;
+    }
+    m_queue.pop();
+    ++m_stats.popped;
+    Combatant *combatant = m_registry->resolve(*m_combatants, event.owner);
+    if (!combatant || m_owners[event.owner.slot].handle != event.owner ||
+        m_owners[event.owner.slot].generation != event.generation) {
+      ++m_stats.skipped;
+      continue;
+    }
+    Owner &owner = m_owners[event.owner.slot];
+    if (event.kind == Kind::TURN) {
+      fireTurn(owner, *combatant, fired);
+    } else {
+      fireLair(owner, *combatant, fired);
+    }
+  }
+}
+
+void TurnScheduler::previousTurn() {
+  const InitiativeOrder::Entry now = m_order->entryOf(m_order->current());
+  if (m_round == 0 || !now.handle) {
+    return;
+  }
+  if (m_now < now && m_round > 1) {
+    --m_round; // Back past the top of the order
+  }
+  m_now = now;
+}
+
+void TurnScheduler::fireTurn(Owner &owner, Combatant &combatant,
+                             std::vector<TurnEvent> &fired) {
+  owner.turnQueued = false;
+
+  // Every pending recharge rolls now, together.
+  size_t kept = 0;
+  for (const PendingRecharge &pending : owner.recharges) {
+    int &charges = combatant.resources.values[pending.resource];
+    if (charges > 0) {
+      continue; // Marked charged by hand
+    }
+    TurnEvent event;
+    event.type = TurnEvent::RECHARGE;
+    event.owner = combatant.handle;
+    event.ability = pending.ability;
+    event.roll = rollFace(6, combatant.rng);
+    event.recharged = event.roll >= pending.rechargeOn;
+    fired.push_back(event);
+    if (event.recharged) {
+      charges = combatant.base->maxResources.values[pending.resource];
+    } else {
+      owner.recharges[kept++] = pending;
+    }
+  }
+  owner.recharges.resize(kept);
+
+  const int legendaryActions = combatant.base->legendaryActions;
+  if (combatant.legendaryActions < legendaryActions) {
+    combatant.legendaryActions = legendaryActions;
+    TurnEvent event;
+    event.type = TurnEvent::LEGENDARY;
+    event.owner = combatant.handle;
+    fired.push_back(event);
+  }
+
+  if (!owner.recharges.empty() || legendaryActions > 0) {
+    queueTurn(owner, combatant, m_round + 1);
+  }
+}
+
+void TurnScheduler::fireLair(Owner &owner, Combatant &combatant,
+                             std::vector<TurnEvent> &fired) {
+  combatant.lairActionReady = true;
+  m_lairReady.push_back(combatant.handle);
+  TurnEvent event;
+  event.type = TurnEvent::LAIR;
+  event.owner = combatant.handle;
+  fired.push_back(event);
+  queueLair(owner, m_round + 1);
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "action_pipeline.h"
+#include "combatant_registry.h"
+#include "handles.h"
+#include "initiative_order.h"
+#include "monster.h"
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+// Something that happened at a set point in the round.
+struct TurnEvent {
+  enum Type : uint8_t {
+    RECHARGE,  // `ability` rolled `roll` to recharge; `recharged` if it did
+    LEGENDARY, // The owner regained its legendary actions
+    LAIR       // Initiative count 20: the owner may take a lair action
+  };
+
+  Type type = RECHARGE;
+  CombatantHandle owner;
+  int ability = -1; // In the owner's Monster's abilities
+  int roll = 0;
+  bool recharged = false;
+};
+
+// How much work dispatching has done, for checking that it stays
+// proportional to what is due rather than to the encounter.
+struct TurnSchedulerStats {
+  size_t popped = 0;  // Queue entries dispatched or skipped
+  size_t skipped = 0; // Stale: their creature left or moved
+};
+
+// --- Turn Scheduler ---
+// What happens at set points in the round rather than when someone acts:
+// spent recharge abilities roll to come back at the start of their owner's
+// turn, all of a creature's at once; legendary actions return at the start
+// of their owner's turn, once a round; and lair actions come up on
+// initiative count 20, losing ties. Each is an entry in a priority queue
+// keyed on the round and a place in the InitiativeOrder, so passing the turn
+// pops only what is due instead of looking at every combatant.
+// Entries are never taken out early: when a creature leaves or its
+// initiative changes, its generation moves on and the old entries are
+// skipped when they come up. Copies work on the same encounter, so one can
+// be kept as a checkpoint and assigned back.
+class TurnScheduler {
+public:
+  TurnScheduler(std::vector<Combatant> &combatants,
+                const CombatantRegistry &registry,
+                const InitiativeOrder &order)
+      : m_combatants(&combatants), m_registry(&registry), m_order(&order) {}
+
+  // Round 1, with everyone's legendary actions ready. Call once initiative
+  // is rolled, before dispatching the first turn.
+  void begin();
+  // Drops everything; nothing is scheduled outside combat.
+  void end();
+  int round() const { return m_round; }
+
+  // A creature joining, leaving or changing initiative during combat.
+  void join(const Combatant &combatant);
+  void leave(CombatantHandle handle);
+  void moved(const Combatant &combatant);
+
+  // `actor` has just resolved `action`. A spent recharge ability starts
+  // rolling at its next turn.
+  void spent(const Combatant &actor, const ActionDef &action);
+
+  // The turn has passed on to the order's current creature: applies and
+  // appends to `fired` everything due up to the start of its turn, in order.
+  // Ends any lair actions the last count 20 offered.
+  void nextTurn(std::vector<TurnEvent> &fired);
+  // The turn went back one place. Nothing is undone; only the round
+  // follows it.
+  void previousTurn();
+
+  // Creatures with legendary actions, and those whose lair action is ready.
+  const std::vector<CombatantHandle> &legendary() const { return m_legendary; }
+  const std::vector<CombatantHandle> &lairReady() const { return m_lairReady; }
+
+  const TurnSchedulerStats &stats() const { return m_stats; }
+
+private:
+  enum class Kind : uint8_t { TURN, LAIR };
+
+  struct Scheduled {
+    int round;
+    InitiativeOrder::Entry at;
+    Kind kind;
+    CombatantHandle owner;
+    uint32_t generation;
+  };
+
+  // Orders the queue soonest first.
+  struct Later {
+    bool operator()(const Scheduled &a, const Scheduled &b) const;
+  };
+
+  struct PendingRecharge {
+    int ability;
+    int resource;
+    int rechargeOn;
+  };
+
+  struct Owner {
+    CombatantHandle handle;
+    uint32_t generation = 0;
+    bool turnQueued = false;
+    std::vector<PendingRecharge> recharges; // By ability index
+  };
+
+  Owner &ownerFor(CombatantHandle handle);
+  // The round `at` next comes up in: this one if the turn has not passed it.
+  int nextRound(const InitiativeOrder::Entry &at) const;
+  void queueTurn(Owner &owner, const Combatant &combatant, int round);
+  void queueLair(Owner &owner, int round);
+  void fireTurn(Owner &owner, Combatant &combatant,
+                std::vector<TurnEvent> &fired);
+  void fireLair(Owner &owner, Combatant &combatant,
+                std::vector<TurnEvent> &fired);
+
+  std::vector<Combatant> *m_combatants;
+  const CombatantRegistry *m_registry;
+  const InitiativeOrder *m_order;
+  std::priority_queue<Scheduled, std::vector<Scheduled>, Later> m_queue;
+  std::vector<Owner> m_owners; // By handle slot
+  std::vector<CombatantHandle> m_legendary;
+  std::vector<CombatantHandle> m_lairReady;
+  int m_round = 0; // 0 outside combat
+  InitiativeOrder::Entry m_now; // Whose turn was last dispatched
+  TurnSchedulerStats m_stats;
+};